@@ -94,6 +94,13 @@ USE_QRCODE=1
 USE_PREVECTOR=1
 USE_PREVECTOR_S=1
 
+#
+# SHA256 SSE4.1 (4-way), AVX2 (8-way) and SHA-NI kernels (x86 only)
+# the CPU is checked at startup (SHA256AutoDetect), so the binary still runs without them
+# there is no probrem, all set 1 on x86.
+#
+USE_SHA256_SIMD=1
+
 #
 # OPTION USE
 # KNOWLEDGE_DB: Blockchain Database (with the "blockchain mini filesystem" library, optional)
@@ -404,6 +411,8 @@ HEADERS += src/qt/bitcoingui.h \
     src/walletdb.h \
     src/db_addr.h \
     src/script/script.h \
+    src/script/sigcache.h \
+    src/script/sighash.h \
     src/script/interpreter.h \
     src/script/script_error.h \
     src/init.h \
@@ -493,6 +502,9 @@ HEADERS += src/qt/bitcoingui.h \
     src/block/block_info.h \
     src/block/block_alert.h \
     src/block/block_check.h \
+    src/block/prevout_cache.h \
+    src/block/block_index_map.h \
+    src/block/block_index_snapshot.h \
     src/prime/autocheckpoint.h \
     src/merkle/merkle_tx.h \
     src/merkle/merkle_tree.h \
@@ -502,6 +514,8 @@ HEADERS += src/qt/bitcoingui.h \
     src/file_operate/autofile.h \
     src/file_operate/fs.h \
     src/file_operate/iofs.h \
+    src/file_operate/block_mmap.h \
+    src/file_operate/block_store.h \
     src/boot/shutdown.h \
     src/miner/diff.h \
     src/rpc/bitcoinrpc.h \
@@ -609,6 +623,8 @@ SOURCES += src/qt/bitcoin.cpp src/qt/bitcoingui.cpp \
     src/ntp.cpp \
     src/key.cpp \
     src/script/script.cpp \
+    src/script/sigcache.cpp \
+    src/script/sighash.cpp \
     src/script/interpreter.cpp \
     src/script/script_error.cpp \
     src/script/sign.cpp \
@@ -668,9 +684,15 @@ SOURCES += src/qt/bitcoin.cpp src/qt/bitcoingui.cpp \
     src/ipcollector.cpp \
     src/quantum/quantum.cpp \
     src/bench/be_bench.cpp \
+    src/bench/be_checkqueue.cpp \
+    src/bench/be_ecmult.cpp \
+    src/bench/be_evalscript.cpp \
+    src/bench/be_kernel.cpp \
     src/bench/be_prevector.cpp \
     src/bench/be_aes.cpp \
     src/bench/be_hash.cpp \
+    src/bench/be_merkle.cpp \
+    src/bench/be_sighash.cpp \
     src/bench/be_univalue.cpp \
     src/compat/glibc_compat.cpp \
     src/compat/glibc_sanity.cpp \
@@ -708,6 +730,9 @@ SOURCES += src/qt/bitcoin.cpp src/qt/bitcoingui.cpp \
     src/block/block_locator.cpp \
     src/block/block_alert.cpp \
     src/block/block_check.cpp \
+    src/block/prevout_cache.cpp \
+    src/block/block_index_map.cpp \
+    src/block/block_index_snapshot.cpp \
     src/prime/autocheckpoint.cpp \
     src/merkle/merkle_tx.cpp \
     src/merkle/merkle_tree.cpp \
@@ -733,6 +758,8 @@ SOURCES += src/qt/bitcoin.cpp src/qt/bitcoingui.cpp \
     src/util/arginit.cpp \
     src/file_operate/fs.cpp \
     src/file_operate/iofs.cpp \
+    src/file_operate/block_mmap.cpp \
+    src/file_operate/block_store.cpp \
     src/address/bech32.cpp \
     src/const/chainparamsbase.cpp \
     src/const/chainparams.cpp \
@@ -797,6 +824,44 @@ contains(USE_QRCODE, 1) {
     FORMS += src/qt/forms/qrcodedialog.ui
 }
 
+#
+# SHA256 SIMD kernels
+# use: qmake "USE_SHA256_SIMD=1" ( enabled by default; default)
+#  or: qmake "USE_SHA256_SIMD=0" (disabled)
+# each kernel is compiled alone with its instruction set flags; the rest of the build is not
+#
+contains(USE_SHA256_SIMD, 1) {
+    message(Building with SHA256 SSE4.1/AVX2/SHA-NI support)
+    DEFINES += USE_ASM ENABLE_SSE41 ENABLE_AVX2 ENABLE_SHANI
+    SOURCES -= src/crypto/sha256_sse41.cpp src/crypto/sha256_avx2.cpp src/crypto/sha256_shani.cpp
+
+    SHA256_SSE41_SOURCES = src/crypto/sha256_sse41.cpp
+    sha256sse41.input = SHA256_SSE41_SOURCES
+    sha256sse41.output = $$OBJECTS_DIR/${QMAKE_FILE_BASE}.o
+    sha256sse41.commands = $(CXX) -c $(CXXFLAGS) $(INCPATH) -msse4.1 ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    sha256sse41.dependency_type = TYPE_C
+    sha256sse41.variable_out = OBJECTS
+    QMAKE_EXTRA_COMPILERS += sha256sse41
+
+    SHA256_AVX2_SOURCES = src/crypto/sha256_avx2.cpp
+    sha256avx2.input = SHA256_AVX2_SOURCES
+    sha256avx2.output = $$OBJECTS_DIR/${QMAKE_FILE_BASE}.o
+    sha256avx2.commands = $(CXX) -c $(CXXFLAGS) $(INCPATH) -mavx -mavx2 ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    sha256avx2.dependency_type = TYPE_C
+    sha256avx2.variable_out = OBJECTS
+    QMAKE_EXTRA_COMPILERS += sha256avx2
+
+    SHA256_SHANI_SOURCES = src/crypto/sha256_shani.cpp
+    sha256shani.input = SHA256_SHANI_SOURCES
+    sha256shani.output = $$OBJECTS_DIR/${QMAKE_FILE_BASE}.o
+    sha256shani.commands = $(CXX) -c $(CXXFLAGS) $(INCPATH) -msse4 -msha ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    sha256shani.dependency_type = TYPE_C
+    sha256shani.variable_out = OBJECTS
+    QMAKE_EXTRA_COMPILERS += sha256shani
+} else {
+    message(Building without SHA256 SSE4.1/AVX2/SHA-NI support)
+}
+
 CODECFORTR = UTF-8
 
 #
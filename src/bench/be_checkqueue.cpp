@@ -0,0 +1,125 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <util/args.h>
+#include <checkqueue.h>
+#include <boost/thread/thread.hpp>
+#include <atomic>
+
+namespace check_checkqueue {
+
+static constexpr int CHECKQUEUE_BENCH_WORKERS = 3;
+static constexpr int CHECKQUEUE_BENCH_BATCHES = 100;    // one Add per transaction
+static constexpr int CHECKQUEUE_BENCH_CHECKS = 200;     // inputs per transaction
+
+struct CBenchCheck {
+    int nWork;
+    std::atomic<int> *pnDone;
+    CBenchCheck() : nWork(0), pnDone(nullptr) {}
+    CBenchCheck(int nWorkIn, std::atomic<int> *pnDoneIn) : nWork(nWorkIn), pnDone(pnDoneIn) {}
+
+    bool operator()() const {
+        volatile int x = 0;
+        for(int i = 0; i < std::abs(nWork); ++i)
+            x = x + i;
+        pnDone->fetch_add(1, std::memory_order_relaxed);
+        return nWork >= 0;
+    }
+    void swap(CBenchCheck &check) {
+        std::swap(nWork, check.nWork);
+        std::swap(pnDone, check.pnDone);
+    }
+};
+
+// nFail: index of a failing check, or -1
+static bool RunBlock(CCheckQueue<CBenchCheck> &queue, std::atomic<int> &nDone, int nFail)
+{
+    CCheckQueueControl<CBenchCheck> control(&queue);
+    for(int n = 0; n < CHECKQUEUE_BENCH_BATCHES; ++n) {
+        std::vector<CBenchCheck> vChecks;
+        vChecks.reserve(CHECKQUEUE_BENCH_CHECKS);
+        for(int i = 0; i < CHECKQUEUE_BENCH_CHECKS; ++i)
+            vChecks.push_back(CBenchCheck((n * CHECKQUEUE_BENCH_CHECKS + i == nFail) ? -100 : 100, &nDone));
+        control.Add(vChecks);
+    }
+    return control.Wait();
+}
+
+static void CheckQueueSpeed(benchmark::State& state)
+{
+    CCheckQueue<CBenchCheck> queue(128);
+    boost::thread_group group;
+    for(int i = 0; i < CHECKQUEUE_BENCH_WORKERS; ++i)
+        group.create_thread([&queue]() { queue.Thread(); });
+
+    std::atomic<int> nDone(0);
+    while(state.KeepRunning()) {
+        RunBlock(queue, nDone, -1);
+    }
+    queue.Quit();
+    group.join_all();
+}
+
+// checks run and skipped over every Wait of the queue
+static void CountChecks(const CCheckQueue<CBenchCheck> &queue, uint64_t &nChecks, uint64_t &nSkipped, uint64_t &nWaits)
+{
+    const CCheckQueue<CBenchCheck>::stats st = queue.GetStats();
+    nChecks = nSkipped = 0;
+    for(const CCheckQueue<CBenchCheck>::worker_stats &w: st.vWorker) {
+        nChecks += w.nChecks;
+        nSkipped += w.nSkipped;
+    }
+    nWaits = st.nWaits;
+}
+
+void CheckQueueAssertcheck(benchmark::State& state)
+{
+    CCheckQueue<CBenchCheck> queue(16);
+    boost::thread_group group;
+    for(int i = 0; i < CHECKQUEUE_BENCH_WORKERS; ++i)
+        group.create_thread([&queue]() { queue.Thread(); });
+
+    const int nTotal = CHECKQUEUE_BENCH_BATCHES * CHECKQUEUE_BENCH_CHECKS;
+    uint64_t nRun = 0;
+    while(state.KeepRunning()) {
+        std::atomic<int> nDone(0);
+        assert(RunBlock(queue, nDone, -1));
+        assert(nDone.load() == nTotal);
+        assert(queue.IsIdle());
+        nRun += nDone.load();
+
+        // early abort: a failure is reported and the queue is clean for the next block
+        nDone = 0;
+        assert(! RunBlock(queue, nDone, nTotal / 3));
+        assert(nDone.load() <= nTotal);
+        assert(queue.IsIdle());
+        nRun += nDone.load();
+    }
+
+    // only the checks that ran are counted as checks
+    uint64_t nChecks, nSkipped, nWaits;
+    CountChecks(queue, nChecks, nSkipped, nWaits);
+    assert(nChecks == nRun);
+    assert(nChecks + nSkipped == nWaits * nTotal);
+
+    queue.Quit();
+    group.join_all();
+
+    // without workers the master pops the last batch first and runs it from its first
+    // check, so a failure there skips every other check
+    CCheckQueue<CBenchCheck> master(16);
+    std::atomic<int> nDone(0);
+    assert(! RunBlock(master, nDone, nTotal - CHECKQUEUE_BENCH_CHECKS));
+    assert(nDone.load() < nTotal);
+    assert(master.IsIdle());
+    CountChecks(master, nChecks, nSkipped, nWaits);
+    assert(nChecks == (uint64_t)nDone.load() && nSkipped == (uint64_t)(nTotal - nDone.load()));
+    master.Quit();
+}
+
+BENCHMARK(CheckQueueSpeed, 20);
+BENCHMARK(CheckQueueAssertcheck, 5);
+
+} // namespace check_checkqueue
@@ -0,0 +1,244 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <key/pubkey.h>
+#include <key/privkey.h>
+#include <hash.h>
+#include <util/strencodings.h>
+
+namespace check_ecmult {
+
+static constexpr int ECMULT_BENCH_SIGS = 16;
+
+struct CSignedData {
+    CPubKey pubkey;
+    std::vector<uint256> vHash;
+    std::vector<key_vector> vSig;
+    std::vector<std::vector<unsigned char> > vCompact;
+};
+
+static CSignedData MakeSigned()
+{
+    CSignedData data;
+    CFirmKey key;
+    key.MakeNewKey(true);
+    bool fret = false;
+    data.pubkey = key.GetPubKey(&fret);
+    assert(fret);
+    for(int i = 0; i < ECMULT_BENCH_SIGS; ++i) {
+        const unsigned char ch = (unsigned char)i;
+        data.vHash.push_back(hash_basis::Hash(&ch, &ch + 1));
+        key_vector vchSig;
+        assert(key.Sign(data.vHash.back(), vchSig));
+        data.vSig.push_back(vchSig);
+        std::vector<unsigned char> vchCompact;
+        assert(key.SignCompact(data.vHash.back(), vchCompact));
+        data.vCompact.push_back(vchCompact);
+    }
+    return data;
+}
+
+// a field element below 2^255 from the hash words (magnitude 1)
+static CPubKey::ecmult::secp256k1_fe MakeFe(const uint256 &hash)
+{
+    const uint32_t *pn = (const uint32_t *)hash.begin();
+    CPubKey::ecmult::secp256k1_fe fe = SECP256K1_FE_CONST(pn[7] & 0x7FFFFFFF, pn[6], pn[5], pn[4], pn[3], pn[2], pn[1], pn[0]);
+    return fe;
+}
+
+// known answers (big-endian hex): a, b, a*b, a^2, a^-1 mod p (field) and mod n (scalar)
+struct CEcmultVector {
+    const char *a, *b, *mul, *sqr, *inv;
+};
+
+static const CEcmultVector fe_vectors[] = {
+    {"38a40057394014f204dc4f3f40a6a2f044a30d9813a637e2c8796bc8e7a22a80",
+     "2c527d3c59803cff79c7be5665e7117b1647cc317b6a3ac5acf231d9959c5fac",
+     "8cc0ac8d2d7bc263673f9cd020bdd23c1d4219903e42de41e2547370775852e1",
+     "dd684b64b07aef09cf380e1251edaf780f20fef22db5e51d48733675e24ca8d7",
+     "30bf2b4a2285402a2f7bc5bab8db8c9865019941d4733411463e5699a26c1184"},
+    {"fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e",
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"},
+    {"fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2d",
+     "8000000000000000000000000000000000000000000000000000000000000013",
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffdfffff838",
+     "0000000000000000000000000000000000000000000000000000000000000004",
+     "7fffffffffffffffffffffffffffffffffffffffffffffffffffffff7ffffe17"},
+    {"0000000000000000000000000000000000000000000000000000000000000001",
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e",
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "0000000000000000000000000000000000000000000000000000000000000001"}
+};
+
+static const CEcmultVector scalar_vectors[] = {
+    {"15c355cd694ce94e4d55f688d601fe4478708da9af94125e99074e0f6ff67a70",
+     "7bd50cb52ebe748854b8f22243cb4eb5a2b39aa2c210d6c2cbc99ff8f1553719",
+     "a760fb876460a45edc180b0c954447ee48a869ac6a9a3f9884fb307163639b7e",
+     "dbf0136aaee62cc312b9927f4b08023833ae866957733b89464d893fdc4cecca",
+     "973b60ae325e32ecd2f70b8978c0c2234cc2907bb8b0f95ad0015282250ccc62"},
+    {"fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+     "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140"},
+    {"fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd036413f",
+     "8000000000000000000000000000000000000000000000000000000000000013",
+     "fffffffffffffffffffffffffffffffd755db9cd5e9140777fa4bd19a06c825c",
+     "0000000000000000000000000000000000000000000000000000000000000004",
+     "7fffffffffffffffffffffffffffffff5d576e7357a4501ddfe92f46681b20a0"},
+    {"0000000000000000000000000000000000000000000000000000000000000001",
+     "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+     "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+     "0000000000000000000000000000000000000000000000000000000000000001",
+     "0000000000000000000000000000000000000000000000000000000000000001"}
+};
+
+static CPubKey::ecmult::secp256k1_fe ParseFe(const char *hex)
+{
+    const strenc::hex_vector vch = strenc::ParseHex(hex);
+    assert(vch.size() == 32);
+    CPubKey::ecmult::secp256k1_fe fe;
+    const int fOk = CPubKey::ecmult::secp256k1_fe_set_be32(&fe, &vch[0]);
+    assert(fOk);
+    return fe;
+}
+
+static bool FeIs(CPubKey::ecmult::secp256k1_fe fe, const char *hex)
+{
+    const strenc::hex_vector vch = strenc::ParseHex(hex);
+    unsigned char b32[32];
+    CPubKey::ecmult::secp256k1_fe_normalize(&fe);
+    CPubKey::ecmult::secp256k1_fe_get_be32(b32, &fe);
+    return ::memcmp(b32, &vch[0], 32) == 0;
+}
+
+static CPubKey::secp256k1_unit ParseScalar(const char *hex)
+{
+    const strenc::hex_vector vch = strenc::ParseHex(hex);
+    assert(vch.size() == 32);
+    CPubKey::secp256k1_unit x;
+    int overflow = 0;
+    CPubKey::secp256k1_scalar_set_be32(&x, &vch[0], &overflow);
+    assert(overflow == 0);
+    return x;
+}
+
+static bool ScalarIs(const CPubKey::secp256k1_unit &x, const char *hex)
+{
+    const strenc::hex_vector vch = strenc::ParseHex(hex);
+    unsigned char b32[32];
+    CPubKey::secp256k1_scalar_get_be32(b32, &x);
+    return ::memcmp(b32, &vch[0], 32) == 0;
+}
+
+static void EcmultVerify(benchmark::State& state)
+{
+    const CSignedData data = MakeSigned();
+    int i = 0;
+    while(state.KeepRunning()) {
+        data.pubkey.Verify_BIP66(data.vHash[i], data.vSig[i]);
+        i = (i + 1) % ECMULT_BENCH_SIGS;
+    }
+}
+
+static void EcmultRecover(benchmark::State& state)
+{
+    const CSignedData data = MakeSigned();
+    int i = 0;
+    while(state.KeepRunning()) {
+        CPubKey pubkey;
+        pubkey.RecoverCompact(data.vHash[i], data.vCompact[i]);
+        i = (i + 1) % ECMULT_BENCH_SIGS;
+    }
+}
+
+static void EcmultFieldMul(benchmark::State& state)
+{
+    CPubKey::ecmult::secp256k1_fe a = MakeFe(uint256(11)), b = MakeFe(uint256(22)), r;
+    while(state.KeepRunning()) {
+        for(int i = 0; i < 1000; ++i) {
+            CPubKey::ecmult::secp256k1_fe_mul(&r, &a, &b);
+            CPubKey::ecmult::secp256k1_fe_sqr(&a, &r);
+        }
+    }
+}
+
+void EcmultAssertcheck(benchmark::State& state)
+{
+    const CSignedData data = MakeSigned();
+    while(state.KeepRunning()) {
+        for(int i = 0; i < ECMULT_BENCH_SIGS; ++i) {
+            assert(data.pubkey.Verify_BIP66(data.vHash[i], data.vSig[i]));
+            assert(! data.pubkey.Verify_BIP66(data.vHash[(i + 1) % ECMULT_BENCH_SIGS], data.vSig[i]));
+            CPubKey pubkey;
+            assert(pubkey.RecoverCompact(data.vHash[i], data.vCompact[i]));
+            assert(pubkey == data.pubkey);
+        }
+
+        // fixed vectors, so that a wrong limb product cannot pass by agreeing with itself
+        for(const CEcmultVector &v: fe_vectors) {
+            const CPubKey::ecmult::secp256k1_fe a = ParseFe(v.a), b = ParseFe(v.b);
+            CPubKey::ecmult::secp256k1_fe r;
+            CPubKey::ecmult::secp256k1_fe_mul(&r, &a, &b);
+            assert(FeIs(r, v.mul));
+            CPubKey::ecmult::secp256k1_fe_sqr(&r, &a);
+            assert(FeIs(r, v.sqr));
+            CPubKey::ecmult::secp256k1_fe_inv(&r, &a);
+            assert(FeIs(r, v.inv));
+        }
+        for(const CEcmultVector &v: scalar_vectors) {
+            const CPubKey::secp256k1_unit a = ParseScalar(v.a), b = ParseScalar(v.b);
+            CPubKey::secp256k1_unit r;
+            CPubKey::secp256k1_scalar_mul(&r, &a, &b);
+            assert(ScalarIs(r, v.mul));
+            CPubKey::secp256k1_scalar_sqr(&r, &a);
+            assert(ScalarIs(r, v.sqr));
+            CPubKey::secp256k1_scalar_inverse(&r, &a);
+            assert(ScalarIs(r, v.inv));
+        }
+
+        // field: a^2 == a*a, (a*b)*c == a*(b*c); scalar: a^2 == a*a, a*a^-1 == 1
+        for(int i = 0; i < ECMULT_BENCH_SIGS; ++i) {
+            const CPubKey::ecmult::secp256k1_fe a = MakeFe(data.vHash[i]);
+            const CPubKey::ecmult::secp256k1_fe b = MakeFe(data.vHash[(i + 1) % ECMULT_BENCH_SIGS]);
+            const CPubKey::ecmult::secp256k1_fe c = MakeFe(data.vHash[(i + 2) % ECMULT_BENCH_SIGS]);
+            CPubKey::ecmult::secp256k1_fe s, m, ab, bc, l, r;
+            CPubKey::ecmult::secp256k1_fe_sqr(&s, &a);
+            CPubKey::ecmult::secp256k1_fe_mul(&m, &a, &a);
+            assert(CPubKey::ecmult::secp256k1_fe_equal(&s, &m));
+            CPubKey::ecmult::secp256k1_fe_mul(&ab, &a, &b);
+            CPubKey::ecmult::secp256k1_fe_mul(&l, &ab, &c);
+            CPubKey::ecmult::secp256k1_fe_mul(&bc, &b, &c);
+            CPubKey::ecmult::secp256k1_fe_mul(&r, &a, &bc);
+            assert(CPubKey::ecmult::secp256k1_fe_equal(&l, &r));
+
+            CPubKey::secp256k1_unit x, xx, xm, xi, one;
+            unsigned char b1[32], b2[32];
+            CPubKey::secp256k1_scalar_set_be32(&x, data.vHash[i].begin(), nullptr);
+            CPubKey::secp256k1_scalar_sqr(&xx, &x);
+            CPubKey::secp256k1_scalar_mul(&xm, &x, &x);
+            CPubKey::secp256k1_scalar_get_be32(b1, &xx);
+            CPubKey::secp256k1_scalar_get_be32(b2, &xm);
+            assert(::memcmp(b1, b2, 32) == 0);
+            CPubKey::secp256k1_scalar_inverse(&xi, &x);
+            CPubKey::secp256k1_scalar_mul(&xm, &x, &xi);
+            CPubKey::secp256k1_scalar_set_int(&one, 1);
+            CPubKey::secp256k1_scalar_get_be32(b1, &xm);
+            CPubKey::secp256k1_scalar_get_be32(b2, &one);
+            assert(::memcmp(b1, b2, 32) == 0);
+        }
+    }
+}
+
+BENCHMARK(EcmultVerify, 2000);
+BENCHMARK(EcmultRecover, 2000);
+BENCHMARK(EcmultFieldMul, 500);
+BENCHMARK(EcmultAssertcheck, 5);
+
+} // namespace check_ecmult
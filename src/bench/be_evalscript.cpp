@@ -0,0 +1,174 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <block/transaction.h>
+#include <script/interpreter.h>
+#include <script/sighash.h>
+#include <key/pubkey.h>
+#include <key/privkey.h>
+#include <algorithm>
+
+namespace check_evalscript {
+
+static constexpr int EVALSCRIPT_BENCH_INPUTS = 4;
+static constexpr unsigned int EVALSCRIPT_BENCH_FLAGS = Script_param::SCRIPT_VERIFY_P2SH | Script_param::STRICT_FORMAT_FLAGS | Script_param::SCRIPT_VERIFY_NOCACHE;
+
+struct CSignedTx {
+    CTransaction tx;
+    CScript scriptPubKey;
+    CScript scriptNoSig; // scriptPubKey without the OP_CHECKSIG
+};
+
+// N signed P2PKH inputs spending scriptPubKey
+static CSignedTx MakeSigned()
+{
+    CSignedTx data;
+    CFirmKey key;
+    key.MakeNewKey(true);
+    bool fret = false;
+    const CPubKey pubkey = key.GetPubKey(&fret);
+    assert(fret);
+    data.scriptNoSig << ScriptOpcodes::OP_DUP << ScriptOpcodes::OP_HASH160 << CScript::ToByteVector(pubkey.GetID()) << ScriptOpcodes::OP_EQUALVERIFY;
+    data.scriptPubKey = data.scriptNoSig;
+    data.scriptPubKey << ScriptOpcodes::OP_CHECKSIG;
+
+    for(int i = 0; i < EVALSCRIPT_BENCH_INPUTS; ++i)
+        data.tx.set_vin().push_back(CTxIn(uint256(i + 1), i));
+    data.tx.set_vout().push_back(CTxOut(1000, data.scriptPubKey));
+    for(int i = 0; i < EVALSCRIPT_BENCH_INPUTS; ++i) {
+        const uint256 hash = CSignatureHashData::Stream(data.scriptPubKey, data.tx, i, Script_param::SIGHASH_ALL);
+        key_vector vchSig;
+        assert(key.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)Script_param::SIGHASH_ALL);
+        data.tx.set_vin(i).set_scriptSig(CScript() << vchSig << pubkey);
+    }
+    return data;
+}
+
+// N signed inputs spending a bare 2-of-3 multisig scriptPubKey
+static CSignedTx MakeSignedMultisig()
+{
+    CSignedTx data;
+    CFirmKey key[3];
+    data.scriptPubKey << ScriptOpcodes::OP_2;
+    for(int k = 0; k < 3; ++k) {
+        key[k].MakeNewKey(true);
+        bool fret = false;
+        const CPubKey pubkey = key[k].GetPubKey(&fret);
+        assert(fret);
+        data.scriptPubKey << pubkey;
+    }
+    data.scriptPubKey << ScriptOpcodes::OP_3 << ScriptOpcodes::OP_CHECKMULTISIG;
+
+    for(int i = 0; i < EVALSCRIPT_BENCH_INPUTS; ++i)
+        data.tx.set_vin().push_back(CTxIn(uint256(i + 1), i));
+    data.tx.set_vout().push_back(CTxOut(1000, data.scriptPubKey));
+    for(int i = 0; i < EVALSCRIPT_BENCH_INPUTS; ++i) {
+        const uint256 hash = CSignatureHashData::Stream(data.scriptPubKey, data.tx, i, Script_param::SIGHASH_ALL);
+        CScript scriptSig;
+        scriptSig << ScriptOpcodes::OP_0;
+        for(int k = 0; k < 2; ++k) {
+            key_vector vchSig;
+            assert(key[k].Sign(hash, vchSig));
+            vchSig.push_back((unsigned char)Script_param::SIGHASH_ALL);
+            scriptSig << vchSig;
+        }
+        data.tx.set_vin(i).set_scriptSig(scriptSig);
+    }
+    return data;
+}
+
+// the script part of VerifyScript (no signature check): scriptSig, then scriptNoSig
+template <typename S>
+static bool EvalNoSig(const CSignedTx &data, int nIn, S &stack)
+{
+    stack.clear();
+    return Script_util::EvalScript(stack, data.tx.get_vin(nIn).get_scriptSig(), data.tx, nIn, EVALSCRIPT_BENCH_FLAGS, 0) &&
+           Script_util::EvalScript(stack, data.scriptNoSig, data.tx, nIn, EVALSCRIPT_BENCH_FLAGS, 0);
+}
+
+static void EvalScriptVerify(benchmark::State& state)
+{
+    const CSignedTx data = MakeSigned();
+    int i = 0;
+    while(state.KeepRunning()) {
+        Script_util::VerifyScript(data.tx.get_vin(i).get_scriptSig(), data.scriptPubKey, data.tx, i, EVALSCRIPT_BENCH_FLAGS, 0);
+        i = (i + 1) % EVALSCRIPT_BENCH_INPUTS;
+    }
+}
+
+static void EvalScriptVerifyMultisig(benchmark::State& state)
+{
+    const CSignedTx data = MakeSignedMultisig();
+    int i = 0;
+    while(state.KeepRunning()) {
+        Script_util::VerifyScript(data.tx.get_vin(i).get_scriptSig(), data.scriptPubKey, data.tx, i, EVALSCRIPT_BENCH_FLAGS, 0);
+        i = (i + 1) % EVALSCRIPT_BENCH_INPUTS;
+    }
+}
+
+// former stack type: items of PREVECTOR_N bytes inline
+static void EvalScriptStatype(benchmark::State& state)
+{
+    const CSignedTx data = MakeSigned();
+    Script_util::statype stack;
+    while(state.KeepRunning()) {
+        for(int i = 0; i < 1000; ++i)
+            EvalNoSig(data, i % EVALSCRIPT_BENCH_INPUTS, stack);
+    }
+}
+
+static void EvalScriptEvalstack(benchmark::State& state)
+{
+    const CSignedTx data = MakeSigned();
+    Script_util::evalstack stack;
+    while(state.KeepRunning()) {
+        for(int i = 0; i < 1000; ++i)
+            EvalNoSig(data, i % EVALSCRIPT_BENCH_INPUTS, stack);
+    }
+}
+
+void EvalScriptAssertcheck(benchmark::State& state)
+{
+    CSignedTx data = MakeSigned();
+    while(state.KeepRunning()) {
+        for(int i = 0; i < EVALSCRIPT_BENCH_INPUTS; ++i) {
+            assert(Script_util::VerifyScript(data.tx.get_vin(i).get_scriptSig(), data.scriptPubKey, data.tx, i, EVALSCRIPT_BENCH_FLAGS, 0));
+            assert(! Script_util::VerifyScript(data.tx.get_vin((i + 1) % EVALSCRIPT_BENCH_INPUTS).get_scriptSig(), data.scriptPubKey, data.tx, i, EVALSCRIPT_BENCH_FLAGS, 0));
+
+            // same result on both stack types, and a standard input never leaves the inline buffers
+            Script_util::statype stack1;
+            Script_util::evalstack stack2;
+            assert(EvalNoSig(data, i, stack1));
+            assert(EvalNoSig(data, i, stack2));
+            assert(stack1.size() == 2 && stack2.size() == 2);
+            for(unsigned int k = 0; k < stack2.size(); ++k) {
+                assert(stack1[k].size() == stack2[k].size());
+                assert(std::equal(stack1[k].begin(), stack1[k].end(), stack2[k].begin()));
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+                assert(stack2[k].allocated_memory() == 0);
+#endif
+            }
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+            assert(stack2.allocated_memory() == 0);
+#endif
+        }
+
+        // a signature byte flipped: rejected (not served from the signature cache)
+        CTransaction txBad(data.tx);
+        CScript scriptSig = txBad.get_vin(0).get_scriptSig();
+        scriptSig[10] ^= 0x01;
+        txBad.set_vin(0).set_scriptSig(scriptSig);
+        assert(! Script_util::VerifyScript(txBad.get_vin(0).get_scriptSig(), data.scriptPubKey, txBad, 0, EVALSCRIPT_BENCH_FLAGS, 0));
+    }
+}
+
+BENCHMARK(EvalScriptVerify, 2000);
+BENCHMARK(EvalScriptVerifyMultisig, 1000);
+BENCHMARK(EvalScriptStatype, 50);
+BENCHMARK(EvalScriptEvalstack, 50);
+BENCHMARK(EvalScriptAssertcheck, 5);
+
+} // namespace check_evalscript
@@ -0,0 +1,346 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <kernel.h>
+#include <kernel_worker.h>
+#include <crypto/sha256.h>
+
+namespace check_kernel {
+
+static constexpr uint32_t KERNEL_BENCH_TIME = 1500000000;
+static constexpr uint32_t KERNEL_BENCH_INTERVAL = 4000;
+
+struct CKernelData {
+    unsigned char kernel[8 + 16 + 4];
+    uint32_t nInputTxTime;
+    CKernelData() : nInputTxTime(KERNEL_BENCH_TIME) {
+        for(int i = 0; i < 8 + 16 + 4; ++i)
+            kernel[i] = (unsigned char)(i * 37 + 11);
+    }
+};
+
+// former scan: one nTimeTx per iteration, CBigNum target
+static KernelWorker::kernel_worker_result ScanLegacy(const CKernelData &data, uint32_t nBits, int64_t nValueIn, uint32_t nBegin, uint32_t nEnd)
+{
+    KernelWorker::kernel_worker_result solutions;
+    CBigNum bnTargetPerCoinDay; bnTargetPerCoinDay.SetCompact(nBits);
+    latest_crypto::CSHA256 sha256;
+    sha256.Write(data.kernel, 8 + 16);
+    for(uint32_t nTimeTx = nBegin; nTimeTx < nEnd; ++nTimeTx) {
+        uint256 hash1, hashProofOfStake;
+        latest_crypto::CSHA256(sha256).Write((const unsigned char *)&nTimeTx, 4).Finalize(hash1.begin());
+        latest_crypto::CSHA256().Write(hash1.begin(), 32).Finalize(hashProofOfStake.begin());
+        CBigNum bnCoinDayWeight = CBigNum(nValueIn) * bitkernel<uint256>::GetWeight((int64_t)data.nInputTxTime, (int64_t)nTimeTx) / util::COIN / util::nOneDay;
+        if (bnCoinDayWeight * bnTargetPerCoinDay >= CBigNum(hashProofOfStake))
+            solutions.push_back(std::make_pair(hashProofOfStake, nTimeTx));
+    }
+    return solutions;
+}
+
+static KernelWorker::kernel_worker_result ScanWorker(CKernelData &data, uint32_t nBits, int64_t nValueIn, uint32_t nBegin, uint32_t nEnd)
+{
+    KernelWorker worker(data.kernel, nBits, data.nInputTxTime, nValueIn, nBegin, nEnd);
+    worker.Do();
+    return worker.GetSolutions();
+}
+
+static void KernelScanLegacy(benchmark::State& state)
+{
+    const CKernelData data;
+    const uint32_t nBegin = data.nInputTxTime + block_check::nStakeMinAge;
+    while(state.KeepRunning()) {
+        ScanLegacy(data, 0x1d00ffff, 1000 * util::COIN, nBegin, nBegin + KERNEL_BENCH_INTERVAL);
+    }
+}
+
+static void KernelScanWorker(benchmark::State& state)
+{
+    CKernelData data;
+    const uint32_t nBegin = data.nInputTxTime + block_check::nStakeMinAge;
+    while(state.KeepRunning()) {
+        ScanWorker(data, 0x1d00ffff, 1000 * util::COIN, nBegin, nBegin + KERNEL_BENCH_INTERVAL);
+    }
+}
+
+void KernelAssertcheck(benchmark::State& state)
+{
+    CKernelData data;
+    // compact targets: plain, hit-rich, nSize <= 3, over 2^256, negative, zero
+    static const uint32_t nBitsList[] = {0x1d00ffff, 0x1e00ffff, 0x1f00ffff, 0x1f7fffff, 0x20012345, 0x02008000, 0x01120000, 0x03123456, 0x2100ffff, 0x40000001, 0x1f80ffff, 0x01800000, 0x00000000};
+    static const int64_t nValueList[] = {0, 1, 1000 * util::COIN, 8000000 * util::COIN, (int64_t)0x7FFFFFFFFFFFFFFF, -1000 * util::COIN};
+    // intervals: across the min age (negative weights), across the max age
+    const uint32_t nMinAge = data.nInputTxTime + block_check::nStakeMinAge;
+    const uint32_t nMaxAge = nMinAge + block_check::nStakeMaxAge;
+    const std::pair<uint32_t, uint32_t> intervals[] = {std::make_pair(nMinAge - 300, nMinAge + 301), std::make_pair(nMaxAge - 299, nMaxAge + 300)};
+    while(state.KeepRunning()) {
+        int nSolutions = 0;
+        for(const uint32_t nBits: nBitsList) {
+            for(const int64_t nValueIn: nValueList) {
+                for(const std::pair<uint32_t, uint32_t> &interval: intervals) {
+                    const KernelWorker::kernel_worker_result legacy = ScanLegacy(data, nBits, nValueIn, interval.first, interval.second);
+                    assert(ScanWorker(data, nBits, nValueIn, interval.first, interval.second) == legacy);
+                    nSolutions += legacy.size();
+
+                    // backward: the latest solution
+                    std::pair<uint32_t, uint32_t> search(interval.second - 1, interval.first - 1);
+                    std::pair<uint256, uint32_t> solution;
+                    const bool fFound = KernelWorker::ScanKernelBackward(data.kernel, nBits, data.nInputTxTime, nValueIn, search, solution);
+                    assert(fFound == !legacy.empty());
+                    if (fFound)
+                        assert(solution == legacy.back());
+
+                    // stake miner workers: every candidate counted, nothing scanned once cancelled
+                    std::atomic<bool> fCancel(false);
+                    uint64_t nHashes = 0;
+                    assert(KernelWorker::ScanKernelBackward(data.kernel, nBits, data.nInputTxTime, nValueIn, search, solution, fCancel, nHashes) == fFound);
+                    assert(fFound ? (nHashes > interval.second - 1 - solution.second): (nHashes == interval.second - interval.first));
+                    fCancel = true;
+                    nHashes = 0;
+                    assert(! KernelWorker::ScanKernelBackward(data.kernel, nBits, data.nInputTxTime, nValueIn, search, solution, fCancel, nHashes));
+                    assert(nHashes == 0);
+                }
+            }
+        }
+        assert(nSolutions > 0);
+
+        // 8-way hashing: SHA256DBlock == CSHA256 double hash of the single block message
+        unsigned char blocks[64 * 11] = {0};
+        unsigned char out[32 * 11];
+        for(int i = 0; i < 11; ++i) {
+            for(int k = 0; k < 28; ++k)
+                blocks[64 * i + k] = (unsigned char)(i * 13 + k);
+            blocks[64 * i + 28] = 0x80;
+            blocks[64 * i + 63] = 28 * 8;
+        }
+        latest_crypto::SHA256DBlock(out, blocks, 11);
+        for(int i = 0; i < 11; ++i) {
+            uint256 hash;
+            latest_crypto::CSHA256().Write(blocks + 64 * i, 28).Finalize(hash.begin());
+            latest_crypto::CSHA256().Write(hash.begin(), 32).Finalize(hash.begin());
+            assert(::memcmp(hash.begin(), out + 32 * i, 32) == 0);
+        }
+    }
+}
+
+// CheckStakeKernelHash before CStakeTarget
+static bool CheckTargetBignum(uint32_t nBits, int64_t nValueIn, int64_t nWeight, const uint256 &hashProofOfStake, uint256 &targetProofOfStake)
+{
+    CBigNum bnTargetPerCoinDay;
+    bnTargetPerCoinDay.SetCompact(nBits);
+    CBigNum bnCoinDayWeight = CBigNum(nValueIn) * nWeight / util::COIN / util::nOneDay;
+    targetProofOfStake = (bnCoinDayWeight * bnTargetPerCoinDay).getuint<uint256>();
+    return !(CBigNum(hashProofOfStake) > bnCoinDayWeight * bnTargetPerCoinDay);
+}
+
+static void KernelTargetBignum(benchmark::State& state)
+{
+    const uint256 hash = ~uint256(0) >> 40;
+    uint256 target;
+    int64_t nWeight = 0;
+    while(state.KeepRunning()) {
+        for(int i = 0; i < 1000; ++i)
+            CheckTargetBignum(0x1d00ffff, 1000 * util::COIN, nWeight++ % block_check::nStakeMaxAge, hash, target);
+    }
+}
+
+static void KernelTargetFixed(benchmark::State& state)
+{
+    const uint256 hash = ~uint256(0) >> 40;
+    int64_t nWeight = 0;
+    while(state.KeepRunning()) {
+        for(int i = 0; i < 1000; ++i)
+            CStakeTarget(0x1d00ffff, 1000 * util::COIN, nWeight++ % block_check::nStakeMaxAge).IsMet(hash);
+    }
+}
+
+void KernelTargetAssertcheck(benchmark::State& state)
+{
+    // SetCompact: nSize 0..3 (mantissa shifted out), sign bit, beyond 2^256, beyond the MPI top byte
+    std::vector<uint32_t> vBits = {0x00000000, 0x00800000, 0x00123456, 0x01003456, 0x01123456, 0x01800000, 0x01fedcba, 0x02008000, 0x02123456, 0x02808000,
+        0x03000001, 0x03123456, 0x037fffff, 0x03800001, 0x04000080, 0x04123456, 0x1d00ffff, 0x1e0fffff, 0x1f00ffff, 0x1f7fffff, 0x1f800001,
+        0x20000001, 0x20012345, 0x207fffff, 0x21000001, 0x2100ffff, 0x22000001, 0x23123456, 0x40000001, 0xff7fffff, 0xffffffff};
+    std::vector<int64_t> vValue = {0, 1, -1, util::COIN - 1, util::COIN, 1000 * util::COIN, (int64_t)util::COIN * util::nOneDay, 8000000 * util::COIN, -1000 * util::COIN,
+        (int64_t)0x7FFFFFFFFFFFFFFF, (int64_t)0x8000000000000000, (int64_t)0x8000000000000001};
+    std::vector<int64_t> vWeight = {0, 1, -1, 86399, 86400, (int64_t)block_check::nStakeMaxAge, -(int64_t)block_check::nStakeMinAge, (int64_t)0xFFFFFFFF, -(int64_t)0x1FFFFFFFF};
+    uint32_t nRand = 0x12345678;
+    for(int i = 0; i < 64; ++i) {
+        nRand = nRand * 1103515245 + 12345;
+        vBits.push_back(nRand);
+        nRand = nRand * 1103515245 + 12345;
+        vBits.push_back((0x1a + (nRand >> 28)) << 24 | (nRand & 0x00ffffff));
+    }
+    while(state.KeepRunning()) {
+        for(const uint32_t nBits: vBits) {
+            for(const int64_t nValueIn: vValue) {
+                for(const int64_t nWeight: vWeight) {
+                    uint256 targetBignum;
+                    CheckTargetBignum(nBits, nValueIn, nWeight, 0, targetBignum);
+                    const CStakeTarget target(nBits, nValueIn, nWeight);
+                    assert(target.GetTarget() == targetBignum);
+
+                    const uint256 hashes[] = {0, 1, targetBignum - 1, targetBignum, targetBignum + 1, targetBignum >> 1, ~uint256(0), ~uint256(0) >> 1, uint256(1) << 255};
+                    for(const uint256 &hash: hashes) {
+                        uint256 targetUnused;
+                        assert(target.IsMet(hash) == CheckTargetBignum(nBits, nValueIn, nWeight, hash, targetUnused));
+                    }
+                }
+            }
+        }
+
+        // 256x64 multiply, 256/32 divide
+        const uint256 m = ~uint256(0) >> 64;
+        uint256 n = m;
+        assert(n.MulU64(0xFFFFFFFFFFFFFFFF) && n == (m << 64) - m);
+        assert(! n.MulU64(0x100000000));
+        uint256 d = ~uint256(0);
+        assert(d.DivU32(0xFFFFFFFF) == 0 && d.MulU32(0xFFFFFFFF) == 0 && d == ~uint256(0));
+        d = 1000;
+        assert(d.DivU32(7) == 6 && d == 142);
+    }
+}
+
+// scaninput: the outputs of one transaction (kernels differ in nOut)
+static std::vector<CKernelScanJob::input> MakeJobInputs(const CKernelData &data, int nInputs)
+{
+    std::vector<CKernelScanJob::input> vInputs(nInputs);
+    for(int i = 0; i < nInputs; ++i) {
+        std::memcpy(vInputs[i].kernel, data.kernel, sizeof(vInputs[i].kernel));
+        vInputs[i].kernel[20] = (unsigned char)i;
+        vInputs[i].nInputTxTime = data.nInputTxTime;
+        vInputs[i].nValueIn = (i + 1) * 1000 * util::COIN;
+    }
+    return vInputs;
+}
+
+// former scaninput: one output after another
+static void KernelScanInputSerial(benchmark::State& state)
+{
+    const CKernelData data;
+    const std::vector<CKernelScanJob::input> vInputs = MakeJobInputs(data, 8);
+    const uint32_t nBegin = data.nInputTxTime + block_check::nStakeMinAge;
+    while(state.KeepRunning()) {
+        for(const CKernelScanJob::input &in: vInputs) {
+            KernelWorker worker(const_cast<unsigned char *>(in.kernel), 0x1d00ffff, in.nInputTxTime, in.nValueIn, nBegin, nBegin + KERNEL_BENCH_INTERVAL * 4);
+            worker.Do();
+        }
+    }
+}
+
+static void KernelScanInputJob(benchmark::State& state)
+{
+    const CKernelData data;
+    const std::vector<CKernelScanJob::input> vInputs = MakeJobInputs(data, 8);
+    const uint32_t nBegin = data.nInputTxTime + block_check::nStakeMinAge;
+    while(state.KeepRunning()) {
+        CKernelScanJob job(vInputs, 0x1d00ffff, nBegin, nBegin + KERNEL_BENCH_INTERVAL * 4, 0, KERNEL_BENCH_INTERVAL);
+        job.Wait();
+    }
+}
+
+void KernelScanInputAssertcheck(benchmark::State& state)
+{
+    const CKernelData data;
+    const std::vector<CKernelScanJob::input> vInputs = MakeJobInputs(data, 5);
+    const uint32_t nBegin = data.nInputTxTime + block_check::nStakeMinAge + 30 * util::nOneDay;
+    const uint32_t nEnd = nBegin + 2001;
+    static const uint32_t nBitsList[] = {0x1f00ffff, 0x1e00ffff};
+    static const int nThreadsList[] = {1, 3, 0};
+    static const uint32_t nChunkList[] = {1, 8, 100, 999, 5000};
+    while(state.KeepRunning()) {
+        for(const uint32_t nBits: nBitsList) {
+            // expected: every output serially, in output and time order
+            std::vector<CKernelScanJob::solution> expected;
+            for(size_t i = 0; i < vInputs.size(); ++i) {
+                CKernelData input;
+                std::memcpy(input.kernel, vInputs[i].kernel, sizeof(vInputs[i].kernel));
+                for(const std::pair<uint256, uint32_t> &r: ScanLegacy(input, nBits, vInputs[i].nValueIn, nBegin, nEnd)) {
+                    CKernelScanJob::solution sol;
+                    sol.nInput = i;
+                    sol.hash = r.first;
+                    sol.nTime = r.second;
+                    expected.push_back(sol);
+                }
+            }
+            assert(! expected.empty());
+
+            for(const int nThreads: nThreadsList) {
+                for(const uint32_t nChunk: nChunkList) {
+                    CKernelScanJob job(vInputs, nBits, nBegin, nEnd, nThreads, nChunk);
+                    job.Wait();
+                    assert(job.IsDone() && !job.IsCancelled());
+                    assert(job.GetChunksDone() == job.GetChunks());
+                    assert(job.GetHashes() == (uint64_t)(nEnd - nBegin) * vInputs.size());
+                    const std::vector<CKernelScanJob::solution> result = job.GetSolutions();
+                    assert(result.size() == expected.size());
+                    for(size_t k = 0; k < result.size(); ++k)
+                        assert(result[k].nInput == expected[k].nInput && result[k].hash == expected[k].hash && result[k].nTime == expected[k].nTime);
+                }
+            }
+        }
+
+        // empty window and cancel: the workers stop, nothing is scanned after the cancel
+        CKernelScanJob empty(vInputs, 0x1f00ffff, nBegin, nBegin, 0);
+        empty.Wait();
+        assert(empty.GetChunks() == 0 && empty.GetSolutions().empty());
+        // threads are clamped to the cores
+        CKernelScanJob many(vInputs, 0x1f00ffff, nBegin, nBegin + 90 * util::nOneDay, 100000);
+        many.Cancel();
+        many.Wait();
+        assert(many.GetThreads() <= std::max((int)boost::thread::hardware_concurrency(), 1));
+        CKernelScanJob job(vInputs, 0x1d00ffff, nBegin, nBegin + 90 * util::nOneDay, 2);
+        job.Cancel();
+        job.Wait();
+        assert(job.IsDone() && job.IsCancelled());
+        assert(job.GetChunksDone() < job.GetChunks());
+    }
+}
+
+// entries are dropped from the first disconnected height of the walk upwards
+void StakeModifierCacheAssertcheck(benchmark::State& state)
+{
+    // not CStakeModifierCache::cache: this also runs during static initialization
+    CStakeModifierCache cache;
+    while(state.KeepRunning()) {
+        cache.Clear();
+        const uint64_t nGeneration = cache.GetGeneration();
+        for(int i = 0; i < 100; ++i)
+            cache.Set(uint256(i + 1), 0x1000 + i, i + 10, 1000 + i, i + 20, nGeneration);
+        assert(cache.size() == 100);
+
+        uint64_t nModifier = 0;
+        int nHeight = 0;
+        int64_t nTime = 0;
+        assert(cache.Get(uint256(6), nModifier, nHeight, nTime));
+        assert(nModifier == 0x1005 && nHeight == 15 && nTime == 1005);
+        assert(! cache.Get(uint256(1000), nModifier, nHeight, nTime));
+
+        // walks ending at height 70 or above are gone (i >= 50)
+        cache.Disconnect(70);
+        assert(cache.size() == 50);
+        assert(cache.Get(uint256(50), nModifier, nHeight, nTime));
+        assert(! cache.Get(uint256(51), nModifier, nHeight, nTime));
+
+        // a walk that started before the Disconnect is not stored
+        cache.Set(uint256(51), 0x1032, 60, 1050, 70, nGeneration);
+        assert(cache.size() == 50);
+        cache.Set(uint256(51), 0x1032, 60, 1050, 69, cache.GetGeneration());
+        assert(cache.size() == 51);
+        cache.Clear();
+        assert(cache.size() == 0);
+    }
+}
+
+BENCHMARK(KernelScanLegacy, 50);
+BENCHMARK(KernelScanWorker, 50);
+BENCHMARK(KernelAssertcheck, 2);
+BENCHMARK(KernelTargetBignum, 50);
+BENCHMARK(KernelTargetFixed, 50);
+BENCHMARK(KernelTargetAssertcheck, 2);
+BENCHMARK(KernelScanInputSerial, 5);
+BENCHMARK(KernelScanInputJob, 5);
+BENCHMARK(KernelScanInputAssertcheck, 1);
+BENCHMARK(StakeModifierCacheAssertcheck, 2);
+
+} // namespace check_kernel
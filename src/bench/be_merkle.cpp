@@ -0,0 +1,61 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <block/transaction.h>
+#include <merkle/merkle_tree.h>
+#include <crypto/sha256.h>
+
+namespace check_merkle {
+
+// consolidation-sized block: many transactions, odd count on several levels
+static constexpr int MERKLE_BENCH_TX = 3001;
+
+class CMerkleBench : public CMerkleTree<uint256, CTransaction>
+{
+public:
+    explicit CMerkleBench(int nTx) {
+        vtx.resize(nTx);
+        for(int i = 0; i < nTx; ++i) {
+            vtx[i].set_nTime(i);
+            vtx[i].set_nLockTime() = i;
+        }
+    }
+};
+
+static void MerkleScalar(benchmark::State& state)
+{
+    CMerkleBench tree(MERKLE_BENCH_TX);
+    while(state.KeepRunning()) {
+        tree.BuildMerkleTreeScalar();
+    }
+}
+
+static void MerkleMultiway(benchmark::State& state)
+{
+    latest_crypto::SHA256AutoDetect();
+    CMerkleBench tree(MERKLE_BENCH_TX);
+    while(state.KeepRunning()) {
+        tree.BuildMerkleTree();
+    }
+}
+
+void MerkleAssertcheck(benchmark::State& state)
+{
+    latest_crypto::SHA256AutoDetect();
+    while(state.KeepRunning()) {
+        for(int n = 0; n <= 70; ++n) {
+            CMerkleBench tree(n);
+            const uint256 scalar = tree.BuildMerkleTreeScalar();
+            const uint256 multiway = tree.BuildMerkleTree();
+            assert(scalar == multiway);
+        }
+    }
+}
+
+BENCHMARK(MerkleScalar, 20);
+BENCHMARK(MerkleMultiway, 20);
+BENCHMARK(MerkleAssertcheck, 5);
+
+} // namespace check_merkle
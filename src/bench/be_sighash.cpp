@@ -0,0 +1,148 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <block/transaction.h>
+#include <script/sighash.h>
+#include <hash.h>
+
+namespace check_sighash {
+
+//
+// SigHash{Copy,Stream,Precomputed}_N hash every input of an N-input
+// transaction with SIGHASH_ALL once per iteration. Precomputed also pays
+// for building its CSignatureHashData inside the loop, as ConnectInputs does.
+//
+
+// consolidation (mergecoins) shaped: N P2PKH-sized inputs, 2 outputs
+static CTransaction MakeTx(int nInputs)
+{
+    CTransaction tx;
+    for(int i = 0; i < nInputs; ++i) {
+        tx.set_vin().push_back(CTxIn(uint256(i + 1), i & 3));
+        tx.set_vin(i).set_scriptSig(CScript() << script_vector(72, (unsigned char)i) << script_vector(33, (unsigned char)0x02));
+        tx.set_vin(i).set_nSequence(0xffffffff - (i & 1));
+    }
+    tx.set_vout().push_back(CTxOut(1000, CScript() << ScriptOpcodes::OP_DUP << ScriptOpcodes::OP_HASH160 << script_vector(20, (unsigned char)0x11) << ScriptOpcodes::OP_EQUALVERIFY << ScriptOpcodes::OP_CHECKSIG));
+    tx.set_vout().push_back(CTxOut(2000, CScript() << script_vector(33, (unsigned char)0x03) << ScriptOpcodes::OP_CHECKSIG));
+    tx.set_nLockTime() = 12345;
+    return tx;
+}
+
+static CScript MakeScriptCode()
+{
+    return CScript() << ScriptOpcodes::OP_DUP << ScriptOpcodes::OP_HASH160 << script_vector(20, (unsigned char)0x22) << ScriptOpcodes::OP_EQUALVERIFY << ScriptOpcodes::OP_CHECKSIG;
+}
+
+// the former SignatureHash: copy the transaction, blank it, serialize it
+static uint256 SignatureHashCopy(const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType)
+{
+    CTransaction txTmp(txTo);
+    for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i)
+        txTmp.set_vin(i).set_scriptSig(CScript());
+    txTmp.set_vin(nIn).set_scriptSig(scriptCode);
+    if ((nHashType & 0x1f) == Script_param::SIGHASH_NONE) {
+        txTmp.set_vout().clear();
+        for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i) {
+            if (i != nIn)
+                txTmp.set_vin(i).set_nSequence(0);
+        }
+    } else if ((nHashType & 0x1f) == Script_param::SIGHASH_SINGLE) {
+        if (nIn >= txTmp.get_vout().size())
+            return 1;
+        txTmp.set_vout().resize(nIn + 1);
+        for (unsigned int i = 0; i < nIn; ++i)
+            txTmp.set_vout(i).SetNull();
+        for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i) {
+            if (i != nIn)
+                txTmp.set_vin(i).set_nSequence(0);
+        }
+    }
+    if (nHashType & Script_param::SIGHASH_ANYONECANPAY) {
+        txTmp.set_vin(0) = txTmp.get_vin(nIn);
+        txTmp.set_vin().resize(1);
+    }
+    CDataStream ss(SER_GETHASH, 0);
+    ss.reserve(10000);
+    ss << txTmp << nHashType;
+    return hash_basis::Hash(ss.begin(), ss.end());
+}
+
+static void SigHashCopy(benchmark::State& state, int nInputs)
+{
+    const CTransaction tx = MakeTx(nInputs);
+    const CScript scriptCode = MakeScriptCode();
+    while(state.KeepRunning()) {
+        for(int i = 0; i < nInputs; ++i)
+            SignatureHashCopy(scriptCode, tx, i, Script_param::SIGHASH_ALL);
+    }
+}
+
+static void SigHashStream(benchmark::State& state, int nInputs)
+{
+    const CTransaction tx = MakeTx(nInputs);
+    const CScript scriptCode = MakeScriptCode();
+    while(state.KeepRunning()) {
+        for(int i = 0; i < nInputs; ++i)
+            CSignatureHashData::Stream(scriptCode, tx, i, Script_param::SIGHASH_ALL);
+    }
+}
+
+static void SigHashPrecomputed(benchmark::State& state, int nInputs)
+{
+    const CTransaction tx = MakeTx(nInputs);
+    const CScript scriptCode = MakeScriptCode();
+    while(state.KeepRunning()) {
+        const CSignatureHashData sighash(tx);
+        for(int i = 0; i < nInputs; ++i)
+            sighash.SignatureHash(scriptCode, tx, i, Script_param::SIGHASH_ALL);
+    }
+}
+
+static void SigHashCopy_1(benchmark::State& state) {SigHashCopy(state, 1);}
+static void SigHashCopy_100(benchmark::State& state) {SigHashCopy(state, 100);}
+static void SigHashCopy_1000(benchmark::State& state) {SigHashCopy(state, 1000);}
+static void SigHashStream_1(benchmark::State& state) {SigHashStream(state, 1);}
+static void SigHashStream_100(benchmark::State& state) {SigHashStream(state, 100);}
+static void SigHashStream_1000(benchmark::State& state) {SigHashStream(state, 1000);}
+static void SigHashPrecomputed_1(benchmark::State& state) {SigHashPrecomputed(state, 1);}
+static void SigHashPrecomputed_100(benchmark::State& state) {SigHashPrecomputed(state, 100);}
+static void SigHashPrecomputed_1000(benchmark::State& state) {SigHashPrecomputed(state, 1000);}
+
+void SigHashAssertcheck(benchmark::State& state)
+{
+    static const int hashtypes[] = {
+        Script_param::SIGHASH_ALL, Script_param::SIGHASH_NONE, Script_param::SIGHASH_SINGLE,
+        Script_param::SIGHASH_ALL | Script_param::SIGHASH_ANYONECANPAY,
+        Script_param::SIGHASH_NONE | Script_param::SIGHASH_ANYONECANPAY,
+        Script_param::SIGHASH_SINGLE | Script_param::SIGHASH_ANYONECANPAY
+    };
+    const CScript scriptCode = MakeScriptCode();
+    while(state.KeepRunning()) {
+        for(int n = 1; n <= 5; ++n) {
+            const CTransaction tx = MakeTx(n);
+            const CSignatureHashData sighash(tx);
+            for(int i = 0; i < n; ++i) {
+                for(int nHashType: hashtypes) {
+                    const uint256 copy = SignatureHashCopy(scriptCode, tx, i, nHashType);
+                    assert(copy == CSignatureHashData::Stream(scriptCode, tx, i, nHashType));
+                    assert(copy == sighash.SignatureHash(scriptCode, tx, i, nHashType));
+                }
+            }
+        }
+    }
+}
+
+BENCHMARK(SigHashCopy_1, 5000);
+BENCHMARK(SigHashCopy_100, 50);
+BENCHMARK(SigHashCopy_1000, 1);
+BENCHMARK(SigHashStream_1, 5000);
+BENCHMARK(SigHashStream_100, 50);
+BENCHMARK(SigHashStream_1000, 1);
+BENCHMARK(SigHashPrecomputed_1, 5000);
+BENCHMARK(SigHashPrecomputed_100, 50);
+BENCHMARK(SigHashPrecomputed_1000, 1);
+BENCHMARK(SigHashAssertcheck, 5);
+
+} // namespace check_sighash
@@ -5,6 +5,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <block/block.h>
+#include <cstring>
 #include <wallet.h>
 #include <checkpoints.h>
 #include <kernel.h>
@@ -14,6 +15,9 @@
 #include <block/block_process.h>
 #include <miner/diff.h>
 #include <block/block_info.h>
+#include <block/prevout_cache.h>
+#include <file_operate/block_mmap.h>
+#include <file_operate/block_store.h>
 #include <prime/autocheckpoint.h>
 #include <util/system.h>
 
@@ -55,7 +59,7 @@ template <typename T>
 void CBlock_print_impl<T>::PrintBlockTree() {
     // pre-compute tree structure
     std::map<CBlockIndex *, vBlockIndex_t> mapNext;
-    for (std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.begin(); mi != block_info::mapBlockIndex.end(); ++mi) {
+    for (BlockMap::iterator mi = block_info::mapBlockIndex.begin(); mi != block_info::mapBlockIndex.end(); ++mi) {
         CBlockIndex *pindex = (*mi).second;
         mapNext[pindex->set_pprev()].push_back(pindex);
         // test
@@ -152,6 +156,9 @@ bool block_notify<T>::IsInitialBlockDownload()
     return (nCurrentTime - nLastUpdate < 10 && block_info::pindexBest->GetBlockTime() < nCurrentTime - util::nOneDay);
 }
 
+template <typename T>
+std::atomic<uint64_t> CBlockHeader_impl<T>::nHashEvaluations(0);
+
 template <typename T>
 uint256 CBlockHeader_impl<T>::GetHash() const { // todo: from uint256 to T (please replace bitscrypt to T)
     // debug
@@ -160,8 +167,18 @@ uint256 CBlockHeader_impl<T>::GetHash() const { // todo: from uint256 to T (plea
     //debugcs::instance() << "QHASH65536:" << debugcs::endl();
     //debugcs::instance() << tt.GetHex() << debugcs::endl() << "------------------------" << debugcs::endl();
 
-    assert(sizeof(*this)==80); // uint256 blockheader size.
-    return bitscrypt::scrypt_blockhash((const uint8_t *)this);
+    const CBlockHeader<T> &header = *this;
+    static_assert(sizeof(CBlockHeader<T>)==80, "uint256 blockheader size.");
+    const std::shared_ptr<const CHashMemo> memo = std::atomic_load(&hashMemo);
+    if (memo && std::memcmp(&memo->header, &header, sizeof(CBlockHeader<T>)) == 0)
+        return memo->hash;
+
+    ++nHashEvaluations;
+    std::shared_ptr<CHashMemo> fresh = std::make_shared<CHashMemo>();
+    fresh->header = header;
+    fresh->hash = bitscrypt::scrypt_blockhash((const uint8_t *)&fresh->header);
+    std::atomic_store(&hashMemo, std::shared_ptr<const CHashMemo>(fresh));
+    return fresh->hash;
 }
 
 template <typename T>
@@ -221,6 +238,39 @@ bool CBlock_impl<T>::ConnectBlock(CTxDB &txdb, CBlockIndex *pindex, bool fJustCh
     std::map<T, CTxIndex> mapQueuedChanges;
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && block_info::nScriptCheckThreads ? &block_check::thread::scriptcheckqueue : NULL);
 
+    // Prefetch stage: resolve the committed inputs of the whole block up front and read the
+    // previous transactions concurrently, so the serial loop below only consumes the results.
+    // Inputs created in this block are left to mapQueuedChanges as before.
+    MapPrevTx mapPrefetched;
+    if (block_info::nScriptCheckThreads) {
+        std::set<T> setInBlock;
+        for(const CTransaction &tx: this->vtx)
+            setInBlock.insert(tx.GetHash());
+
+        std::vector<CPrevoutFetch> vFetches;
+        for(const CTransaction &tx: this->vtx) {
+            if (tx.IsCoinBase())
+                continue;
+            for(const CTxIn &txin: tx.get_vin()) {
+                const T &hashPrev = txin.get_prevout().get_hash();
+                if (setInBlock.count(hashPrev) || mapPrefetched.count(hashPrev))
+                    continue;
+
+                CTxIndex txindex;
+                if (!txdb.ReadTxIndex(hashPrev, txindex) || txindex.get_pos() == CDiskTxPos(1,1,1))
+                    continue; // not on disk: FetchInputs handles it
+                typename MapPrevTx::mapped_type &prev = mapPrefetched[hashPrev];
+                prev.first = txindex;
+                if (! CPrevoutCache::cache.GetTx(hashPrev, txindex.get_pos(), prev.second))
+                    vFetches.push_back(CPrevoutFetch(hashPrev, txindex.get_pos(), prev.second));
+            }
+        }
+
+        CCheckQueueControl<CPrevoutFetch> fetchcontrol(&block_check::thread::prevoutfetchqueue);
+        fetchcontrol.Add(vFetches);
+        fetchcontrol.Wait();
+    }
+
     int64_t nFees = 0;
     int64_t nValueIn = 0;
     int64_t nValueOut = 0;
@@ -249,7 +299,7 @@ bool CBlock_impl<T>::ConnectBlock(CTxDB &txdb, CBlockIndex *pindex, bool fJustCh
             nValueOut += tx.GetValueOut();
         else {
             bool fInvalid;
-            if (! tx.FetchInputs(txdb, mapQueuedChanges, true, false, mapInputs, fInvalid))
+            if (! tx.FetchInputs(txdb, mapQueuedChanges, true, false, mapInputs, fInvalid, &mapPrefetched))
                 return false;
 
             // Add in sigops done by pay-to-script-hash inputs;
@@ -266,12 +316,7 @@ bool CBlock_impl<T>::ConnectBlock(CTxDB &txdb, CBlockIndex *pindex, bool fJustCh
             if (! tx.IsCoinStake())
                 nFees += nTxValueIn - nTxValueOut;
 
-            unsigned int nFlags = Script_param::SCRIPT_VERIFY_NOCACHE | Script_param::SCRIPT_VERIFY_P2SH;
-            if (tx.get_nTime() >= timestamps::CHECKLOCKTIMEVERIFY_SWITCH_TIME) {
-                nFlags |= Script_param::SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
-                // OP_CHECKSEQUENCEVERIFY is senseless without BIP68, so we're going disable it for now.
-                // nFlags |= Script_param::SCRIPT_VERIFY_CHECKSEQUENCEVERIFY;
-            }
+            const unsigned int nFlags = block_check::manage<T>::GetBlockScriptFlags(tx);
 
             std::vector<CScriptCheck> vChecks;
             if (! tx.ConnectInputs(txdb, mapInputs, mapQueuedChanges, posThisTx, pindex, true, false, fScriptChecks, nFlags, block_info::nScriptCheckThreads ? &vChecks : nullptr))
@@ -453,12 +498,10 @@ bool CBlock_impl<T>::AddToBlockIndex(unsigned int nFile, unsigned int nBlockPos)
         return logging::error("AddToBlockIndex() : %s already exists", hash.ToString().substr(0,20).c_str());
 
     // Construct new block index object
-    CBlockIndex *pindexNew = new(std::nothrow) CBlockIndex(nFile, nBlockPos, *this);
-    if (! pindexNew)
-        return logging::error("AddToBlockIndex() : new CBlockIndex failed");
+    CBlockIndex *pindexNew = block_info::mapBlockIndex.NewIndex(nFile, nBlockPos, *this);
 
     pindexNew->set_phashBlock(&hash);
-    typename std::map<T, CBlockIndex *>::iterator miPrev = block_info::mapBlockIndex.find(CBlockHeader<T>::hashPrevBlock);
+    typename CBlockIndexMap_impl<T>::iterator miPrev = block_info::mapBlockIndex.find(CBlockHeader<T>::hashPrevBlock);
     if (miPrev != block_info::mapBlockIndex.end()) {
         pindexNew->set_pprev((*miPrev).second);
         pindexNew->set_nHeight(pindexNew->get_pprev()->get_nHeight() + 1);
@@ -490,7 +533,7 @@ bool CBlock_impl<T>::AddToBlockIndex(unsigned int nFile, unsigned int nBlockPos)
         return logging::error("AddToBlockIndex() : Rejected by stake modifier checkpoint height=%d, modifier=0x%016" PRIx64, pindexNew->get_nHeight(), nStakeModifier);
 
     // Add to block_info::mapBlockIndex
-    typename std::map<T, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
+    typename CBlockIndexMap_impl<T>::iterator mi = block_info::mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     if (pindexNew->IsProofOfStake())
         block_info::setStakeSeen.insert(std::make_pair(pindexNew->get_prevoutStake(), pindexNew->get_nStakeTime()));
     pindexNew->set_phashBlock(&((*mi).first));
@@ -633,7 +676,7 @@ bool CBlock_impl<T>::AcceptBlock()
         return logging::error("CBlock::AcceptBlock() : block already in block_info::mapBlockIndex");
 
     // Get prev block index
-    typename std::map<T, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(CBlockHeader<T>::hashPrevBlock);
+    typename CBlockIndexMap_impl<T>::iterator mi = block_info::mapBlockIndex.find(CBlockHeader<T>::hashPrevBlock);
     if (mi == block_info::mapBlockIndex.end())
         return DoS(10, logging::error("CBlock::AcceptBlock() : prev block not found"));
 
@@ -780,36 +823,41 @@ bool CBlock_impl<T>::SetBestChainInner(CTxDB &txdb, CBlockIndex *pindexNew)
 
 template<typename T>
 bool CBlock_impl<T>::WriteToDisk(unsigned int &nFileRet, unsigned int &nBlockPosRet) {
-    // Open history file to append
-    CAutoFile fileout = CAutoFile(file_open::AppendBlockFile(nFileRet), SER_DISK, version::CLIENT_VERSION);
-    if (! fileout) return logging::error("CBlock::WriteToDisk() : file_open::AppendBlockFile failed");
-    // Write index header
-    unsigned int nSize = fileout.GetSerializeSize(*this);
-    fileout << FLATDATA(block_info::gpchMessageStart) << nSize;
-    // Write block
-    long fileOutPos = ::ftell(fileout);
-    if (fileOutPos < 0) return logging::error("CBlock::WriteToDisk() : ftell failed");
-    nBlockPosRet = fileOutPos;
-    fileout << *this;
-    // Flush stdio buffers and commit to disk before returning
-    fflush(fileout);
-    if (!block_notify<T>::IsInitialBlockDownload() || (block_info::nBestHeight+1)%500==0)
-        iofs::FileCommit(fileout);
+    // Append to the history file kept open by block_store
+    // (flushed for readers; fsync grouped by block_store while in initial download)
+    if (! block_store::Write(*this, block_info::gpchMessageStart, nFileRet, nBlockPosRet, block_notify<T>::IsInitialBlockDownload()))
+        return logging::error("CBlock::WriteToDisk() : block_store::Write failed");
     return true;
 }
 
 template <typename T>
 bool CBlock_impl<T>::ReadFromDisk(unsigned int nFile, unsigned int nBlockPos, bool fReadTransactions/*=true*/) {
     SetNull();
-    // Open history file to read
-    CAutoFile filein = CAutoFile(file_open::OpenBlockFile(nFile, nBlockPos, "rb"), SER_DISK, version::CLIENT_VERSION);
-    if (! filein) return logging::error("CBlock::ReadFromDisk() : file_open::OpenBlockFile failed");
-    if (! fReadTransactions) filein.AddType(SER_BLOCKHEADERONLY);
-    // Read block
-    try {
-        filein >> *this;
-    } catch (const std::exception &) {
-        return logging::error("%s() : deserialize or I/O error", BOOST_CURRENT_FUNCTION);
+    std::shared_ptr<const CBlockFileMapping> pmap = block_mmap::Get(nFile, nBlockPos);
+    bool fMapped = false;
+    if (pmap) {
+        // Read block straight from the mapped history file
+        // (the reader stops at the end of the file; anything it cannot read is read again through stdio)
+        try {
+            CSpanReader reader(pmap, nBlockPos, SER_DISK, version::CLIENT_VERSION);
+            if (! fReadTransactions) reader.AddType(SER_BLOCKHEADERONLY);
+            reader >> *this;
+            fMapped = true;
+        } catch (const std::exception &) {
+            SetNull();
+        }
+    }
+    if (! fMapped) {
+        // Open history file to read
+        CAutoFile filein = CAutoFile(file_open::OpenBlockFile(nFile, nBlockPos, "rb"), SER_DISK, version::CLIENT_VERSION);
+        if (! filein) return logging::error("CBlock::ReadFromDisk() : file_open::OpenBlockFile failed");
+        if (! fReadTransactions) filein.AddType(SER_BLOCKHEADERONLY);
+        // Read block
+        try {
+            filein >> *this;
+        } catch (const std::exception &) {
+            return logging::error("%s() : deserialize or I/O error", BOOST_CURRENT_FUNCTION);
+        }
     }
     // Check the header
     if (fReadTransactions && IsProofOfWork() && !diff::check::CheckProofOfWork(CBlockHeader_impl<T>::GetHash(), CBlockHeader<T>::nBits))
@@ -7,6 +7,8 @@
 #ifndef BITCOIN_BLOCK_H
 #define BITCOIN_BLOCK_H
 
+#include <atomic>
+#include <memory>
 #include <script/interpreter.h>
 #include <block/transaction.h>
 #include <block/block_locator.h>
@@ -72,11 +74,33 @@ public:
 };
 template <typename T>
 class CBlockHeader_impl : public CBlockHeader<T> {
+private:
+    // GetHash() memo: the scrypt hash and the 80-byte header it was computed from.
+    // The header fields are also mutated through references (miner nonce/time) and
+    // by deserialization, so the memo is validated against the header on every call.
+    // GetHash() runs on the net, miner and RPC threads at once: the memo is never
+    // written in place, a new one is swapped in with std::atomic_store.
+    struct CHashMemo {
+        CBlockHeader<T> header;
+        uint256 hash;
+    };
+    mutable std::shared_ptr<const CHashMemo> hashMemo;
+    static std::atomic<uint64_t> nHashEvaluations;
 public:
+    CBlockHeader_impl() {}
+    CBlockHeader_impl(const CBlockHeader_impl &obj) : CBlockHeader<T>(obj), hashMemo(std::atomic_load(&obj.hashMemo)) {}
+    CBlockHeader_impl &operator=(const CBlockHeader_impl &obj) {
+        CBlockHeader<T>::operator=(obj);
+        std::atomic_store(&hashMemo, std::atomic_load(&obj.hashMemo));
+        return *this;
+    }
     bool IsNull() const {
         return (CBlockHeader<T>::nBits == 0);
     }
     uint256 GetHash() const;
+    static uint64_t GetHashEvaluations() {
+        return nHashEvaluations.load();
+    }
     int64_t GetBlockTime() const {
         return (int64_t)CBlockHeader<T>::nTime;
     }
@@ -396,6 +420,7 @@ private:
     CDiskBlockIndex_impl &operator=(const CDiskBlockIndex_impl &)=delete;
     CDiskBlockIndex_impl &operator=(const CDiskBlockIndex_impl &&)=delete;
     mutable T blockHash;
+    bool fBlockHashKnown; // blockHash carried over from the in-memory index
     T hashPrev;
     T hashNext;
 public:
@@ -407,12 +432,17 @@ public:
         hashPrev = 0;
         hashNext = 0;
         blockHash = 0;
+        fBlockHashKnown = false;
     }
     explicit CDiskBlockIndex_impl(CBlockIndex_impl<T> *pindex) : CBlockIndex_impl<T>(*pindex) {
         hashPrev = (CBlockIndex_impl<T>::pprev ? CBlockIndex_impl<T>::pprev->GetBlockHash() : 0);
         hashNext = (CBlockIndex_impl<T>::pnext ? CBlockIndex_impl<T>::pnext->GetBlockHash() : 0);
+        blockHash = pindex->GetBlockHash(); // the map key: scrypt already ran for this header
+        fBlockHashKnown = (blockHash != 0);
     }
     T GetBlockHash() const {
+        if (fBlockHashKnown)
+            return blockHash;
         if (args_bool::fUseFastIndex && (CBlockIndex_impl<T>::nTime < bitsystem::GetAdjustedTime() - util::nOneDay) && this->blockHash != 0)
             return blockHash;
         CBlock_impl<T> block;
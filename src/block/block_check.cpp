@@ -5,11 +5,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <block/block_check.h>
+#include <kernel.h>
 #include <net.h>
 #include <txdb.h>
 #include <util/thread.h>
 
 CCheckQueue<CScriptCheck> block_check::thread::scriptcheckqueue(128);
+CCheckQueue<CPrevoutFetch> block_check::thread::prevoutfetchqueue(16);
 unsigned int block_check::nStakeMinAge = block_check::mainnet::nStakeMinAge;
 unsigned int block_check::nStakeTargetSpacing = block_check::mainnet::nStakeTargetSpacing;
 unsigned int block_check::nPowTargetSpacing = block_check::mainnet::nPowTargetSpacing;
@@ -44,6 +46,18 @@ bool block_check::manage<T>::VerifySignature(const CTransaction &txFrom, const C
     return CScriptCheck(txFrom, txTo, nIn, flags, nHashType)();    // Call by functor
 }
 
+template <typename T>
+unsigned int block_check::manage<T>::GetBlockScriptFlags(const CTransaction &tx)
+{
+    unsigned int nFlags = Script_param::SCRIPT_VERIFY_NOCACHE | Script_param::SCRIPT_VERIFY_P2SH;
+    if (tx.get_nTime() >= timestamps::CHECKLOCKTIMEVERIFY_SWITCH_TIME) {
+        nFlags |= Script_param::SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
+        // OP_CHECKSEQUENCEVERIFY is senseless without BIP68, so we're going disable it for now.
+        // nFlags |= Script_param::SCRIPT_VERIFY_CHECKSEQUENCEVERIFY;
+    }
+    return nFlags;
+}
+
 template <typename T>
 bool block_check::manage<T>::Reorganize(CTxDB_impl<T> &txdb, CBlockIndex_impl<T> *pindexNew)
 {
@@ -119,6 +133,7 @@ bool block_check::manage<T>::Reorganize(CTxDB_impl<T> &txdb, CBlockIndex_impl<T>
         if (pindex->get_pprev())
             pindex->set_pprev()->set_pnext(nullptr);
     }
+    CStakeModifierCache_impl<T>::cache.Disconnect(pfork->get_nHeight() + 1);
 
     // Connect longer branch
     for(CBlockIndex *pindex: vConnect) {
@@ -146,9 +161,19 @@ void block_check::thread::ThreadScriptCheck(void *)
     net_node::vnThreadsRunning[THREAD_SCRIPTCHECK]--;
 }
 
+// prevout prefetch workers are counted as script check threads
+void block_check::thread::ThreadPrevoutFetch(void *)
+{
+    net_node::vnThreadsRunning[THREAD_SCRIPTCHECK]++;
+    bitthread::RenameThread(strCoinName "-prevfetch");
+    prevoutfetchqueue.Thread();
+    net_node::vnThreadsRunning[THREAD_SCRIPTCHECK]--;
+}
+
 void block_check::thread::ThreadScriptCheckQuit()
 {
     scriptcheckqueue.Quit();
+    prevoutfetchqueue.Quit();
 }
 
 template class block_check::manage<uint256>;
@@ -42,6 +42,7 @@ namespace block_check
     public:
         static void InvalidChainFound(CBlockIndex_impl<T> *pindexNew);
         static bool VerifySignature(const CTransaction &txFrom, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType);
+        static unsigned int GetBlockScriptFlags(const CTransaction &tx); // ConnectBlock script flags for tx
         static bool Reorganize(CTxDB_impl<T> &txdb, CBlockIndex_impl<T> *pindexNew);
 
         static int64_t PastDrift(int64_t nTime) {    // up to 2 hours from the past
@@ -56,7 +57,9 @@ namespace block_check
     {
     public:
         static CCheckQueue<CScriptCheck> scriptcheckqueue;
+        static CCheckQueue<CPrevoutFetch> prevoutfetchqueue;
         static void ThreadScriptCheck(void *);
+        static void ThreadPrevoutFetch(void *);
         static void ThreadScriptCheckQuit();
     };
 }
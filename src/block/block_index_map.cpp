@@ -0,0 +1,112 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <block/block_index_map.h>
+#include <block/block.h>
+#include <random/random.h>
+#include <util/logging.h>
+
+// Note: t has a free slot for pvalue
+template <typename T>
+void CBlockIndexMap_impl<T>::Place(table &t, value_type *pvalue, uint64_t nKey) noexcept {
+    const size_t nMask = t.nSlots - 1;
+    size_t i = Slot(t, nKey);
+    while (t.pslot[i].pvalue.load(std::memory_order_relaxed) != nullptr)
+        i = (i + 1) & nMask;
+    t.pslot[i].nKey = nKey;
+    t.pslot[i].pvalue.store(pvalue, std::memory_order_release); // last: readers check pvalue first
+}
+
+// The new array is filled before it is published; the old one stays in vTable
+// (a reader without cs_main may still be probing it).
+template <typename T>
+void CBlockIndexMap_impl<T>::Rehash(size_t nSlots) {
+    if (vTable.empty())
+        latest_crypto::random::GetRandBytes((unsigned char *)&nSalt, sizeof(nSalt));
+
+    std::unique_ptr<table> pnew(new table);
+    pnew->pslot.reset(new slot[nSlots]);
+    pnew->nSlots = nSlots;
+    pnew->nShift = 64;
+    for (size_t n = nSlots; n > 1; n >>= 1)
+        --pnew->nShift;
+    for (size_t i = 0; i < nSlots; ++i) {
+        pnew->pslot[i].nKey = 0;
+        pnew->pslot[i].pvalue.store(nullptr, std::memory_order_relaxed);
+    }
+
+    const table *pold = ptable.load(std::memory_order_relaxed);
+    if (pold) {
+        for (size_t i = 0; i < pold->nSlots; ++i) {
+            value_type *pvalue = pold->pslot[i].pvalue.load(std::memory_order_relaxed);
+            if (pvalue != nullptr)
+                Place(*pnew, pvalue, pold->pslot[i].nKey);
+        }
+    }
+    vTable.push_back(std::move(pnew));
+    ptable.store(vTable.back().get(), std::memory_order_release);
+}
+
+// keeps the load factor at or below 1/2
+template <typename T>
+void CBlockIndexMap_impl<T>::reserve(size_t n) {
+    const table *t = ptable.load(std::memory_order_relaxed);
+    size_t nSlots = t ? t->nSlots : MIN_SLOTS;
+    while (nSlots < n * 2)
+        nSlots <<= 1;
+    if (t == nullptr || nSlots != t->nSlots)
+        Rehash(nSlots);
+}
+
+template <typename T>
+std::pair<typename CBlockIndexMap_impl<T>::iterator, bool> CBlockIndexMap_impl<T>::insert(const std::pair<T, CBlockIndex_impl<T> *> &obj) {
+    const uint64_t nKey = Truncate(obj.first);
+    table *t = ptable.load(std::memory_order_relaxed);
+    if (t) {
+        slot *s = Lookup(*t, obj.first, nKey);
+        if (s)
+            return std::make_pair(iterator(s, t->pslot.get() + t->nSlots), false);
+    }
+
+    reserve(nCount.load(std::memory_order_relaxed) + 1);
+    t = ptable.load(std::memory_order_relaxed);
+    value_type *pvalue = nodes.New(obj.first, obj.second);
+    Place(*t, pvalue, nKey);
+    ++nCount;
+    return std::make_pair(iterator(Lookup(*t, obj.first, nKey), t->pslot.get() + t->nSlots), true);
+}
+
+// Note: no reader may be running (shutdown, reindex)
+template <typename T>
+void CBlockIndexMap_impl<T>::clear() noexcept {
+    ptable.store(nullptr, std::memory_order_release);
+    vTable.clear();
+    nCount = 0;
+    nodes.Clear();
+    indexes.Clear();
+}
+
+template <typename T>
+size_t CBlockIndexMap_impl<T>::DynamicUsage() const noexcept {
+    size_t nUsage = vTable.capacity() * sizeof(std::unique_ptr<table>);
+    for (const std::unique_ptr<table> &t: vTable)
+        nUsage += sizeof(table) + t->nSlots * sizeof(slot);
+    return nUsage + nodes.DynamicUsage() + indexes.DynamicUsage();
+}
+
+// red-black tree node (3 pointers + color) plus malloc overhead for every node and CBlockIndex
+template <typename T>
+size_t CBlockIndexMap_impl<T>::StdMapUsageEstimate() const noexcept {
+    const size_t nMallocOverhead = 2 * sizeof(void *);
+    return nCount.load() * (4 * sizeof(void *) + sizeof(value_type) + nMallocOverhead) +
+        indexes.size() * (sizeof(CBlockIndex_impl<T>) + nMallocOverhead);
+}
+
+template <typename T>
+std::string CBlockIndexMap_impl<T>::ToString() const {
+    return tfm::format("CBlockIndexMap(entries=%" PRIszu ", indexes=%" PRIszu ", slots=%" PRIszu ", usage=%.1fMiB, std::map estimate=%.1fMiB)",
+        nCount.load(), indexes.size(), ptable.load() ? ptable.load()->nSlots : (size_t)0, DynamicUsage() / 1048576.0, StdMapUsageEstimate() / 1048576.0);
+}
+
+template class CBlockIndexMap_impl<uint256>;
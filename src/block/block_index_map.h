@@ -0,0 +1,228 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_BLOCK_INDEX_MAP_H
+#define SORACHANCOIN_BLOCK_INDEX_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include <uint256.h>
+
+template <typename T> class CBlockIndex_impl;
+
+// Slab allocator: objects are constructed in fixed-size chunks and never move.
+// Objects are only released all together by Clear().
+template <typename U, size_t N = 4096>
+class CSlabArena
+{
+    CSlabArena(const CSlabArena &)=delete;
+    CSlabArena &operator=(const CSlabArena &)=delete;
+private:
+    std::vector<U *> vChunk;
+    size_t nUsed; // objects in vChunk.back()
+public:
+    CSlabArena() noexcept : nUsed(N) {}
+    ~CSlabArena() {Clear();}
+
+    template <typename... Args>
+    U *New(Args&&... args) {
+        if (nUsed == N) {
+            vChunk.push_back(static_cast<U *>(::operator new(sizeof(U) * N)));
+            nUsed = 0;
+        }
+        U *p = new(vChunk.back() + nUsed) U(std::forward<Args>(args)...);
+        ++nUsed;
+        return p;
+    }
+
+    void Clear() noexcept {
+        for (size_t i = 0; i < vChunk.size(); ++i) {
+            const size_t nObj = (i + 1 == vChunk.size()) ? nUsed : N;
+            for (size_t j = 0; j < nObj; ++j)
+                vChunk[i][j].~U();
+            ::operator delete(vChunk[i]);
+        }
+        vChunk.clear();
+        nUsed = N;
+    }
+
+    size_t size() const noexcept {
+        return vChunk.empty() ? 0 : (vChunk.size() - 1) * N + nUsed;
+    }
+    size_t DynamicUsage() const noexcept {
+        return vChunk.size() * sizeof(U) * N + vChunk.capacity() * sizeof(U *);
+    }
+};
+
+// Block index table (block hash -> CBlockIndex)
+// Open addressing with linear probing; a slot keeps the low 64 bits of the hash next to
+// the node pointer, so a lookup usually touches one cache line of the table and one node.
+// Keys and CBlockIndex objects live in slab arenas owned by the table: &it->first
+// (CBlockIndex::phashBlock) and the CBlockIndex pointers stay valid until clear().
+// Iterators are invalidated by insertions (the table may grow); there is no erase.
+//
+// Note: insert, reserve and clear need cs_main. find/count/get may also run without it
+// (RPC, wallet and UI paths did so with std::map): the slot array is published with an
+// atomic pointer, a slot's node pointer is stored last, and an array replaced by a
+// rehash is kept until clear(). A reader without cs_main may miss the newest block.
+template <typename T>
+class CBlockIndexMap_impl
+{
+    CBlockIndexMap_impl(const CBlockIndexMap_impl &)=delete;
+    CBlockIndexMap_impl &operator=(const CBlockIndexMap_impl &)=delete;
+public:
+    using key_type = T;
+    using mapped_type = CBlockIndex_impl<T> *;
+    using value_type = std::pair<const T, CBlockIndex_impl<T> *>;
+private:
+    struct slot {
+        uint64_t nKey;
+        std::atomic<value_type *> pvalue; // nullptr: empty
+    };
+    struct table {
+        std::unique_ptr<slot[]> pslot;
+        size_t nSlots;          // a power of two
+        unsigned int nShift;    // 64 - log2(nSlots)
+    };
+
+    template <typename V, typename S>
+    class iterator_base
+    {
+        friend class CBlockIndexMap_impl<T>;
+        S *pslot;
+        S *pend;
+        void skip() noexcept {
+            while (pslot != pend && pslot->pvalue.load(std::memory_order_acquire) == nullptr)
+                ++pslot;
+        }
+    public:
+        iterator_base() noexcept : pslot(nullptr), pend(nullptr) {}
+        iterator_base(S *pslotIn, S *pendIn) noexcept : pslot(pslotIn), pend(pendIn) {}
+        template <typename V2, typename S2>
+        iterator_base(const iterator_base<V2, S2> &obj) noexcept : pslot(obj.get_pslot()), pend(obj.get_pend()) {}
+
+        S *get_pslot() const noexcept {return pslot;}
+        S *get_pend() const noexcept {return pend;}
+
+        V &operator*() const noexcept {return *pslot->pvalue.load(std::memory_order_acquire);}
+        V *operator->() const noexcept {return pslot->pvalue.load(std::memory_order_acquire);}
+        iterator_base &operator++() noexcept {
+            ++pslot;
+            skip();
+            return *this;
+        }
+        iterator_base operator++(int) noexcept {
+            iterator_base ret = *this;
+            ++(*this);
+            return ret;
+        }
+        bool operator==(const iterator_base &obj) const noexcept {return pslot == obj.pslot;}
+        bool operator!=(const iterator_base &obj) const noexcept {return pslot != obj.pslot;}
+    };
+
+    std::atomic<table *> ptable;                // current slot array (nullptr: none yet)
+    std::vector<std::unique_ptr<table> > vTable; // all arrays since clear(); back() is current
+    std::atomic<size_t> nCount;
+    uint64_t nSalt;
+    CSlabArena<value_type> nodes;
+    CSlabArena<CBlockIndex_impl<T> > indexes;
+
+    static constexpr size_t MIN_SLOTS = 1024;
+
+    static uint64_t Truncate(const T &hash) noexcept {return hash.Get64(0);}
+    size_t Slot(const table &t, uint64_t nKey) const noexcept {
+        return (size_t)(((nKey ^ nSalt) * 0x9E3779B97F4A7C15ULL) >> t.nShift);
+    }
+    slot *Lookup(const table &t, const T &hash, uint64_t nKey) const noexcept { // nullptr if not found
+        const size_t nMask = t.nSlots - 1;
+        for (size_t i = Slot(t, nKey);; i = (i + 1) & nMask) {
+            slot &s = t.pslot[i];
+            const value_type *pvalue = s.pvalue.load(std::memory_order_acquire);
+            if (pvalue == nullptr)
+                return nullptr;
+            if (s.nKey == nKey && pvalue->first == hash)
+                return &s;
+        }
+    }
+    void Place(table &t, value_type *pvalue, uint64_t nKey) noexcept;
+    void Rehash(size_t nSlots);
+public:
+    using iterator = iterator_base<value_type, slot>;
+    using const_iterator = iterator_base<const value_type, const slot>;
+
+    CBlockIndexMap_impl() noexcept : ptable(nullptr), nCount(0), nSalt(0) {}
+    ~CBlockIndexMap_impl() {clear();}
+
+    iterator begin() noexcept {
+        table *t = ptable.load(std::memory_order_acquire);
+        if (t == nullptr)
+            return iterator();
+        iterator it(t->pslot.get(), t->pslot.get() + t->nSlots);
+        it.skip();
+        return it;
+    }
+    iterator end() noexcept {
+        table *t = ptable.load(std::memory_order_acquire);
+        return t ? iterator(t->pslot.get() + t->nSlots, t->pslot.get() + t->nSlots): iterator();
+    }
+    const_iterator begin() const noexcept {
+        const table *t = ptable.load(std::memory_order_acquire);
+        if (t == nullptr)
+            return const_iterator();
+        const_iterator it(t->pslot.get(), t->pslot.get() + t->nSlots);
+        it.skip();
+        return it;
+    }
+    const_iterator end() const noexcept {
+        const table *t = ptable.load(std::memory_order_acquire);
+        return t ? const_iterator(t->pslot.get() + t->nSlots, t->pslot.get() + t->nSlots): const_iterator();
+    }
+
+    size_t size() const noexcept {return nCount.load();}
+    bool empty() const noexcept {return nCount.load() == 0;}
+
+    iterator find(const T &hash) noexcept {
+        table *t = ptable.load(std::memory_order_acquire);
+        slot *s = t ? Lookup(*t, hash, Truncate(hash)): nullptr;
+        return s ? iterator(s, t->pslot.get() + t->nSlots): end();
+    }
+    const_iterator find(const T &hash) const noexcept {
+        const table *t = ptable.load(std::memory_order_acquire);
+        const slot *s = t ? Lookup(*t, hash, Truncate(hash)): nullptr;
+        return s ? const_iterator(s, t->pslot.get() + t->nSlots): end();
+    }
+    size_t count(const T &hash) const noexcept {
+        return (find(hash) != end()) ? 1 : 0;
+    }
+    // lookup only: nullptr if hash is not in the table (nothing is inserted)
+    CBlockIndex_impl<T> *get(const T &hash) const noexcept {
+        const const_iterator mi = find(hash);
+        return (mi != end()) ? mi->second : nullptr;
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<T, CBlockIndex_impl<T> *> &obj);
+
+    // CBlockIndex objects are allocated here; the table owns them.
+    template <typename... Args>
+    CBlockIndex_impl<T> *NewIndex(Args&&... args) {
+        return indexes.New(std::forward<Args>(args)...);
+    }
+
+    void reserve(size_t n);
+    void clear() noexcept;
+
+    size_t DynamicUsage() const noexcept;
+    size_t StdMapUsageEstimate() const noexcept; // the same entries in std::map + one new per CBlockIndex
+    std::string ToString() const;
+};
+
+using BlockMap = CBlockIndexMap_impl<uint256>;
+
+#endif // SORACHANCOIN_BLOCK_INDEX_MAP_H
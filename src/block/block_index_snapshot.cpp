@@ -0,0 +1,332 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <block/block_index_snapshot.h>
+#include <block/block.h>
+#include <txdb.h>
+#include <kernel.h>
+#include <crypto/sha256.h>
+#include <file_operate/iofs.h>
+#include <util/time.h>
+#include <util/logging.h>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+bool block_index_snapshot::fEnabled = false;
+bool block_index_snapshot::fJournal = false;
+bool block_index_snapshot::fIndexLoaded = false;
+
+namespace {
+
+// On-disk layout (little-endian, naturally aligned, no padding)
+struct snapshot_header {
+    char magic[8];
+    uint32_t nVersion;
+    uint32_t nRecordSize;
+    uint64_t nRecords;
+    unsigned char hashBestChain[32];
+    unsigned char hashRecords[32]; // SHA256 of all records
+    unsigned char reserved[8];
+};
+static_assert(sizeof(snapshot_header) == 96, "snapshot_header layout");
+
+struct snapshot_record {
+    unsigned char hash[32];
+    unsigned char hashMerkleRoot[32];
+    unsigned char hashProofOfStake[32];
+    unsigned char prevoutStakeHash[32];
+    unsigned char nChainTrust[32];
+    int64_t nMint;
+    int64_t nMoneySupply;
+    uint64_t nStakeModifier;
+    uint32_t nPrev; // record number, NO_RECORD: none
+    uint32_t nNext;
+    uint32_t nFile;
+    uint32_t nBlockPos;
+    int32_t nHeight;
+    uint32_t nFlags;
+    uint32_t prevoutStakeN;
+    uint32_t nStakeTime;
+    int32_t nVersion;
+    uint32_t nTime;
+    uint32_t nBits;
+    uint32_t nNonce;
+    uint32_t nStakeModifierChecksum;
+    uint32_t reserved;
+};
+static_assert(sizeof(snapshot_record) == 240, "snapshot_record layout");
+
+const char SNAPSHOT_MAGIC[8] = {'S', 'O', 'R', 'A', 'B', 'I', 'D', 'X'};
+constexpr uint32_t NO_RECORD = 0xFFFFFFFF;
+
+// Read-only view of the snapshot file: mmap, or a copy where mmap is not available
+class snapshot_file
+{
+    snapshot_file(const snapshot_file &)=delete;
+    snapshot_file &operator=(const snapshot_file &)=delete;
+private:
+    const char *pbase;
+    size_t nSize;
+    bool fMapped;
+    std::vector<char> vBuffer;
+public:
+    snapshot_file() noexcept : pbase(nullptr), nSize(0), fMapped(false) {}
+    ~snapshot_file() {
+#ifndef WIN32
+        if (fMapped)
+            ::munmap(const_cast<char *>(pbase), nSize);
+#endif
+    }
+
+    bool Open(const fs::path &path) {
+#ifndef WIN32
+        int fd = ::open(path.string().c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void *p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p != MAP_FAILED) {
+# ifdef MADV_SEQUENTIAL
+            ::madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+# endif
+            pbase = (const char *)p;
+            nSize = (size_t)st.st_size;
+            fMapped = true;
+            return true;
+        }
+#endif
+        FILE *file = ::fopen(path.string().c_str(), "rb");
+        if (! file)
+            return false;
+        char buf[65536];
+        size_t n;
+        while ((n = ::fread(buf, 1, sizeof(buf), file)) > 0)
+            vBuffer.insert(vBuffer.end(), buf, buf + n);
+        ::fclose(file);
+        pbase = vBuffer.data();
+        nSize = vBuffer.size();
+        return true;
+    }
+
+    const char *data() const noexcept {return pbase;}
+    size_t size() const noexcept {return nSize;}
+};
+
+uint256 HashRecords(const char *p, size_t nSize) {
+    uint256 hash;
+    latest_crypto::CSHA256().Write((const unsigned char *)p, nSize).Finalize(hash.begin());
+    return hash;
+}
+
+} // namespace
+
+fs::path block_index_snapshot::GetPath() {
+    return iofs::GetDataDir() / "blkindex.snap";
+}
+
+bool block_index_snapshot::Load(const std::pair<uint64_t, uint256> &marker,
+                                BlockMap &mapBlockIndex,
+                                std::set<std::pair<COutPoint_impl<uint256>, unsigned int> > &setStakeSeen,
+                                CBlockIndex_impl<uint256> *&pindexGenesisBlock,
+                                uint256 &hashSnapshotBest)
+{
+    assert(mapBlockIndex.empty());
+    snapshot_file file;
+    if (! file.Open(GetPath())) {
+        logging::LogPrintf("block_index_snapshot::Load() : %s not found\n", GetPath().string().c_str());
+        return false;
+    }
+
+    snapshot_header header;
+    if (file.size() < sizeof(header))
+        return logging::error("block_index_snapshot::Load() : truncated header");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.nVersion != SNAPSHOT_VERSION || header.nRecordSize != sizeof(snapshot_record))
+        return logging::error("block_index_snapshot::Load() : unknown format");
+    if (header.nRecords != marker.first || header.nRecords >= NO_RECORD || file.size() != sizeof(header) + header.nRecords * sizeof(snapshot_record))
+        return logging::error("block_index_snapshot::Load() : size mismatch");
+
+    const char *precords = file.data() + sizeof(header);
+    const size_t nRecordsSize = (size_t)header.nRecords * sizeof(snapshot_record);
+    const uint256 hashRecords = HashRecords(precords, nRecordsSize);
+    if (std::memcmp(header.hashRecords, hashRecords.begin(), 32) != 0 || hashRecords != marker.second)
+        return logging::error("block_index_snapshot::Load() : checksum mismatch");
+    std::memcpy(hashSnapshotBest.begin(), header.hashBestChain, 32);
+
+    const uint256 &hashGenesis = !args_bool::fTestNet ? block_params::hashGenesisBlock : block_params::hashGenesisBlockTestNet;
+    std::vector<CBlockIndex_impl<uint256> *> vIndex;
+    vIndex.reserve((size_t)header.nRecords);
+    mapBlockIndex.reserve((size_t)header.nRecords);
+    for (uint64_t i = 0; i < header.nRecords; ++i) {
+        snapshot_record rec;
+        std::memcpy(&rec, precords + i * sizeof(snapshot_record), sizeof(rec));
+        uint256 hash, hashMerkleRoot, hashProofOfStake, prevoutStakeHash, nChainTrust;
+        std::memcpy(hash.begin(), rec.hash, 32);
+        std::memcpy(hashMerkleRoot.begin(), rec.hashMerkleRoot, 32);
+        std::memcpy(hashProofOfStake.begin(), rec.hashProofOfStake, 32);
+        std::memcpy(prevoutStakeHash.begin(), rec.prevoutStakeHash, 32);
+        std::memcpy(nChainTrust.begin(), rec.nChainTrust, 32);
+
+        CBlockIndex_impl<uint256> *pindex = mapBlockIndex.NewIndex();
+        std::pair<BlockMap::iterator, bool> ret = mapBlockIndex.insert(std::make_pair(hash, pindex));
+        if (! ret.second) {
+            mapBlockIndex.clear();
+            return logging::error("block_index_snapshot::Load() : duplicate record %s", hash.ToString().c_str());
+        }
+        pindex->set_phashBlock(&ret.first->first);
+        pindex->set_nFile(rec.nFile);
+        pindex->set_nBlockPos(rec.nBlockPos);
+        pindex->set_nHeight(rec.nHeight);
+        pindex->set_nMint(rec.nMint);
+        pindex->set_nMoneySupply(rec.nMoneySupply);
+        pindex->set_nFlags(rec.nFlags);
+        pindex->set_nStakeModifier(rec.nStakeModifier);
+        pindex->set_prevoutStake(COutPoint_impl<uint256>(prevoutStakeHash, rec.prevoutStakeN));
+        pindex->set_nStakeTime(rec.nStakeTime);
+        pindex->set_hashProofOfStake(hashProofOfStake);
+        pindex->set_nVersion(rec.nVersion);
+        pindex->set_hashMerkleRoot(hashMerkleRoot);
+        pindex->set_nTime(rec.nTime);
+        pindex->set_nBits(rec.nBits);
+        pindex->set_nNonce(rec.nNonce);
+        pindex->set_nChainTrust(nChainTrust);
+        pindex->set_nStakeModifierChecksum(rec.nStakeModifierChecksum);
+        vIndex.push_back(pindex);
+    }
+
+    for (uint64_t i = 0; i < header.nRecords; ++i) {
+        snapshot_record rec;
+        std::memcpy(&rec, precords + i * sizeof(snapshot_record), sizeof(rec));
+        if ((rec.nPrev != NO_RECORD && rec.nPrev >= header.nRecords) || (rec.nNext != NO_RECORD && rec.nNext >= header.nRecords)) {
+            mapBlockIndex.clear();
+            return logging::error("block_index_snapshot::Load() : bad link in record %" PRIu64, i);
+        }
+
+        CBlockIndex_impl<uint256> *pindex = vIndex[i];
+        pindex->set_pprev(rec.nPrev != NO_RECORD ? vIndex[rec.nPrev] : nullptr);
+        pindex->set_pnext(rec.nNext != NO_RECORD ? vIndex[rec.nNext] : nullptr);
+        pindex->set_hashPrevBlock(pindex->get_pprev() ? pindex->get_pprev()->GetBlockHash() : uint256(0));
+
+        if (pindexGenesisBlock == nullptr && pindex->GetBlockHash() == hashGenesis)
+            pindexGenesisBlock = pindex;
+        if (! bitkernel<uint256>::CheckStakeModifierCheckpoints(pindex->get_nHeight(), pindex->get_nStakeModifierChecksum())) {
+            mapBlockIndex.clear();
+            pindexGenesisBlock = nullptr;
+            return logging::error("block_index_snapshot::Load() : failed stake modifier checkpoint height=%d", pindex->get_nHeight());
+        }
+
+        // ppcoin: build setStakeSeen
+        if (pindex->IsProofOfStake())
+            setStakeSeen.insert(std::make_pair(pindex->get_prevoutStake(), pindex->get_nStakeTime()));
+    }
+
+    logging::LogPrintf("block_index_snapshot::Load() : %" PRIu64 " records, best %s\n", header.nRecords, hashSnapshotBest.ToString().substr(0, 20).c_str());
+    return true;
+}
+
+bool block_index_snapshot::Write(CTxDB_impl<uint256> &txdb, const BlockMap &mapBlockIndex, const uint256 &hashBestChain)
+{
+    if (! fIndexLoaded || mapBlockIndex.empty())
+        return false;
+    const int64_t nStart = util::GetTimeMillis();
+
+    std::vector<const CBlockIndex_impl<uint256> *> vIndex;
+    std::unordered_map<const CBlockIndex_impl<uint256> *, uint32_t> mapRecord;
+    vIndex.reserve(mapBlockIndex.size());
+    mapRecord.reserve(mapBlockIndex.size());
+    for (const BlockMap::value_type &item: mapBlockIndex) {
+        if (item.second == nullptr)
+            continue;
+        mapRecord.insert(std::make_pair(item.second, (uint32_t)vIndex.size()));
+        vIndex.push_back(item.second);
+    }
+
+    const fs::path pathTmp = GetPath().string() + ".new";
+    FILE *file = ::fopen(pathTmp.string().c_str(), "wb");
+    if (! file)
+        return logging::error("block_index_snapshot::Write() : open %s failed", pathTmp.string().c_str());
+
+    snapshot_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.nVersion = SNAPSHOT_VERSION;
+    header.nRecordSize = sizeof(snapshot_record);
+    header.nRecords = vIndex.size();
+    std::memcpy(header.hashBestChain, hashBestChain.begin(), 32);
+
+    bool fOk = (::fwrite(&header, sizeof(header), 1, file) == 1);
+    latest_crypto::CSHA256 hasher;
+    for (size_t i = 0; fOk && i < vIndex.size(); ++i) {
+        const CBlockIndex_impl<uint256> *pindex = vIndex[i];
+        snapshot_record rec;
+        std::memset(&rec, 0, sizeof(rec));
+        const uint256 hash = pindex->GetBlockHash();
+        const uint256 hashMerkleRoot = pindex->get_hashMerkleRoot();
+        const uint256 hashProofOfStake = pindex->get_hashProofOfStake();
+        const COutPoint_impl<uint256> prevoutStake = pindex->get_prevoutStake();
+        const uint256 nChainTrust = pindex->get_nChainTrust();
+        std::memcpy(rec.hash, hash.begin(), 32);
+        std::memcpy(rec.hashMerkleRoot, hashMerkleRoot.begin(), 32);
+        std::memcpy(rec.hashProofOfStake, hashProofOfStake.begin(), 32);
+        std::memcpy(rec.prevoutStakeHash, prevoutStake.get_hash().begin(), 32);
+        std::memcpy(rec.nChainTrust, nChainTrust.begin(), 32);
+        rec.nMint = pindex->get_nMint();
+        rec.nMoneySupply = pindex->get_nMoneySupply();
+        rec.nStakeModifier = pindex->get_nStakeModifier();
+        rec.nPrev = pindex->get_pprev() ? mapRecord[pindex->get_pprev()] : NO_RECORD;
+        rec.nNext = pindex->get_pnext() ? mapRecord[pindex->get_pnext()] : NO_RECORD;
+        rec.nFile = pindex->get_nFile();
+        rec.nBlockPos = pindex->get_nBlockPos();
+        rec.nHeight = pindex->get_nHeight();
+        rec.nFlags = pindex->get_nFlags();
+        rec.prevoutStakeN = prevoutStake.get_n();
+        rec.nStakeTime = pindex->get_nStakeTime();
+        rec.nVersion = pindex->get_nVersion();
+        rec.nTime = pindex->get_nTime();
+        rec.nBits = pindex->get_nBits();
+        rec.nNonce = pindex->get_nNonce();
+        rec.nStakeModifierChecksum = pindex->get_nStakeModifierChecksum();
+        hasher.Write((const unsigned char *)&rec, sizeof(rec));
+        fOk = (::fwrite(&rec, sizeof(rec), 1, file) == 1);
+    }
+
+    uint256 hashRecords;
+    hasher.Finalize(hashRecords.begin());
+    std::memcpy(header.hashRecords, hashRecords.begin(), 32);
+    fOk = fOk && ::fseek(file, 0, SEEK_SET) == 0 && ::fwrite(&header, sizeof(header), 1, file) == 1 && ::fflush(file) == 0;
+    if (fOk)
+        iofs::FileCommit(file);
+    ::fclose(file);
+    if (! fOk || !iofs::RenameOver(pathTmp, GetPath())) {
+        fs::remove(pathTmp);
+        return logging::error("block_index_snapshot::Write() : write %s failed", GetPath().string().c_str());
+    }
+
+    // bind the file to the database; the journal starts over
+    if (! txdb.TxnBegin())
+        return false;
+    if (! txdb.EraseBlockIndexJournal() || !txdb.WriteBlockIndexSnapshot(std::make_pair((uint64_t)vIndex.size(), hashRecords))) {
+        txdb.TxnAbort();
+        return logging::error("block_index_snapshot::Write() : marker not written");
+    }
+    if (! txdb.TxnCommit())
+        return false;
+    fJournal = true;
+
+    logging::LogPrintf("block_index_snapshot::Write() : %" PRIszu " records in %" PRId64 "ms\n", vIndex.size(), util::GetTimeMillis() - nStart);
+    return true;
+}
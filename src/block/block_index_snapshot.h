@@ -0,0 +1,58 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_BLOCK_INDEX_SNAPSHOT_H
+#define SORACHANCOIN_BLOCK_INDEX_SNAPSHOT_H
+
+#include <set>
+#include <vector>
+#include <uint256.h>
+#include <file_operate/fs.h>
+#include <const/no_instance.h>
+#include <block/block_index_map.h>
+
+template <typename T> class COutPoint_impl;
+template <typename HASH> class CTxDB_impl;
+
+// Block index snapshot (-indexsnapshot)
+// On shutdown the in-memory block index is written to blkindex.snap: a header and one
+// fixed-size record per mapBlockIndex entry, with pprev/pnext stored as record numbers
+// and nChainTrust / nStakeModifierChecksum included, so loading is a single pass over
+// a read-only mapping without scrypt, sorting or the chain trust pass.
+//
+// The tx index database keeps a marker (record count and SHA256 of the records) that
+// binds the file to this database. While a marker exists, every WriteBlockIndex also
+// adds its hash to a journal ("blockindexdirty"); on start the journaled entries are
+// read from LevelDB and replayed on top of the snapshot. Writing a new snapshot clears
+// the journal in the same batch as the new marker.
+class block_index_snapshot : private no_instance
+{
+private:
+    static bool fEnabled;
+    static bool fJournal;       // a marker exists: WriteBlockIndex journals
+    static bool fIndexLoaded;   // mapBlockIndex is complete (not interrupted by shutdown)
+public:
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    static void SetEnabled(bool fEnable) {fEnabled = fEnable;}
+    static bool IsEnabled() {return fEnabled;}
+    static void SetJournal(bool fJournalIn) {fJournal = fJournalIn;}
+    static bool IsJournal() {return fJournal;}
+    static void SetIndexLoaded() {fIndexLoaded = true;}
+
+    static fs::path GetPath();
+
+    // Load the snapshot into an empty mapBlockIndex. false: no usable snapshot
+    // (missing, damaged or not matching the marker); mapBlockIndex is left empty.
+    static bool Load(const std::pair<uint64_t, uint256> &marker,
+                     BlockMap &mapBlockIndex,
+                     std::set<std::pair<COutPoint_impl<uint256>, unsigned int> > &setStakeSeen,
+                     CBlockIndex_impl<uint256> *&pindexGenesisBlock,
+                     uint256 &hashSnapshotBest);
+
+    // Write mapBlockIndex and bind it to txdb (shutdown, cs_main held)
+    static bool Write(CTxDB_impl<uint256> &txdb, const BlockMap &mapBlockIndex, const uint256 &hashBestChain);
+};
+
+#endif // SORACHANCOIN_BLOCK_INDEX_SNAPSHOT_H
@@ -6,9 +6,10 @@
 
 #include <block/block_info.h>
 #include <block/transaction.h>
+#include <block/block.h>
 
 CScript block_info::COINBASE_FLAGS;
-std::map<uint256, CBlockIndex_impl<uint256> *> block_info::mapBlockIndex;
+CBlockIndexMap_impl<uint256> block_info::mapBlockIndex;
 std::set<std::pair<COutPoint_impl<uint256>, unsigned int> > block_info::setStakeSeen;
 CBlockIndex_impl<uint256> *block_info::pindexGenesisBlock = nullptr;
 int64_t block_info::nTimeBestReceived = 0;
@@ -11,6 +11,7 @@
 #include <set>
 #include <uint256.h>
 #include <version.h>
+#include <block/block_index_map.h>
 
 template <typename T> class CBlockIndex_impl;
 template <typename T> class COutPoint_impl;
@@ -22,7 +23,7 @@ namespace block_info
 {
     extern CScript COINBASE_FLAGS;
 
-    extern std::map<uint256, CBlockIndex_impl<uint256> *> mapBlockIndex;
+    extern CBlockIndexMap_impl<uint256> mapBlockIndex;
     extern std::set<std::pair<COutPoint_impl<uint256>, unsigned int>> setStakeSeen;
     extern CBlockIndex_impl<uint256> *pindexGenesisBlock;// = nullptr;
 
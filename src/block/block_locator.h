@@ -36,7 +36,7 @@ public:
         Set(pindex);
     }
     explicit CBlockLocator_impl(uint256 hashBlock) {
-        std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(hashBlock);
+        BlockMap::iterator mi = block_info::mapBlockIndex.find(hashBlock);
         if (mi != block_info::mapBlockIndex.end()) {
             Set((*mi).second);
         }
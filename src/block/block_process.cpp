@@ -252,7 +252,7 @@ bool block_process::manage::ProcessMessage(CNode *pfrom, std::string strCommand,
                 // In case we are on a very long side-chain, it is possible that we already have
                 // the last block in an inv bundle sent in response to getblocks. Try to detect
                 // this situation and push another getblocks to continue.
-                pfrom->PushGetBlocks(block_info::mapBlockIndex[inv.get_hash()], uint256(0));
+                pfrom->PushGetBlocks(block_info::mapBlockIndex.get(inv.get_hash()), uint256(0));
                 if (args_bool::fDebug) logging::LogPrintf("force request: %s\n", inv.ToString().c_str());
             }
 
@@ -276,7 +276,7 @@ bool block_process::manage::ProcessMessage(CNode *pfrom, std::string strCommand,
                 logging::LogPrintf("received getdata for: %s\n", inv.ToString().c_str());
             if (inv.get_type() == _CINV_MSG_TYPE::MSG_BLOCK) {
                 // Send block from disk
-                std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(inv.get_hash());
+                BlockMap::iterator mi = block_info::mapBlockIndex.find(inv.get_hash());
                 if (mi != block_info::mapBlockIndex.end()) {
                     CBlock block;
                     block.ReadFromDisk((*mi).second);
@@ -371,7 +371,7 @@ bool block_process::manage::ProcessMessage(CNode *pfrom, std::string strCommand,
         CBlockIndex *pindex = nullptr;
         if (locator.IsNull()) {
             // If locator is null, return the hashStop block
-            std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(hashStop);
+            BlockMap::iterator mi = block_info::mapBlockIndex.find(hashStop);
             if (mi == block_info::mapBlockIndex.end())
                 return true;
             pindex = (*mi).second;
@@ -928,11 +928,12 @@ void block_process::manage::ResendWalletTransactions(bool fForceResend /*= false
 
 bool block_process::manage::ProcessBlock(CNode *pfrom, CBlock *pblock)
 {
+    const uint64_t nHashEvaluationsStart = CBlockHeader_impl<uint256>::GetHashEvaluations();
     uint256 hash = pblock->GetHash();
 
     // Check for duplicate
     if (block_info::mapBlockIndex.count(hash))
-        return logging::error("block_process::manage::ProcessBlock() : already have block %d %s", block_info::mapBlockIndex[hash]->get_nHeight(), hash.ToString().substr(0,20).c_str());
+        return logging::error("block_process::manage::ProcessBlock() : already have block %d %s", block_info::mapBlockIndex.get(hash)->get_nHeight(), hash.ToString().substr(0,20).c_str());
     if (block_process::mapOrphanBlocks.count(hash))
         return logging::error("block_process::manage::ProcessBlock() : already have block (orphan) %s", hash.ToString().substr(0,20).c_str());
     // Check that block isn't listed as unconditionally banned.
@@ -1048,6 +1049,8 @@ bool block_process::manage::ProcessBlock(CNode *pfrom, CBlock *pblock)
     }
 
     logging::LogPrintf("block_process::manage::ProcessBlock: ACCEPTED\n");
+    if (args_bool::fDebug)
+        logging::LogPrintf("block_process::manage::ProcessBlock: scrypt header hashes=%" PRIu64 "\n", CBlockHeader_impl<uint256>::GetHashEvaluations() - nHashEvaluationsStart);
 
     // ppcoin: if responsible for sync-checkpoint send it
     if (pfrom && !CSyncCheckpoint::Get_strMasterPrivKey().empty())
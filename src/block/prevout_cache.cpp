@@ -0,0 +1,164 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <block/prevout_cache.h>
+
+template <typename T> CPrevoutCache_impl<T> CPrevoutCache_impl<T>::cache;
+
+template <typename T>
+CPrevoutCache_impl<T>::CPrevoutCache_impl() :
+    nMaxUsage((size_t)DEFAULT_CACHE_SIZE << 20), nUsage(0), nHits(0), nMisses(0), nEvictions(0) {}
+
+// rough heap footprint: map node, lru node, vSpent and the serialized tx
+template <typename T>
+size_t CPrevoutCache_impl<T>::DynamicUsage(const entry &e) {
+    size_t nSize = sizeof(entry) + 2 * sizeof(T) + 8 * sizeof(void *);
+    nSize += e.txindex.get_vSpent().capacity() * sizeof(CDiskTxPos);
+    if (! e.posTx.IsNull())
+        nSize += 2 * ::GetSerializeSize(e.tx);
+    return nSize;
+}
+
+// Note: cs must be held
+template <typename T>
+typename CPrevoutCache_impl<T>::entry &CPrevoutCache_impl<T>::Touch(const T &hash) {
+    typename std::map<T, entry>::iterator mi = mapEntry.find(hash);
+    if (mi == mapEntry.end()) {
+        mi = mapEntry.insert(std::make_pair(hash, entry())).first;
+        entry &e = mi->second;
+        e.fHaveIndex = false;
+        e.nUsage = 0;
+        lru.push_front(hash);
+        e.itLru = lru.begin();
+    } else
+        lru.splice(lru.begin(), lru, mi->second.itLru);
+    return mi->second;
+}
+
+// Note: cs must be held
+template <typename T>
+void CPrevoutCache_impl<T>::Update(entry &e) {
+    nUsage -= e.nUsage;
+    e.nUsage = DynamicUsage(e);
+    nUsage += e.nUsage;
+}
+
+// Note: cs must be held
+template <typename T>
+void CPrevoutCache_impl<T>::Remove(typename std::map<T, entry>::iterator mi) {
+    nUsage -= mi->second.nUsage;
+    lru.erase(mi->second.itLru);
+    mapEntry.erase(mi);
+}
+
+// Note: cs must be held
+template <typename T>
+void CPrevoutCache_impl<T>::Trim() {
+    while (nUsage > nMaxUsage && !lru.empty()) {
+        typename std::map<T, entry>::iterator mi = mapEntry.find(lru.back());
+        assert(mi != mapEntry.end());
+        Remove(mi);
+        ++nEvictions;
+    }
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::SetMaxSize(int nMiB) {
+    LOCK(cs);
+    nMaxUsage = (size_t)std::max(nMiB, 0) << 20;
+    Trim();
+}
+
+template <typename T>
+bool CPrevoutCache_impl<T>::GetTxIndex(const T &hash, CTxIndex &txindex) {
+    LOCK(cs);
+    typename std::map<T, entry>::iterator mi = mapEntry.find(hash);
+    if (mi == mapEntry.end() || !mi->second.fHaveIndex) {
+        ++nMisses;
+        return false;
+    }
+    ++nHits;
+    lru.splice(lru.begin(), lru, mi->second.itLru);
+    txindex = mi->second.txindex;
+    return true;
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::SetTxIndex(const T &hash, const CTxIndex &txindex) {
+    if (txindex.IsNull()) {
+        Erase(hash);
+        return;
+    }
+
+    LOCK(cs);
+    if (nMaxUsage == 0)
+        return;
+    entry &e = Touch(hash);
+    if (e.fHaveIndex && e.txindex.get_pos() != txindex.get_pos())
+        e.posTx.SetNull(); // a duplicate txid now lives elsewhere; drop the stale body
+    e.txindex = txindex;
+    e.fHaveIndex = true;
+    Update(e);
+    Trim();
+}
+
+template <typename T>
+bool CPrevoutCache_impl<T>::GetTx(const T &hash, const CDiskTxPos &pos, CTransaction_impl<T> &tx) {
+    LOCK(cs);
+    typename std::map<T, entry>::iterator mi = mapEntry.find(hash);
+    if (mi == mapEntry.end() || mi->second.posTx.IsNull() || mi->second.posTx != pos) {
+        ++nMisses;
+        return false;
+    }
+    ++nHits;
+    lru.splice(lru.begin(), lru, mi->second.itLru);
+    tx = mi->second.tx;
+    return true;
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::SetTx(const T &hash, const CDiskTxPos &pos, const CTransaction_impl<T> &tx) {
+    if (pos.IsNull() || pos == CDiskTxPos(1,1,1)) // memory pool indicator, never on disk
+        return;
+
+    LOCK(cs);
+    if (nMaxUsage == 0)
+        return;
+    entry &e = Touch(hash);
+    e.tx = tx;
+    e.posTx = pos;
+    Update(e);
+    Trim();
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::Erase(const T &hash) {
+    LOCK(cs);
+    typename std::map<T, entry>::iterator mi = mapEntry.find(hash);
+    if (mi != mapEntry.end())
+        Remove(mi);
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::Apply(const std::map<T, CTxIndex> &mapChanges) {
+    for (typename std::map<T, CTxIndex>::const_iterator mi = mapChanges.begin(); mi != mapChanges.end(); ++mi)
+        SetTxIndex(mi->first, mi->second);
+}
+
+template <typename T>
+void CPrevoutCache_impl<T>::Clear() {
+    LOCK(cs);
+    mapEntry.clear();
+    lru.clear();
+    nUsage = 0;
+}
+
+template <typename T>
+std::string CPrevoutCache_impl<T>::ToString() const {
+    LOCK(cs);
+    return tfm::format("CPrevoutCache(entries=%" PRIszu ", usage=%.1fMiB/%.1fMiB, hits=%" PRIu64 ", misses=%" PRIu64 ", evictions=%" PRIu64 ")",
+        mapEntry.size(), nUsage / 1048576.0, nMaxUsage / 1048576.0, nHits, nMisses, nEvictions);
+}
+
+template class CPrevoutCache_impl<uint256>;
@@ -0,0 +1,81 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_PREVOUT_CACHE_H
+#define SORACHANCOIN_PREVOUT_CACHE_H
+
+#include <list>
+#include <map>
+#include <block/transaction.h>
+
+// Prevout cache
+// Bounded, in-memory cache in front of CTxDB that holds the committed output
+// state of transactions (CTxIndex: position and vSpent of every output) and
+// the previous transactions read by FetchInputs. It is keyed by the hash part
+// of COutPoint, because CTxIndex records the spent state of all outputs of a
+// transaction together.
+//
+// Uncommitted changes are never stored here. CTxDB keeps them in its own
+// write-back overlay during TxnBegin ... TxnCommit, writes them to LevelDB in
+// one batch at the SetBestChain commit point and then hands them over with
+// Apply(). An aborted transaction therefore leaves the cache untouched.
+// Singleton Class
+template <typename T>
+class CPrevoutCache_impl
+{
+private:
+    CPrevoutCache_impl();
+    CPrevoutCache_impl(const CPrevoutCache_impl &)=delete;
+    CPrevoutCache_impl(CPrevoutCache_impl &&)=delete;
+    CPrevoutCache_impl &operator=(const CPrevoutCache_impl &)=delete;
+    CPrevoutCache_impl &operator=(CPrevoutCache_impl &&)=delete;
+
+    struct entry {
+        CTxIndex txindex;
+        bool fHaveIndex;
+        CTransaction_impl<T> tx;
+        CDiskTxPos posTx; // position the cached tx was read from (null: tx not cached)
+        size_t nUsage;
+        typename std::list<T>::iterator itLru;
+    };
+
+    mutable CCriticalSection cs;
+    std::map<T, entry> mapEntry;
+    std::list<T> lru; // front: most recently used
+    size_t nMaxUsage;
+    size_t nUsage;
+    uint64_t nHits;
+    uint64_t nMisses;
+    uint64_t nEvictions;
+
+    static size_t DynamicUsage(const entry &e);
+    entry &Touch(const T &hash);
+    void Update(entry &e);
+    void Remove(typename std::map<T, entry>::iterator mi);
+    void Trim();
+public:
+    static constexpr int DEFAULT_CACHE_SIZE = 64; // MiB
+    static CPrevoutCache_impl cache;
+
+    void SetMaxSize(int nMiB);
+
+    bool GetTxIndex(const T &hash, CTxIndex &txindex);
+    void SetTxIndex(const T &hash, const CTxIndex &txindex);
+    bool GetTx(const T &hash, const CDiskTxPos &pos, CTransaction_impl<T> &tx);
+    void SetTx(const T &hash, const CDiskTxPos &pos, const CTransaction_impl<T> &tx);
+    void Erase(const T &hash);
+
+    // committed changes from CTxDB (null CTxIndex: erased)
+    void Apply(const std::map<T, CTxIndex> &mapChanges);
+    void Clear();
+
+    size_t GetUsage() const {
+        LOCK(cs);
+        return nUsage;
+    }
+    std::string ToString() const;
+};
+using CPrevoutCache = CPrevoutCache_impl<uint256>;
+
+#endif // SORACHANCOIN_PREVOUT_CACHE_H
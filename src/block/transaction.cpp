@@ -8,6 +8,10 @@
 #include <block/block_process.h>
 #include <miner/diff.h>
 #include <block/block_check.h>
+#include <block/prevout_cache.h>
+#include <script/sighash.h>
+#include <script/sigcache.h>
+#include <file_operate/block_mmap.h>
 #include <checkpoints.h>
 #include <txdb.h>
 #include <wallet.h>
@@ -253,6 +257,18 @@ bool CTxMemPool_impl<T>::accept(CTxDB &txdb, CTransaction_impl<T> &tx, bool fChe
         // This is done last to help prevent CPU exhaustion denial-of-service attacks.
         if (! tx.ConnectInputs(txdb, mapInputs, mapUnused, CDiskTxPos(1,1,1), block_info::pindexBest, false, false, true, Script_param::STRICT_FLAGS))
             return logging::error("CTxMemPool::accept() : ConnectInputs failed %s", hash.ToString().substr(0,10).c_str());
+
+        // Remember the scripts as valid under the flags ConnectBlock will use.
+        // Flags beyond STRICT_FLAGS are checked here; the signature cache makes that cheap.
+        const unsigned int nBlockFlags = block_check::manage<T>::GetBlockScriptFlags(tx);
+        if (nBlockFlags & ~(Script_param::STRICT_FLAGS | Script_param::SCRIPT_VERIFY_NOCACHE)) {
+            for (unsigned int i = 0; i < tx.get_vin().size(); ++i) {
+                const CTransaction_impl<T> &txPrev = mapInputs[tx.get_vin(i).get_prevout().get_hash()].second;
+                if (! block_check::manage<T>::VerifySignature(txPrev, tx, i, nBlockFlags, 0))
+                    return logging::error("CTxMemPool::accept() : block script flags failed %s", hash.ToString().substr(0,10).c_str());
+            }
+        }
+        CScriptExecutionCache::cache.Set(hash, nBlockFlags);
     }
 
     // Store transaction in memory
@@ -439,12 +455,12 @@ bool CTransaction_impl<T>::AreInputsStandard(const MapPrevTx &mapInputs) const
         // be quick, because if there are any operations
         // beside "push data" in the scriptSig the
         // IsStandard() call returns false
-        Script_util::statype stack;
+        Script_util::evalstack stack;
         if (! Script_util::EvalScript(stack, vin[i].get_scriptSig(), *this, i, false, 0))
             return false;
         if (whichType == TxnOutputType::TX_SCRIPTHASH) {
             if (stack.empty()) return false;
-            CScript subscript(stack.back().begin(), stack.back().end());
+            CScript subscript(stack.back().data(), stack.back().data() + stack.back().size());
             Script_util::statype vSolutions2;
             TxnOutputType::txnouttype whichType2;
             if (! Script_util::Solver(subscript, whichType2, vSolutions2)) return false;
@@ -563,6 +579,21 @@ int64_t CTransaction_impl<T>::GetMinFee(unsigned int nBlockSize/*=1*/, bool fAll
 
 template <typename T>
 bool CTransaction_impl<T>::ReadFromDisk(CDiskTxPos pos, FILE **pfileRet/*=nullptr*/) {
+    if (! pfileRet) {
+        std::shared_ptr<const CBlockFileMapping> pmap = block_mmap::Get(pos.get_nFile(), pos.get_nTxPos());
+        if (pmap) {
+            // Read transaction straight from the mapped history file
+            // (the reader stops at the end of the file; anything it cannot read is read again through stdio)
+            try {
+                CSpanReader reader(pmap, pos.get_nTxPos(), SER_DISK, version::CLIENT_VERSION);
+                reader >> *this;
+                return true;
+            } catch (const std::exception &) {
+                SetNull();
+            }
+        }
+    }
+
     CAutoFile filein = CAutoFile(file_open::OpenBlockFile(pos.get_nFile(), 0, pfileRet ? "rb+" : "rb"), SER_DISK, version::CLIENT_VERSION);
     if (! filein) return logging::error("CTransaction_impl<T>::ReadFromDisk() : file_open::OpenBlockFile failed");
 
@@ -644,7 +675,7 @@ bool CTransaction_impl<T>::DisconnectInputs(CTxDB &txdb)
 }
 
 template <typename T>
-bool CTransaction_impl<T>::FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex> &mapTestPool, bool fBlock, bool fMiner, MapPrevTx &inputsRet, bool &fInvalid)
+bool CTransaction_impl<T>::FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex> &mapTestPool, bool fBlock, bool fMiner, MapPrevTx &inputsRet, bool &fInvalid, const MapPrevTx *pmapPrefetched/*=nullptr*/)
 {
     // FetchInputs can return false either because we just haven't seen some inputs
     // (in which case the transaction should be stored as an orphan)
@@ -662,9 +693,14 @@ bool CTransaction_impl<T>::FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex>
         // Read txindex
         CTxIndex &txindex = inputsRet[prevout.get_hash()].first;
         bool fFound = true;
+        const typename MapPrevTx::mapped_type *pPrefetched = nullptr;
         if ((fBlock || fMiner) && mapTestPool.count(prevout.get_hash())) {
             // Get txindex from current proposed changes
             txindex = mapTestPool.find(prevout.get_hash())->second;
+        } else if (pmapPrefetched && pmapPrefetched->count(prevout.get_hash())) {
+            // Get txindex read ahead by ConnectBlock (still valid: only mapTestPool changes it meanwhile)
+            pPrefetched = &pmapPrefetched->find(prevout.get_hash())->second;
+            txindex = pPrefetched->first;
         } else {
             // Read txindex from txdb
             fFound = txdb.ReadTxIndex(prevout.get_hash(), txindex);
@@ -685,9 +721,14 @@ bool CTransaction_impl<T>::FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex>
             if (! fFound)
                 txindex.set_vSpent().resize(txPrev.vout.size());
         } else {
-            // Get prev tx from disk
-            if (! txPrev.ReadFromDisk(txindex.get_pos()))
-                return logging::error("FetchInputs() : %s ReadFromDisk prev tx %s failed", GetHash().ToString().substr(0,10).c_str(),  prevout.get_hash().ToString().substr(0,10).c_str());
+            // Get prev tx from the prefetch stage, the prevout cache, or from disk
+            if (pPrefetched && !pPrefetched->second.IsNull())
+                txPrev = pPrefetched->second;
+            else if (! CPrevoutCache_impl<T>::cache.GetTx(prevout.get_hash(), txindex.get_pos(), txPrev)) {
+                if (! txPrev.ReadFromDisk(txindex.get_pos()))
+                    return logging::error("FetchInputs() : %s ReadFromDisk prev tx %s failed", GetHash().ToString().substr(0,10).c_str(),  prevout.get_hash().ToString().substr(0,10).c_str());
+                CPrevoutCache_impl<T>::cache.SetTx(prevout.get_hash(), txindex.get_pos(), txPrev);
+            }
         }
     }
 
@@ -746,6 +787,15 @@ bool CTransaction_impl<T>::ConnectInputs(CTxDB &txdb, MapPrevTx inputs, std::map
         if (pvChecks)
             pvChecks->reserve(vin.size());
 
+        // Scripts already verified with these flags when the transaction entered the memory pool
+        if (fScriptChecks && CScriptExecutionCache::cache.Get(GetHash(), flags))
+            fScriptChecks = false;
+
+        // The signature hashes of all inputs share most of their serialization
+        std::shared_ptr<const CSignatureHashData> psighash;
+        if (fScriptChecks && vin.size() >= CSignatureHashData::MIN_INPUTS)
+            psighash = std::make_shared<const CSignatureHashData>(*this);
+
         // The first loop above does all the inexpensive checks.
         // Only if ALL inputs pass do we perform expensive ECDSA signature checks.
         // Helps prevent CPU exhaustion attacks.
@@ -766,7 +816,7 @@ bool CTransaction_impl<T>::ConnectInputs(CTxDB &txdb, MapPrevTx inputs, std::map
             // still computed and checked, and any change will be caught at the next checkpoint.
             if (fScriptChecks) {
                 // Verify signature
-                CScriptCheck check(txPrev, *this, i, flags, 0);
+                CScriptCheck check(txPrev, *this, i, flags, 0, psighash);
                 if (pvChecks) {
                     pvChecks->push_back(CScriptCheck());
                     check.swap(pvChecks->back());
@@ -977,11 +1027,22 @@ const CTxOut_impl<T> &CTransaction_impl<T>::GetOutputFor(const CTxIn_impl<T> &in
 bool CScriptCheck::operator()() const
 {
     const CScript &scriptSig = ptxTo->get_vin(nIn).get_scriptSig();
-    if (! Script_util::VerifyScript(scriptSig, scriptPubKey, *ptxTo, nIn, nFlags, nHashType))
+    if (! Script_util::VerifyScript(scriptSig, scriptPubKey, *ptxTo, nIn, nFlags, nHashType, psighash.get()))
         return logging::error("CScriptCheck() functor : %s block_check::manage::VerifySignature failed", ptxTo->GetHash().ToString().substr(0,10).c_str());
     return true;
 }
 
+bool CPrevoutFetch::operator()()
+{
+    // never fails the queue: a missing prev tx is reported by FetchInputs in block order
+    if (! ptxPrev->ReadFromDisk(pos)) {
+        ptxPrev->SetNull();
+        return true;
+    }
+    CPrevoutCache::cache.SetTx(hash, pos, *ptxPrev);
+    return true;
+}
+
 // witness(Segwit) programs
 template <typename T>
 T CTransaction_impl<T>::ComputeHash() const
@@ -11,6 +11,7 @@
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 
 #include <const/block_params.h>
 #include <block/block_info.h>
@@ -33,6 +34,7 @@ template <typename T> class CTxDB_impl;
 using CTxDB = CTxDB_impl<uint256>;
 
 class CScriptCheck;
+class CSignatureHashData;
 template <typename T> class COutPoint_impl;
 using COutPoint = COutPoint_impl<uint256>;
 
@@ -808,9 +810,10 @@ public:
      @param[in] fMiner    True if being called by miner::CreateNewBlock
      @param[out] inputsRet    Pointers to this transaction's inputs
      @param[out] fInvalid    returns true if transaction is invalid
+     @param[in] pmapPrefetched    Committed inputs read ahead by ConnectBlock (nullptr: none)
      @return    Returns true if all inputs are in txdb or mapTestPool
      */
-    bool FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex> &mapTestPool, bool fBlock, bool fMiner, MapPrevTx &inputsRet, bool &fInvalid);
+    bool FetchInputs(CTxDB &txdb, const std::map<T, CTxIndex> &mapTestPool, bool fBlock, bool fMiner, MapPrevTx &inputsRet, bool &fInvalid, const MapPrevTx *pmapPrefetched = nullptr);
 
     /** Sanity check previous transactions, then, if all checks succeed,
         mark them as spent by this transaction.
@@ -933,11 +936,12 @@ private:
     unsigned int nIn;
     unsigned int nFlags;
     int nHashType;
+    std::shared_ptr<const CSignatureHashData> psighash; // shared by the checks of one transaction
 
 public:
     CScriptCheck() {}
-    CScriptCheck(const CTransaction& txFromIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, int nHashTypeIn) :
-    scriptPubKey(txFromIn.get_vout(txToIn.get_vin(nInIn).get_prevout().get_n()).get_scriptPubKey()), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), nHashType(nHashTypeIn) {}
+    CScriptCheck(const CTransaction& txFromIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, int nHashTypeIn, const std::shared_ptr<const CSignatureHashData> &psighashIn=nullptr) :
+    scriptPubKey(txFromIn.get_vout(txToIn.get_vin(nInIn).get_prevout().get_n()).get_scriptPubKey()), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), nHashType(nHashTypeIn), psighash(psighashIn) {}
 
     bool operator()() const;
     void swap(CScriptCheck &check) {
@@ -946,6 +950,29 @@ public:
         std::swap(nIn, check.nIn);
         std::swap(nFlags, check.nFlags);
         std::swap(nHashType, check.nHashType);
+        psighash.swap(check.psighash);
+    }
+};
+
+// Closure representing one previous transaction read for the ConnectBlock prefetch stage
+// Note that this stores a reference to the slot in the prefetched MapPrevTx.
+// A failed read leaves the slot null; FetchInputs then falls back to the serial path.
+class CPrevoutFetch
+{
+private:
+    uint256 hash;
+    CDiskTxPos pos;
+    CTransaction *ptxPrev;
+
+public:
+    CPrevoutFetch() : ptxPrev(nullptr) {}
+    CPrevoutFetch(const uint256 &hashIn, const CDiskTxPos &posIn, CTransaction &txPrevIn) : hash(hashIn), pos(posIn), ptxPrev(&txPrevIn) {}
+
+    bool operator()();
+    void swap(CPrevoutFetch &fetch) {
+        std::swap(hash, fetch.hash);
+        std::swap(pos, fetch.pos);
+        std::swap(ptxPrev, fetch.ptxPrev);
     }
 };
 
@@ -93,12 +93,12 @@ unsigned int Checkpoints::manage::GetLastCheckpointTime() {
     return (args_bool::fTestNet ? CheckpointLastTimeTestnet : CheckpointLastTime);
 }
 
-CBlockIndex *Checkpoints::manage::GetLastCheckpoint(const std::map<uint256, CBlockIndex *> &mapBlockIndex) {
+CBlockIndex *Checkpoints::manage::GetLastCheckpoint(const BlockMap &mapBlockIndex) {
     const MapCheckpoints &checkpoints = (args_bool::fTestNet ? mapCheckpointsTestnet : mapCheckpoints);
     BOOST_REVERSE_FOREACH(const MapCheckpoints::value_type &i, checkpoints)
     {
         const uint256 &hash = i.second;
-        std::map<uint256, CBlockIndex *>::const_iterator t = mapBlockIndex.find(hash);
+        BlockMap::const_iterator t = mapBlockIndex.find(hash);
         if (t != mapBlockIndex.end()) {
             return t->second;
         }
@@ -113,7 +113,7 @@ CBlockIndex *Checkpoints::manage::GetLastSyncCheckpoint() {
         bool ret = logging::error("Checkpoints::manage::GetSyncCheckpoint: block index missing for current sync-checkpoint %s", Checkpoints::manage::hashSyncCheckpoint.ToString().c_str());
         (void)ret;
     } else {
-        return block_info::mapBlockIndex[Checkpoints::manage::hashSyncCheckpoint];
+        return block_info::mapBlockIndex.get(Checkpoints::manage::hashSyncCheckpoint);
     }
     return nullptr;
 }
@@ -127,8 +127,8 @@ bool Checkpoints::manage::ValidateSyncCheckpoint(uint256 hashCheckpoint) {
         return logging::error("Checkpoints::manage::ValidateSyncCheckpoint: block index missing for received sync-checkpoint %s", hashCheckpoint.ToString().c_str());
     }
 
-    CBlockIndex *pindexSyncCheckpoint = block_info::mapBlockIndex[Checkpoints::manage::hashSyncCheckpoint];
-    CBlockIndex *pindexCheckpointRecv = block_info::mapBlockIndex[hashCheckpoint];
+    CBlockIndex *pindexSyncCheckpoint = block_info::mapBlockIndex.get(Checkpoints::manage::hashSyncCheckpoint);
+    CBlockIndex *pindexCheckpointRecv = block_info::mapBlockIndex.get(hashCheckpoint);
 
     if (pindexCheckpointRecv->get_nHeight() <= pindexSyncCheckpoint->get_nHeight()) {
         // Received an older checkpoint, trace back from current checkpoint
@@ -187,7 +187,7 @@ bool Checkpoints::manage::AcceptPendingSyncCheckpoint() {
         }
 
         CTxDB txdb;
-        CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex[Checkpoints::hashPendingCheckpoint];
+        CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex.get(Checkpoints::hashPendingCheckpoint);
         if (! pindexCheckpoint->IsInMainChain()) {
             CBlock block;
             if (! block.ReadFromDisk(pindexCheckpoint)) {
@@ -244,7 +244,7 @@ bool Checkpoints::manage::CheckSync(const uint256 &hashBlock, const CBlockIndex
     // logging::LogPrintf("Checkpoints::manage::CheckSync: pindexSync - block Checkpoints::manage::hashSyncCheckpoint_%s\n", Checkpoints::manage::hashSyncCheckpoint.ToString().c_str());
     // logging::LogPrintf("Checkpoints::manage::CheckSync: pindexSync - block block_info::mapBlockIndex.count_%d\n", block_info::mapBlockIndex.count(Checkpoints::manage::hashSyncCheckpoint));
     assert(block_info::mapBlockIndex.count(Checkpoints::manage::hashSyncCheckpoint));
-    const CBlockIndex *pindexSync = block_info::mapBlockIndex[Checkpoints::manage::hashSyncCheckpoint];
+    const CBlockIndex *pindexSync = block_info::mapBlockIndex.get(Checkpoints::manage::hashSyncCheckpoint);
 
     if (nHeight > pindexSync->get_nHeight()) {
         // trace back to same height as sync-checkpoint
@@ -286,17 +286,17 @@ bool Checkpoints::manage::ResetSyncCheckpoint() {
     LLOCK(Checkpoints::cs_hashSyncCheckpoint);
 
     const uint256 &hash = Checkpoints::manage::mapCheckpoints.rbegin()->second;
-    if (block_info::mapBlockIndex.count(hash) && !block_info::mapBlockIndex[hash]->IsInMainChain()) {
+    if (block_info::mapBlockIndex.count(hash) && !block_info::mapBlockIndex.get(hash)->IsInMainChain()) {
         //
         // checkpoint block accepted but not yet in main chain
         //
         logging::LogPrintf("Checkpoints::manage::ResetSyncCheckpoint: SetBestChain to hardened checkpoint %s\n", hash.ToString().c_str());
         CTxDB txdb;
         CBlock block;
-        if (! block.ReadFromDisk(block_info::mapBlockIndex[hash])) {
+        if (! block.ReadFromDisk(block_info::mapBlockIndex.get(hash))) {
             return logging::error("Checkpoints::manage::ResetSyncCheckpoint: ReadFromDisk failed for hardened checkpoint %s", hash.ToString().c_str());
         }
-        if (! block.SetBestChain(txdb, block_info::mapBlockIndex[hash])) {
+        if (! block.SetBestChain(txdb, block_info::mapBlockIndex.get(hash))) {
             return logging::error("Checkpoints::manage::ResetSyncCheckpoint: SetBestChain failed for hardened checkpoint %s", hash.ToString().c_str());
         }
     } else if (! block_info::mapBlockIndex.count(hash)) {
@@ -311,7 +311,7 @@ bool Checkpoints::manage::ResetSyncCheckpoint() {
     BOOST_REVERSE_FOREACH(const MapCheckpoints::value_type &i, Checkpoints::manage::mapCheckpoints)
     {
         const uint256 &hash = i.second;
-        if (block_info::mapBlockIndex.count(hash) && block_info::mapBlockIndex[hash]->IsInMainChain()) {
+        if (block_info::mapBlockIndex.count(hash) && block_info::mapBlockIndex.get(hash)->IsInMainChain()) {
             if (! Checkpoints::manage::WriteSyncCheckpoint(hash)) {
                 return logging::error("Checkpoints::manage::ResetSyncCheckpoint: failed to write sync checkpoint %s", hash.ToString().c_str());
             }
@@ -394,7 +394,7 @@ bool Checkpoints::manage::IsMatureSyncCheckpoint() {
 
     // sync-checkpoint should always be accepted block
     assert(block_info::mapBlockIndex.count(Checkpoints::manage::hashSyncCheckpoint));
-    const CBlockIndex *pindexSync = block_info::mapBlockIndex[hashSyncCheckpoint];
+    const CBlockIndex *pindexSync = block_info::mapBlockIndex.get(hashSyncCheckpoint);
     return (block_info::nBestHeight >= pindexSync->get_nHeight() + block_transaction::nCoinbaseMaturity || pindexSync->GetBlockTime() + block_check::nStakeMinAge < bitsystem::GetAdjustedTime());
 }
 
@@ -440,7 +440,7 @@ bool CSyncCheckpoint::ProcessSyncCheckpoint(CNode *pfrom) {
     }
 
     CTxDB txdb;
-    CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex[hashCheckpoint];
+    CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex.get(hashCheckpoint);
     if (! pindexCheckpoint->IsInMainChain()) {
         // checkpoint chain received but not yet main chain
         CBlock block;
@@ -220,7 +220,7 @@ namespace Checkpoints
         static void AskForPendingSyncCheckpoint(CNode *pfrom);
         static bool SetCheckpointPrivKey(std::string strPrivKey);
         
-        static CBlockIndex *GetLastCheckpoint(const std::map<uint256, CBlockIndex *> &mapBlockIndex);    // Returns last CBlockIndex* in mapBlockIndex that is a checkpoint
+        static CBlockIndex *GetLastCheckpoint(const BlockMap &mapBlockIndex);    // Returns last CBlockIndex* in mapBlockIndex that is a checkpoint
         static bool AutoSendSyncCheckpoint();
         static bool IsMatureSyncCheckpoint();
 
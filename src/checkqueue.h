@@ -1,4 +1,5 @@
 // Copyright (c) 2012 The Bitcoin developers
+// Copyright (c) 2018-2021 The SorachanCoin developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 // @@
@@ -6,15 +7,89 @@
 #define CHECKQUEUE_H
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <vector>
+#include <cassert>
 
-#include <boost/foreach.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
 
 template<typename T> class CCheckQueueControl;
 
+/** Work-stealing deque of ranges (Chase-Lev, "Correct and Efficient Work-Stealing
+  * for Weak Memory Models"). Only the owner pushes and pops at the bottom; any
+  * thread may steal from the top. A range is packed as start << 32 | count, and
+  * 0 (an empty range) means "nothing". Fixed capacity: Push fails when full.
+  */
+class CCheckRangeDeque
+{
+private:
+    CCheckRangeDeque(const CCheckRangeDeque &)=delete;
+    CCheckRangeDeque &operator=(const CCheckRangeDeque &)=delete;
+
+    static constexpr int64_t CAPACITY = 512;
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    std::atomic<uint64_t> buffer[CAPACITY];
+
+public:
+    CCheckRangeDeque() : top(0), bottom(0) {
+        for (std::atomic<uint64_t> &slot: buffer)
+            slot.store(0, std::memory_order_relaxed);
+    }
+
+    static uint64_t Pack(uint32_t nStart, uint32_t nCount) {return ((uint64_t)nStart << 32) | nCount;}
+    static uint32_t Start(uint64_t range) {return (uint32_t)(range >> 32);}
+    static uint32_t Count(uint64_t range) {return (uint32_t)range;}
+
+    // owner only
+    bool Push(uint64_t range) {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY)
+            return false;
+        buffer[b % CAPACITY].store(range, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // owner only
+    uint64_t Pop() {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) { // empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return 0;
+        }
+        uint64_t range = buffer[b % CAPACITY].load(std::memory_order_relaxed);
+        if (t == b) { // last one: race the thieves for it
+            if (! top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                range = 0;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return range;
+    }
+
+    // any thread; 0 when empty or when another thread won the race
+    uint64_t Steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return 0;
+        const uint64_t range = buffer[t % CAPACITY].load(std::memory_order_relaxed);
+        if (! top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return 0;
+        return range;
+    }
+};
+
 /** Queue for verifications that have to be performed.
   * The verifications are represented by a type T, which must provide an
   * operator(), returning a bool.
@@ -23,190 +98,273 @@ template<typename T> class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every worker (slot 0 is the master) owns a CCheckRangeDeque of index ranges
+  * into the queue's item storage. Add() moves the checks into the storage and
+  * pushes their range onto the master's deque. A worker pops from its own deque,
+  * or steals from another one when it is empty; a range larger than nBatchSize is
+  * split, and the upper half pushed back onto the worker's deque where the others
+  * can steal it. No lock is taken to hand out work: the mutex is only used to
+  * park workers that found nothing and to wake the master at the end.
+  * After the first failure the remaining checks are skipped.
   */
 template<typename T>
 class CCheckQueue
 {
 private:
-    CCheckQueue(); // {}
-    CCheckQueue(const CCheckQueue &); // {}
-    CCheckQueue &operator=(const CCheckQueue &); // {}
+    CCheckQueue()=delete;
+    CCheckQueue(const CCheckQueue &)=delete;
+    CCheckQueue &operator=(const CCheckQueue &)=delete;
+
+    static constexpr unsigned int MAX_WORKERS = 64;     // including the master
+    static constexpr unsigned int SEGMENT_BITS = 12;
+    static constexpr unsigned int SEGMENT_SIZE = 1 << SEGMENT_BITS;
+    static constexpr unsigned int MAX_SEGMENTS = 4096;  // checks per Wait: SEGMENT_SIZE * MAX_SEGMENTS
+    static constexpr int SEARCH_ROUNDS = 64;            // failed steal rounds before a worker parks
+
+    struct alignas(64) worker {
+        CCheckRangeDeque deque;
+        std::atomic<uint64_t> nChecks;      // run
+        std::atomic<uint64_t> nSkipped;     // released without running after a failure
+        std::atomic<uint64_t> nBatches;
+        std::atomic<uint64_t> nSteals;
+        std::atomic<uint64_t> nBusyMicros;
+        std::atomic<uint64_t> nIdleMicros;
+        worker() : nChecks(0), nSkipped(0), nBatches(0), nSteals(0), nBusyMicros(0), nIdleMicros(0) {}
+    };
+
+    using clock = std::chrono::steady_clock;
+    static uint64_t Micros(clock::duration d) {return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();}
+
+    // Item storage, in segments so that Add never moves a check a worker may be running.
+    // Segments are allocated by the master and kept for later blocks.
+    std::atomic<T *> segments[MAX_SEGMENTS];
+    std::vector<std::unique_ptr<T[]>> vSegmentOwner;
+    uint32_t nStored;                   // master only: items added since the last Wait
+
+    std::unique_ptr<worker[]> workers;
+    std::atomic<unsigned int> nWorkers; // worker threads that have entered Thread()
+    std::atomic<unsigned int> nRunning; // worker threads that have not left Thread()
+
+    // Number of verifications that haven't completed yet.
+    std::atomic<uint32_t> nTodo;
 
-    // Mutex to protect the inner state
-    mutable boost::mutex mutex;
+    // The temporary evaluation result.
+    std::atomic<bool> fAllOk;
 
-    // Worker threads block on this when out of work
-    boost::condition_variable condWorker;
+    // Whether we're shutting down.
+    std::atomic<bool> fQuit;
 
-    // Master thread blocks on this when out of work
+    // Parking: Add bumps nGeneration and wakes parked workers, the last check wakes the master
+    std::atomic<uint64_t> nGeneration;
+    std::atomic<int> nParked;
+    boost::mutex mutex;
+    boost::condition_variable condWorker;
     boost::condition_variable condMaster;
-
-    // Quit method blocks on this until all workers are gone
     boost::condition_variable condQuit;
 
-    // The queue of elements to be processed.
-    // As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue;
-
-    // The number of workers (including the master) that are idle.
-    int nIdle;
-
-    // The total number of workers (including the master).
-    int nTotal;
+    // The maximum number of elements to be processed in one batch
+    const unsigned int nBatchSize;
 
-    // The temporary evaluation result.
-    bool fAllOk;
+    std::atomic<uint64_t> nWaits;
+    std::atomic<uint64_t> nWaitMicros;  // master blocked in Wait for the other workers
 
-    // Number of verifications that haven't completed yet.
-    // This includes elements that are not anymore in queue, but still in
-    // worker's own batches.
-    unsigned int nTodo;
+    T &Item(uint32_t nIndex) {
+        return segments[nIndex >> SEGMENT_BITS].load(std::memory_order_acquire)[nIndex & (SEGMENT_SIZE - 1)];
+    }
 
-    // Whether we're shutting down.
-    bool fQuit;
+    uint64_t Steal(unsigned int nSelf) {
+        const unsigned int nSlots = std::min(nWorkers.load(std::memory_order_acquire) + 1, MAX_WORKERS);
+        for (unsigned int i = 1; i < nSlots; ++i) {
+            worker &victim = workers[(nSelf + i) % nSlots];
+            const uint64_t range = victim.deque.Steal();
+            if (range) {
+                workers[nSelf].nSteals.fetch_add(1, std::memory_order_relaxed);
+                return range;
+            }
+        }
+        return 0;
+    }
 
-    // The maximum number of elements to be processed in one batch
-    unsigned int nBatchSize;
+    //
+    // Run a range: keep nBatchSize checks, push the rest back for the other workers.
+    //
+    void Run(worker &w, uint64_t range) {
+        uint32_t nStart = CCheckRangeDeque::Start(range);
+        uint32_t nCount = CCheckRangeDeque::Count(range);
+        bool fSplit = false;
+        while (nCount > nBatchSize) {
+            const uint32_t nHalf = nCount / 2;
+            if (! w.deque.Push(CCheckRangeDeque::Pack(nStart + nCount - nHalf, nHalf)))
+                break;
+            nCount -= nHalf;
+            fSplit = true;
+        }
+        if (fSplit)
+            Wake(); // parked workers only look again after a Wake
+
+        uint32_t nRun = 0;
+        for (uint32_t i = nStart; i < nStart + nCount; ++i) {
+            T &check = Item(i);
+            if (fAllOk.load(std::memory_order_relaxed) && !args_bool::fShutdown) {
+                if (! check())
+                    fAllOk.store(false, std::memory_order_relaxed);
+                ++nRun;
+            }
+            T().swap(check); // release what the check holds before the slot is reused
+        }
+        w.nChecks.fetch_add(nRun, std::memory_order_relaxed);
+        w.nSkipped.fetch_add(nCount - nRun, std::memory_order_relaxed);
+        w.nBatches.fetch_add(1, std::memory_order_relaxed);
+
+        if (nTodo.fetch_sub(nCount, std::memory_order_acq_rel) == nCount) {
+            // We processed the last element; inform the master he can exit and return the result
+            boost::unique_lock<boost::mutex> lock(this->mutex);
+            this->condMaster.notify_one();
+        }
+    }
 
     //
     // Internal function that does bulk of the verification work.
     //
-    bool Loop(bool fMaster = false) {
-        boost::condition_variable &cond = fMaster ? this->condMaster : this->condWorker;
-
-        std::vector<T> vChecks;
-        vChecks.reserve(this->nBatchSize);
+    void Loop(unsigned int nSelf) {
+        worker &w = workers[nSelf];
+        clock::time_point tLast = clock::now();
+        int nRounds = 0;
+        for (;;) {
+            const uint64_t nGen = nGeneration.load(std::memory_order_seq_cst);
+            uint64_t range = w.deque.Pop();
+            if (! range)
+                range = Steal(nSelf);
+            if (range) {
+                const clock::time_point tStart = clock::now();
+                w.nIdleMicros.fetch_add(Micros(tStart - tLast), std::memory_order_relaxed);
+                Run(w, range);
+                tLast = clock::now();
+                w.nBusyMicros.fetch_add(Micros(tLast - tStart), std::memory_order_relaxed);
+                nRounds = 0;
+                continue;
+            }
+            if (fQuit.load(std::memory_order_acquire))
+                return;
+            if (++nRounds < SEARCH_ROUNDS) {
+                boost::this_thread::yield();
+                continue;
+            }
 
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do
-        {
+            // out of work: park until Add or Quit
+            w.nIdleMicros.fetch_add(Micros(clock::now() - tLast), std::memory_order_relaxed);
             {
                 boost::unique_lock<boost::mutex> lock(this->mutex);
-
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    this->fAllOk &= fOk;
-                    this->nTodo -= nNow;
-                    if (this->nTodo == 0 && !fMaster) {
-                        // We processed the last element; inform the master he can exit and return the result
-                        this->condMaster.notify_one();
-                    }
-                } else {
-                    // first iteration
-                    this->nTotal++;
-                }
-
-                //
-                // logically, the do loop starts here
-                //
-                while (this->queue.empty())
-                {
-                    if ((fMaster || this->fQuit) && this->nTodo == 0) {
-                        this->nTotal--;
-                        if (this->nTotal==0) {
-                            this->condQuit.notify_one();
-                        }
-
-                        bool fRet = this->fAllOk;
-                        // reset the status for new work later
-                        if (fMaster) {
-                            this->fAllOk = true;
-                        }
-
-                        // return the current status
-                        return fRet;
-                    }
-                    this->nIdle++;
-                    cond.wait(lock); // wait
-                    this->nIdle--;
-                }
-
-                //
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                //
-                nNow = std::max(1U, std::min(this->nBatchSize, (unsigned int)this->queue.size() / (this->nTotal + this->nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; ++i)
-                {
-                     //
-                     // We want the lock on the mutex to be as short as possible, so swap jobs from the global
-                     // queue to the local batch vector instead of copying.
-                     //
-                     vChecks[i].swap(queue.back());
-                     this->queue.pop_back();
-                }
-
-                //
-                // Check whether we need to do work at all
-                //
-                fOk = this->fAllOk;
+                nParked.fetch_add(1, std::memory_order_seq_cst);
+                while (nGeneration.load(std::memory_order_seq_cst) == nGen && !fQuit.load(std::memory_order_acquire))
+                    this->condWorker.wait(lock);
+                nParked.fetch_sub(1, std::memory_order_relaxed);
             }
+            tLast = clock::now();
+            nRounds = 0;
+        }
+    }
 
-            //
-            // execute work
-            //
-            BOOST_FOREACH(T &check, vChecks)
-            {
-                if (fOk) {
-                    fOk = check();
-                }
-            }
-            vChecks.clear();
-        } while(true && !args_bool::fShutdown); // HACK: force queue to shut down
-        return false;
+    void Wake() {
+        nGeneration.fetch_add(1, std::memory_order_seq_cst);
+        if (nParked.load(std::memory_order_seq_cst) > 0) {
+            { boost::unique_lock<boost::mutex> lock(this->mutex); }
+            this->condWorker.notify_all();
+        }
     }
 
 public:
     // Create a new check queue
-    CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn) {}
+    CCheckQueue(unsigned int nBatchSizeIn) : nStored(0), workers(new worker[MAX_WORKERS]), nWorkers(0), nRunning(0), nTodo(0), fAllOk(true), fQuit(false),
+        nGeneration(0), nParked(0), nBatchSize(std::max(1U, nBatchSizeIn)), nWaits(0), nWaitMicros(0) {
+        for (std::atomic<T *> &segment: segments)
+            segment.store(nullptr, std::memory_order_relaxed);
+    }
 
     // Worker thread
     void Thread() {
-        Loop();
+        const unsigned int nSelf = nWorkers.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (nSelf >= MAX_WORKERS)
+            return;
+        nRunning.fetch_add(1, std::memory_order_acq_rel);
+        Loop(nSelf);
+        boost::unique_lock<boost::mutex> lock(this->mutex);
+        if (nRunning.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            this->condQuit.notify_all();
     }
 
     // Wait until execution finishes, and return whether all evaluations where succesful.
     bool Wait() {
-        return Loop(true);
+        worker &w = workers[0];
+        clock::time_point tLast = clock::now();
+        for (;;) {
+            uint64_t range = w.deque.Pop();
+            if (! range)
+                range = Steal(0);
+            if (range) {
+                const clock::time_point tStart = clock::now();
+                w.nIdleMicros.fetch_add(Micros(tStart - tLast), std::memory_order_relaxed);
+                Run(w, range);
+                tLast = clock::now();
+                w.nBusyMicros.fetch_add(Micros(tLast - tStart), std::memory_order_relaxed);
+                continue;
+            }
+            if (nTodo.load(std::memory_order_acquire) == 0)
+                break;
+
+            // the rest is running on other workers
+            const clock::time_point tWait = clock::now();
+            {
+                boost::unique_lock<boost::mutex> lock(this->mutex);
+                while (nTodo.load(std::memory_order_acquire) != 0)
+                    this->condMaster.wait(lock);
+            }
+            tLast = clock::now();
+            nWaitMicros.fetch_add(Micros(tLast - tWait), std::memory_order_relaxed);
+            w.nIdleMicros.fetch_add(Micros(tLast - tWait), std::memory_order_relaxed);
+        }
+        w.nIdleMicros.fetch_add(Micros(clock::now() - tLast), std::memory_order_relaxed);
+        nWaits.fetch_add(1, std::memory_order_relaxed);
+
+        // reset the status for new work later
+        nStored = 0;
+        const bool fRet = fAllOk.exchange(true, std::memory_order_acq_rel);
+        return fRet && !args_bool::fShutdown;
     }
 
     // Add a batch of checks to the queue
     void Add(std::vector<T> &vChecks) {
-        boost::unique_lock<boost::mutex> lock(this->mutex);
-
-        BOOST_FOREACH(T &check, vChecks)
-        {
-            this->queue.push_back(T());
-            check.swap(queue.back());
-        }
-        
-        this->nTodo += vChecks.size();
-        if (vChecks.size() == 1) {
-            this->condWorker.notify_one();
-        } else if (vChecks.size() > 1) {
-            this->condWorker.notify_all();
+        if (vChecks.empty())
+            return;
+
+        const uint32_t nStart = nStored;
+        for (T &check: vChecks) {
+            const uint32_t nSegment = nStored >> SEGMENT_BITS;
+            assert(nSegment < MAX_SEGMENTS);
+            if (nSegment == vSegmentOwner.size()) {
+                vSegmentOwner.emplace_back(new T[SEGMENT_SIZE]);
+                segments[nSegment].store(vSegmentOwner.back().get(), std::memory_order_release);
+            }
+            check.swap(vSegmentOwner[nSegment][nStored & (SEGMENT_SIZE - 1)]);
+            ++nStored;
         }
+
+        nTodo.fetch_add((uint32_t)vChecks.size(), std::memory_order_acq_rel);
+        const uint64_t range = CCheckRangeDeque::Pack(nStart, (uint32_t)vChecks.size());
+        if (! workers[0].deque.Push(range))
+            Run(workers[0], range); // the master's deque is full: do this batch now
+        Wake();
     }
 
     // Shut the queue down
     void Quit() {
-        boost::unique_lock<boost::mutex> lock(this->mutex);
-
-        this->fQuit = true;
+        fQuit.store(true, std::memory_order_release);
+        Wake();
 
-        //
-        // No need to wake the master, as he will quit automatically when all jobs are done.
-        //
-        this->condWorker.notify_all(); 
-
-        while (this->nTotal > 0)
-        {
+        boost::unique_lock<boost::mutex> lock(this->mutex);
+        while (nRunning.load(std::memory_order_acquire) > 0)
             this->condQuit.wait(lock);
-        }
     }
 
     ~CCheckQueue() {
@@ -214,9 +372,35 @@ public:
     }
 
     bool IsIdle() const {
-        boost::unique_lock<boost::mutex> lock(this->mutex);
+        return (nTodo.load(std::memory_order_acquire) == 0 && fAllOk.load(std::memory_order_acquire) == true);
+    }
 
-        return (this->nTotal == nIdle && this->nTodo == 0 && this->fAllOk == true);
+    struct worker_stats {
+        uint64_t nChecks;
+        uint64_t nSkipped;
+        uint64_t nBatches;
+        uint64_t nSteals;
+        uint64_t nBusyMicros;
+        uint64_t nIdleMicros;   // searching for work or, for the master, waiting for the others; parked time is not counted
+    };
+    struct stats {
+        unsigned int nBatchSize;
+        uint64_t nWaits;
+        uint64_t nWaitMicros;
+        std::vector<worker_stats> vWorker; // [0]: the master
+    };
+    stats GetStats() const {
+        stats st;
+        st.nBatchSize = nBatchSize;
+        st.nWaits = nWaits.load(std::memory_order_relaxed);
+        st.nWaitMicros = nWaitMicros.load(std::memory_order_relaxed);
+        const unsigned int nSlots = std::min(nWorkers.load(std::memory_order_acquire) + 1, MAX_WORKERS);
+        for (unsigned int i = 0; i < nSlots; ++i) {
+            const worker &w = workers[i];
+            st.vWorker.push_back(worker_stats{w.nChecks.load(std::memory_order_relaxed), w.nSkipped.load(std::memory_order_relaxed), w.nBatches.load(std::memory_order_relaxed),
+                w.nSteals.load(std::memory_order_relaxed), w.nBusyMicros.load(std::memory_order_relaxed), w.nIdleMicros.load(std::memory_order_relaxed)});
+        }
+        return st;
     }
 };
 
@@ -92,4 +92,37 @@ namespace latest_json
     void JsonAssertcheck(benchmark::State& state);
 }
 
+namespace check_merkle
+{
+    void MerkleAssertcheck(benchmark::State& state);
+}
+
+namespace check_sighash
+{
+    void SigHashAssertcheck(benchmark::State& state);
+}
+
+namespace check_checkqueue
+{
+    void CheckQueueAssertcheck(benchmark::State& state);
+}
+
+namespace check_ecmult
+{
+    void EcmultAssertcheck(benchmark::State& state);
+}
+
+namespace check_evalscript
+{
+    void EvalScriptAssertcheck(benchmark::State& state);
+}
+
+namespace check_kernel
+{
+    void KernelAssertcheck(benchmark::State& state);
+    void KernelTargetAssertcheck(benchmark::State& state);
+    void KernelScanInputAssertcheck(benchmark::State& state);
+    void StakeModifierCacheAssertcheck(benchmark::State& state);
+}
+
 #endif // BITCOIN_COMPAT_SANITY_H
@@ -10,4 +10,7 @@
 /** Default for blocks only*/
 static const bool DEFAULT_BLOCKSONLY = false;
 
+/** File descriptors kept for block files, leveldb, the wallet and RPC; the rest may be peers */
+static const int MIN_CORE_FILEDESCRIPTORS = 150;
+
 #endif
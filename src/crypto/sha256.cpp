@@ -24,11 +24,13 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks) noexcept;
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in) noexcept;
+void TransformDBlock_4way(unsigned char* out, const unsigned char* in) noexcept;
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in) noexcept;
+void TransformDBlock_8way(unsigned char* out, const unsigned char* in) noexcept;
 }
 
 namespace sha256d64_shani
@@ -458,11 +460,46 @@ void TransformD64Wrapper(unsigned char* out, const unsigned char* in) noexcept
     WriteBE32(out + 28, s[7]);
 }
 
+template<TransformType tr>
+void TransformDBlockWrapper(unsigned char* out, const unsigned char* in) noexcept
+{
+    uint32_t s[8];
+    unsigned char buffer2[64] = {
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0
+    };
+    sha256::Initialize(s);
+    tr(s, in, 1);
+    WriteBE32(buffer2 + 0, s[0]);
+    WriteBE32(buffer2 + 4, s[1]);
+    WriteBE32(buffer2 + 8, s[2]);
+    WriteBE32(buffer2 + 12, s[3]);
+    WriteBE32(buffer2 + 16, s[4]);
+    WriteBE32(buffer2 + 20, s[5]);
+    WriteBE32(buffer2 + 24, s[6]);
+    WriteBE32(buffer2 + 28, s[7]);
+    sha256::Initialize(s);
+    tr(s, buffer2, 1);
+    WriteBE32(out + 0, s[0]);
+    WriteBE32(out + 4, s[1]);
+    WriteBE32(out + 8, s[2]);
+    WriteBE32(out + 12, s[3]);
+    WriteBE32(out + 16, s[4]);
+    WriteBE32(out + 20, s[5]);
+    WriteBE32(out + 24, s[6]);
+    WriteBE32(out + 28, s[7]);
+}
+
 TransformType Transform = sha256::Transform;
 TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformD64Type TransformDBlock = TransformDBlockWrapper<sha256::Transform>;
+TransformD64Type TransformDBlock_4way = nullptr;
+TransformD64Type TransformDBlock_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -510,6 +547,26 @@ bool SelfTest() {
         0x6a, 0x46, 0x30, 0xa6, 0x89, 0x86, 0x23, 0xac, 0xf8, 0xa5, 0x15, 0xe9, 0x0a, 0xaa, 0x1e, 0x9a,
         0xd7, 0x93, 0x6b, 0x28, 0xe4, 0x3b, 0xfd, 0x59, 0xc6, 0xed, 0x7c, 0x5f, 0xa5, 0x41, 0xcb, 0x51
     };
+    // Expected output of TransformDBlock for each of the individual 8 64-byte messages,
+    // taken as already padded single blocks.
+    static const unsigned char result_dblock[256] = {
+        0x59, 0x01, 0x44, 0x90, 0xfc, 0xc8, 0xa7, 0xf4, 0x3c, 0xeb, 0x01, 0xf1, 0x08, 0x66, 0x1d, 0xe9,
+        0x2c, 0x5f, 0x8c, 0x47, 0xb7, 0xd6, 0xd1, 0x32, 0x4b, 0x84, 0xc4, 0x30, 0x5f, 0xfd, 0xea, 0x05,
+        0xd8, 0xac, 0xe7, 0x1f, 0x96, 0x34, 0x40, 0x5d, 0xc4, 0xf5, 0xbc, 0x83, 0x50, 0x91, 0xf0, 0xfa,
+        0x34, 0x0b, 0x73, 0xb3, 0x33, 0x3d, 0xe3, 0xd5, 0x89, 0xb7, 0x19, 0x54, 0x2b, 0x64, 0xc4, 0x3e,
+        0xc7, 0x5d, 0x62, 0xf7, 0xb5, 0x2c, 0xa3, 0x36, 0x3d, 0x15, 0x95, 0xdd, 0xca, 0x47, 0xec, 0xc6,
+        0x73, 0xff, 0x1f, 0x73, 0x00, 0x18, 0x03, 0xf6, 0xa1, 0x89, 0x91, 0xcd, 0x9d, 0x51, 0x25, 0x0e,
+        0xaa, 0xe8, 0x97, 0x54, 0x39, 0xa8, 0xa3, 0xd4, 0x1c, 0xcd, 0xf5, 0x7c, 0xc4, 0x04, 0x3e, 0x25,
+        0x73, 0x0b, 0x71, 0xcd, 0x50, 0x2f, 0x6c, 0xc0, 0x53, 0x4e, 0x80, 0xfb, 0x59, 0x13, 0xcb, 0xa9,
+        0xa2, 0x8f, 0x44, 0x4a, 0xc1, 0x7b, 0xf9, 0x36, 0x80, 0x28, 0xbc, 0x01, 0x15, 0xd6, 0x98, 0x11,
+        0xe2, 0x65, 0x1b, 0x25, 0x33, 0x9a, 0xb9, 0x9e, 0xdc, 0x06, 0xf6, 0x20, 0xa3, 0x44, 0xaf, 0xbd,
+        0x40, 0xce, 0x80, 0x31, 0x26, 0xaa, 0xfc, 0x1f, 0x80, 0xbe, 0x45, 0x38, 0x0c, 0xc0, 0x61, 0x5b,
+        0x79, 0x22, 0xd7, 0xa9, 0xed, 0x07, 0x4f, 0x97, 0x7d, 0x62, 0x96, 0x19, 0xbd, 0x83, 0x68, 0xc7,
+        0x62, 0x90, 0xd0, 0xce, 0x08, 0x9a, 0x73, 0x3f, 0xf1, 0x10, 0x36, 0x77, 0x07, 0x45, 0xaf, 0x2c,
+        0x4a, 0xc3, 0x3e, 0x55, 0x11, 0x29, 0xc9, 0x84, 0x4a, 0x5a, 0x2b, 0x69, 0x9b, 0xae, 0x98, 0x81,
+        0x16, 0xd9, 0xc8, 0x2b, 0xb8, 0x25, 0x35, 0x00, 0x3e, 0x1e, 0xeb, 0xa2, 0x48, 0x78, 0xf3, 0xd3,
+        0x27, 0x6c, 0x06, 0xb1, 0xb7, 0x46, 0x62, 0xe0, 0xc9, 0xce, 0xec, 0x4b, 0x2d, 0xad, 0xd5, 0x5d
+    };
 
 
     // Test Transform() for 0 through 8 transformations.
@@ -546,6 +603,41 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformDBlock: a real padded 55-byte message against CSHA256,
+    // then the 8 64-byte messages taken as already padded single blocks.
+    {
+        unsigned char hash[32];
+        CSHA256 hasher;
+        hasher.Write(data + 1, 55).Finalize(hash);
+        hasher.Reset().Write(hash, 32).Finalize(hash);
+        unsigned char block[64];
+        std::copy(data + 1, data + 56, block);
+        block[55] = 0x80;
+        std::fill(block + 56, block + 62, 0);
+        block[62] = 0x01;
+        block[63] = 0xb8; // 55 bytes = 440 bits
+        TransformDBlock(out, block);
+        if (!std::equal(out, out + 32, hash)) return false;
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        TransformDBlock(out, data + 1 + 64 * i);
+        if (!std::equal(out, out + 32, result_dblock + 32 * i)) return false;
+    }
+
+    // Test TransformDBlock_4way, if available.
+    if (TransformDBlock_4way) {
+        unsigned char out[128];
+        TransformDBlock_4way(out, data + 1);
+        if (!std::equal(out, out + 128, result_dblock)) return false;
+    }
+
+    // Test TransformDBlock_8way, if available.
+    if (TransformDBlock_8way) {
+        unsigned char out[256];
+        TransformDBlock_8way(out, data + 1);
+        if (!std::equal(out, out + 256, result_dblock)) return false;
+    }
+
     return true;
 }
 
@@ -609,6 +701,7 @@ std::string SHA256AutoDetect()
     if (have_shani) {
         Transform = sha256_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_shani::Transform>;
+        TransformDBlock = TransformDBlockWrapper<sha256_shani::Transform>;
         TransformD64_2way = sha256d64_shani::Transform_2way;
         ret = "shani(1way,2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
@@ -620,10 +713,12 @@ std::string SHA256AutoDetect()
 #if defined(__x86_64__) || defined(__amd64__)
         Transform = sha256_sse4::Transform;
         TransformD64 = TransformD64Wrapper<sha256_sse4::Transform>;
+        TransformDBlock = TransformDBlockWrapper<sha256_sse4::Transform>;
         ret = "sse4(1way)";
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformDBlock_4way = sha256d64_sse41::TransformDBlock_4way;
         ret += ",sse41(4way)";
 #endif
     }
@@ -631,6 +726,7 @@ std::string SHA256AutoDetect()
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformDBlock_8way = sha256d64_avx2::TransformDBlock_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -731,4 +827,30 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks) noexc
     }
 }
 
+void SHA256DBlock(unsigned char* out, const unsigned char* in, size_t blocks) noexcept
+{
+    if (TransformDBlock_8way) {
+        while (blocks >= 8) {
+            TransformDBlock_8way(out, in);
+            out += 256;
+            in += 512;
+            blocks -= 8;
+        }
+    }
+    if (TransformDBlock_4way) {
+        while (blocks >= 4) {
+            TransformDBlock_4way(out, in);
+            out += 128;
+            in += 256;
+            blocks -= 4;
+        }
+    }
+    while (blocks) {
+        TransformDBlock(out, in);
+        out += 32;
+        in += 64;
+        --blocks;
+    }
+}
+
 } // namespace latest_crypto
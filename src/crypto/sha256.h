@@ -47,6 +47,14 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks) noexcept;
 
+/** Compute multiple double-SHA256's of short messages (at most 55 bytes), each given
+ *  as its single SHA256-padded 64-byte block (message, 0x80, zeros, 64-bit bit length).
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer
+ *  blocks:  the number of hashes to compute.
+ */
+void SHA256DBlock(unsigned char* output, const unsigned char* input, size_t blocks) noexcept;
+
 } // namespace latest_crypto
 
 #endif // BITCOIN_CRYPTO_SHA256_H
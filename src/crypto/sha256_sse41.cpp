@@ -61,19 +61,17 @@ void inline Write4(unsigned char* out, int offset, __m128i v) {
     WriteLE32(out + 96 + offset, _mm_extract_epi32(v, 0));
 }
 
-}
-
-void Transform_4way(unsigned char* out, const unsigned char* in)
+/** Transform 1: compress one 64-byte block per lane from the initial state (a..h: the SHA256 state). */
+void inline __attribute__((always_inline)) TransformBlock(__m128i& a, __m128i& b, __m128i& c, __m128i& d, __m128i& e, __m128i& f, __m128i& g, __m128i& h, const unsigned char* in)
 {
-    // Transform 1
-    __m128i a = K(0x6a09e667ul);
-    __m128i b = K(0xbb67ae85ul);
-    __m128i c = K(0x3c6ef372ul);
-    __m128i d = K(0xa54ff53aul);
-    __m128i e = K(0x510e527ful);
-    __m128i f = K(0x9b05688cul);
-    __m128i g = K(0x1f83d9abul);
-    __m128i h = K(0x5be0cd19ul);
+    a = K(0x6a09e667ul);
+    b = K(0xbb67ae85ul);
+    c = K(0x3c6ef372ul);
+    d = K(0xa54ff53aul);
+    e = K(0x510e527ful);
+    f = K(0x9b05688cul);
+    g = K(0x1f83d9abul);
+    h = K(0x5be0cd19ul);
 
     __m128i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
 
@@ -150,93 +148,20 @@ void Transform_4way(unsigned char* out, const unsigned char* in)
     f = Add(f, K(0x9b05688cul));
     g = Add(g, K(0x1f83d9abul));
     h = Add(h, K(0x5be0cd19ul));
+}
 
-    __m128i t0 = a, t1 = b, t2 = c, t3 = d, t4 = e, t5 = f, t6 = g, t7 = h;
-
-    // Transform 2
-    Round(a, b, c, d, e, f, g, h, K(0xc28a2f98ul));
-    Round(h, a, b, c, d, e, f, g, K(0x71374491ul));
-    Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcful));
-    Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5ul));
-    Round(e, f, g, h, a, b, c, d, K(0x3956c25bul));
-    Round(d, e, f, g, h, a, b, c, K(0x59f111f1ul));
-    Round(c, d, e, f, g, h, a, b, K(0x923f82a4ul));
-    Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5ul));
-    Round(a, b, c, d, e, f, g, h, K(0xd807aa98ul));
-    Round(h, a, b, c, d, e, f, g, K(0x12835b01ul));
-    Round(g, h, a, b, c, d, e, f, K(0x243185beul));
-    Round(f, g, h, a, b, c, d, e, K(0x550c7dc3ul));
-    Round(e, f, g, h, a, b, c, d, K(0x72be5d74ul));
-    Round(d, e, f, g, h, a, b, c, K(0x80deb1feul));
-    Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7ul));
-    Round(b, c, d, e, f, g, h, a, K(0xc19bf374ul));
-    Round(a, b, c, d, e, f, g, h, K(0x649b69c1ul));
-    Round(h, a, b, c, d, e, f, g, K(0xf0fe4786ul));
-    Round(g, h, a, b, c, d, e, f, K(0x0fe1edc6ul));
-    Round(f, g, h, a, b, c, d, e, K(0x240cf254ul));
-    Round(e, f, g, h, a, b, c, d, K(0x4fe9346ful));
-    Round(d, e, f, g, h, a, b, c, K(0x6cc984beul));
-    Round(c, d, e, f, g, h, a, b, K(0x61b9411eul));
-    Round(b, c, d, e, f, g, h, a, K(0x16f988faul));
-    Round(a, b, c, d, e, f, g, h, K(0xf2c65152ul));
-    Round(h, a, b, c, d, e, f, g, K(0xa88e5a6dul));
-    Round(g, h, a, b, c, d, e, f, K(0xb019fc65ul));
-    Round(f, g, h, a, b, c, d, e, K(0xb9d99ec7ul));
-    Round(e, f, g, h, a, b, c, d, K(0x9a1231c3ul));
-    Round(d, e, f, g, h, a, b, c, K(0xe70eeaa0ul));
-    Round(c, d, e, f, g, h, a, b, K(0xfdb1232bul));
-    Round(b, c, d, e, f, g, h, a, K(0xc7353eb0ul));
-    Round(a, b, c, d, e, f, g, h, K(0x3069bad5ul));
-    Round(h, a, b, c, d, e, f, g, K(0xcb976d5ful));
-    Round(g, h, a, b, c, d, e, f, K(0x5a0f118ful));
-    Round(f, g, h, a, b, c, d, e, K(0xdc1eeefdul));
-    Round(e, f, g, h, a, b, c, d, K(0x0a35b689ul));
-    Round(d, e, f, g, h, a, b, c, K(0xde0b7a04ul));
-    Round(c, d, e, f, g, h, a, b, K(0x58f4ca9dul));
-    Round(b, c, d, e, f, g, h, a, K(0xe15d5b16ul));
-    Round(a, b, c, d, e, f, g, h, K(0x007f3e86ul));
-    Round(h, a, b, c, d, e, f, g, K(0x37088980ul));
-    Round(g, h, a, b, c, d, e, f, K(0xa507ea32ul));
-    Round(f, g, h, a, b, c, d, e, K(0x6fab9537ul));
-    Round(e, f, g, h, a, b, c, d, K(0x17406110ul));
-    Round(d, e, f, g, h, a, b, c, K(0x0d8cd6f1ul));
-    Round(c, d, e, f, g, h, a, b, K(0xcdaa3b6dul));
-    Round(b, c, d, e, f, g, h, a, K(0xc0bbbe37ul));
-    Round(a, b, c, d, e, f, g, h, K(0x83613bdaul));
-    Round(h, a, b, c, d, e, f, g, K(0xdb48a363ul));
-    Round(g, h, a, b, c, d, e, f, K(0x0b02e931ul));
-    Round(f, g, h, a, b, c, d, e, K(0x6fd15ca7ul));
-    Round(e, f, g, h, a, b, c, d, K(0x521afacaul));
-    Round(d, e, f, g, h, a, b, c, K(0x31338431ul));
-    Round(c, d, e, f, g, h, a, b, K(0x6ed41a95ul));
-    Round(b, c, d, e, f, g, h, a, K(0x6d437890ul));
-    Round(a, b, c, d, e, f, g, h, K(0xc39c91f2ul));
-    Round(h, a, b, c, d, e, f, g, K(0x9eccabbdul));
-    Round(g, h, a, b, c, d, e, f, K(0xb5c9a0e6ul));
-    Round(f, g, h, a, b, c, d, e, K(0x532fb63cul));
-    Round(e, f, g, h, a, b, c, d, K(0xd2c741c6ul));
-    Round(d, e, f, g, h, a, b, c, K(0x07237ea3ul));
-    Round(c, d, e, f, g, h, a, b, K(0xa4954b68ul));
-    Round(b, c, d, e, f, g, h, a, K(0x4c191d76ul));
-
-    w0 = Add(t0, a);
-    w1 = Add(t1, b);
-    w2 = Add(t2, c);
-    w3 = Add(t3, d);
-    w4 = Add(t4, e);
-    w5 = Add(t5, f);
-    w6 = Add(t6, g);
-    w7 = Add(t7, h);
-
-    // Transform 3
-    a = K(0x6a09e667ul);
-    b = K(0xbb67ae85ul);
-    c = K(0x3c6ef372ul);
-    d = K(0xa54ff53aul);
-    e = K(0x510e527ful);
-    f = K(0x9b05688cul);
-    g = K(0x1f83d9abul);
-    h = K(0x5be0cd19ul);
+/** Transform 3: out = SHA256 of the 32-byte message w0..w7 in each lane. */
+void inline __attribute__((always_inline)) TransformHash(unsigned char* out, __m128i w0, __m128i w1, __m128i w2, __m128i w3, __m128i w4, __m128i w5, __m128i w6, __m128i w7)
+{
+    __m128i a = K(0x6a09e667ul);
+    __m128i b = K(0xbb67ae85ul);
+    __m128i c = K(0x3c6ef372ul);
+    __m128i d = K(0xa54ff53aul);
+    __m128i e = K(0x510e527ful);
+    __m128i f = K(0x9b05688cul);
+    __m128i g = K(0x1f83d9abul);
+    __m128i h = K(0x5be0cd19ul);
+    __m128i w8, w9, w10, w11, w12, w13, w14, w15;
 
     Round(a, b, c, d, e, f, g, h, Add(K(0x428a2f98ul), w0));
     Round(h, a, b, c, d, e, f, g, Add(K(0x71374491ul), w1));
@@ -316,6 +241,93 @@ void Transform_4way(unsigned char* out, const unsigned char* in)
 
 }
 
+void Transform_4way(unsigned char* out, const unsigned char* in)
+{
+    // Transform 1
+    __m128i a, b, c, d, e, f, g, h;
+    TransformBlock(a, b, c, d, e, f, g, h, in);
+
+    __m128i t0 = a, t1 = b, t2 = c, t3 = d, t4 = e, t5 = f, t6 = g, t7 = h;
+
+    // Transform 2
+    Round(a, b, c, d, e, f, g, h, K(0xc28a2f98ul));
+    Round(h, a, b, c, d, e, f, g, K(0x71374491ul));
+    Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcful));
+    Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5ul));
+    Round(e, f, g, h, a, b, c, d, K(0x3956c25bul));
+    Round(d, e, f, g, h, a, b, c, K(0x59f111f1ul));
+    Round(c, d, e, f, g, h, a, b, K(0x923f82a4ul));
+    Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5ul));
+    Round(a, b, c, d, e, f, g, h, K(0xd807aa98ul));
+    Round(h, a, b, c, d, e, f, g, K(0x12835b01ul));
+    Round(g, h, a, b, c, d, e, f, K(0x243185beul));
+    Round(f, g, h, a, b, c, d, e, K(0x550c7dc3ul));
+    Round(e, f, g, h, a, b, c, d, K(0x72be5d74ul));
+    Round(d, e, f, g, h, a, b, c, K(0x80deb1feul));
+    Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7ul));
+    Round(b, c, d, e, f, g, h, a, K(0xc19bf374ul));
+    Round(a, b, c, d, e, f, g, h, K(0x649b69c1ul));
+    Round(h, a, b, c, d, e, f, g, K(0xf0fe4786ul));
+    Round(g, h, a, b, c, d, e, f, K(0x0fe1edc6ul));
+    Round(f, g, h, a, b, c, d, e, K(0x240cf254ul));
+    Round(e, f, g, h, a, b, c, d, K(0x4fe9346ful));
+    Round(d, e, f, g, h, a, b, c, K(0x6cc984beul));
+    Round(c, d, e, f, g, h, a, b, K(0x61b9411eul));
+    Round(b, c, d, e, f, g, h, a, K(0x16f988faul));
+    Round(a, b, c, d, e, f, g, h, K(0xf2c65152ul));
+    Round(h, a, b, c, d, e, f, g, K(0xa88e5a6dul));
+    Round(g, h, a, b, c, d, e, f, K(0xb019fc65ul));
+    Round(f, g, h, a, b, c, d, e, K(0xb9d99ec7ul));
+    Round(e, f, g, h, a, b, c, d, K(0x9a1231c3ul));
+    Round(d, e, f, g, h, a, b, c, K(0xe70eeaa0ul));
+    Round(c, d, e, f, g, h, a, b, K(0xfdb1232bul));
+    Round(b, c, d, e, f, g, h, a, K(0xc7353eb0ul));
+    Round(a, b, c, d, e, f, g, h, K(0x3069bad5ul));
+    Round(h, a, b, c, d, e, f, g, K(0xcb976d5ful));
+    Round(g, h, a, b, c, d, e, f, K(0x5a0f118ful));
+    Round(f, g, h, a, b, c, d, e, K(0xdc1eeefdul));
+    Round(e, f, g, h, a, b, c, d, K(0x0a35b689ul));
+    Round(d, e, f, g, h, a, b, c, K(0xde0b7a04ul));
+    Round(c, d, e, f, g, h, a, b, K(0x58f4ca9dul));
+    Round(b, c, d, e, f, g, h, a, K(0xe15d5b16ul));
+    Round(a, b, c, d, e, f, g, h, K(0x007f3e86ul));
+    Round(h, a, b, c, d, e, f, g, K(0x37088980ul));
+    Round(g, h, a, b, c, d, e, f, K(0xa507ea32ul));
+    Round(f, g, h, a, b, c, d, e, K(0x6fab9537ul));
+    Round(e, f, g, h, a, b, c, d, K(0x17406110ul));
+    Round(d, e, f, g, h, a, b, c, K(0x0d8cd6f1ul));
+    Round(c, d, e, f, g, h, a, b, K(0xcdaa3b6dul));
+    Round(b, c, d, e, f, g, h, a, K(0xc0bbbe37ul));
+    Round(a, b, c, d, e, f, g, h, K(0x83613bdaul));
+    Round(h, a, b, c, d, e, f, g, K(0xdb48a363ul));
+    Round(g, h, a, b, c, d, e, f, K(0x0b02e931ul));
+    Round(f, g, h, a, b, c, d, e, K(0x6fd15ca7ul));
+    Round(e, f, g, h, a, b, c, d, K(0x521afacaul));
+    Round(d, e, f, g, h, a, b, c, K(0x31338431ul));
+    Round(c, d, e, f, g, h, a, b, K(0x6ed41a95ul));
+    Round(b, c, d, e, f, g, h, a, K(0x6d437890ul));
+    Round(a, b, c, d, e, f, g, h, K(0xc39c91f2ul));
+    Round(h, a, b, c, d, e, f, g, K(0x9eccabbdul));
+    Round(g, h, a, b, c, d, e, f, K(0xb5c9a0e6ul));
+    Round(f, g, h, a, b, c, d, e, K(0x532fb63cul));
+    Round(e, f, g, h, a, b, c, d, K(0xd2c741c6ul));
+    Round(d, e, f, g, h, a, b, c, K(0x07237ea3ul));
+    Round(c, d, e, f, g, h, a, b, K(0xa4954b68ul));
+    Round(b, c, d, e, f, g, h, a, K(0x4c191d76ul));
+
+    // Transform 3
+    TransformHash(out, Add(t0, a), Add(t1, b), Add(t2, c), Add(t3, d), Add(t4, e), Add(t5, f), Add(t6, g), Add(t7, h));
+}
+
+void TransformDBlock_4way(unsigned char* out, const unsigned char* in)
+{
+    __m128i a, b, c, d, e, f, g, h;
+    TransformBlock(a, b, c, d, e, f, g, h, in);
+    TransformHash(out, a, b, c, d, e, f, g, h);
+}
+
+}
+
 } // namespace latest_crypto
 
 #endif
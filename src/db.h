@@ -866,6 +866,29 @@ public:
         return std::move(const_iterator());
     }
 
+    bool IsReadOnly() const noexcept {
+        return fReadOnly;
+    }
+
+    //
+    // Independent iterator for read-only range scans from worker threads.
+    // leveldb::DB is thread-safe, so cs_db is not held; the caller deletes the iterator.
+    // A bulk scan does not fill the block cache.
+    //
+    template <typename KEY, typename VALUE>
+    leveldb::Iterator *NewIterator(const KEY &key, const VALUE &val) const noexcept {
+        assert(fSecure==false);
+        leveldb::ReadOptions options;
+        options.fill_cache = false;
+        leveldb::Iterator *it = pdb->NewIterator(options);
+        if(! it)
+            return nullptr;
+        CDataStream ssStartKey(0, 0);
+        ssStartKey << std::make_pair(key, val);
+        it->Seek(ssStartKey.str());
+        return it;
+    }
+
 public:
     explicit CLevelDB(const std::string &strDb, const char *pszMode /*= "r+"*/, bool fSecureIn = false); // open LevelDB
     virtual ~CLevelDB();
@@ -0,0 +1,137 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <file_operate/block_mmap.h>
+#include <file_operate/iofs.h>
+#include <util/logging.h>
+#include <util/tinyformat.h>
+#include <cerrno>
+
+#ifndef WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+CCriticalSection block_mmap::cs;
+std::map<unsigned int, std::shared_ptr<CBlockFileMapping> > block_mmap::mapFiles;
+#if defined(WIN32) || (defined(UINTPTR_MAX) && UINTPTR_MAX <= 0xFFFFFFFFu)
+bool block_mmap::fEnabled = false; // no mmap on Windows; 32-bit address space is too small
+#else
+bool block_mmap::fEnabled = true;
+#endif
+
+CBlockFileMapping::~CBlockFileMapping() {
+#ifndef WIN32
+    if (pbase)
+        ::munmap(const_cast<char *>(pbase), nMapped);
+    if (fd >= 0)
+        ::close(fd);
+#endif
+}
+
+size_t CBlockFileMapping::readable() const noexcept {
+    size_t nSize = nValid.load();
+#ifndef WIN32
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+        return 0;
+    if ((size_t)st.st_size < nSize)
+        nSize = (size_t)st.st_size;
+#endif
+    return nSize;
+}
+
+void block_mmap::SetEnabled(bool fEnable) {
+    LOCK(cs);
+#if defined(WIN32) || (defined(UINTPTR_MAX) && UINTPTR_MAX <= 0xFFFFFFFFu)
+    fEnable = false;
+#endif
+    fEnabled = fEnable;
+    if (! fEnabled)
+        mapFiles.clear();
+}
+
+// Note: cs must be held
+std::shared_ptr<CBlockFileMapping> block_mmap::Map(unsigned int nFile) {
+#ifdef WIN32
+    return std::shared_ptr<CBlockFileMapping>();
+#else
+    const fs::path path = iofs::GetDataDir() / tfm::format("blk%04u.dat", nFile);
+    int fd = ::open(path.string().c_str(), O_RDONLY);
+    if (fd < 0)
+        return std::shared_ptr<CBlockFileMapping>();
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return std::shared_ptr<CBlockFileMapping>();
+    }
+
+    const size_t nValid = (size_t)st.st_size;
+    const size_t nMapped = nValid + MAP_RESERVE;
+    void *p = ::mmap(nullptr, nMapped, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        logging::LogPrintf("block_mmap::Map() : mmap %s failed (errno=%d)\n", path.string().c_str(), errno);
+        ::close(fd);
+        return std::shared_ptr<CBlockFileMapping>();
+    }
+# ifdef MADV_RANDOM
+    ::madvise(p, nMapped, MADV_RANDOM); // tx reads jump around; let the page cache decide
+# endif
+    return std::make_shared<CBlockFileMapping>(fd, (const char *)p, nMapped, nValid);
+#endif
+}
+
+std::shared_ptr<const CBlockFileMapping> block_mmap::Get(unsigned int nFile, size_t nPos) {
+    if ((nFile < 1) || (nFile == std::numeric_limits<uint32_t>::max()))
+        return std::shared_ptr<const CBlockFileMapping>();
+
+    LOCK(cs);
+    if (! fEnabled)
+        return std::shared_ptr<const CBlockFileMapping>();
+
+    std::map<unsigned int, std::shared_ptr<CBlockFileMapping> >::iterator mi = mapFiles.find(nFile);
+    if (mi != mapFiles.end()) {
+        std::shared_ptr<CBlockFileMapping> &pmap = mi->second;
+        if (nPos < pmap->size())
+            return pmap;
+
+#ifndef WIN32
+        // The file may have grown without NotifyAppend (e.g. before the writer reported it)
+        struct stat st;
+        if (::fstat(pmap->get_fd(), &st) == 0 && (size_t)st.st_size > pmap->size() && (size_t)st.st_size <= pmap->capacity()) {
+            pmap->set_size((size_t)st.st_size);
+            if (nPos < pmap->size())
+                return pmap;
+        }
+#endif
+        mapFiles.erase(mi); // readers still holding the old mapping keep it alive
+    }
+
+    std::shared_ptr<CBlockFileMapping> pmap = Map(nFile);
+    if (! pmap || nPos >= pmap->size())
+        return std::shared_ptr<const CBlockFileMapping>();
+
+    mapFiles[nFile] = pmap;
+    return pmap;
+}
+
+void block_mmap::NotifyAppend(unsigned int nFile, size_t nEnd) {
+    LOCK(cs);
+    std::map<unsigned int, std::shared_ptr<CBlockFileMapping> >::iterator mi = mapFiles.find(nFile);
+    if (mi == mapFiles.end())
+        return;
+    if (nEnd <= mi->second->capacity()) {
+        if (nEnd > mi->second->size())
+            mi->second->set_size(nEnd);
+    } else
+        mapFiles.erase(mi); // out of reserved address space: re-map on the next read
+}
+
+void block_mmap::CloseAll() {
+    LOCK(cs);
+    mapFiles.clear();
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_BLOCK_MMAP_H
+#define SORACHANCOIN_BLOCK_MMAP_H
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <serialize.h>
+#include <sync/sync.h>
+#include <const/no_instance.h>
+
+// Read-only mapping of one block file (blkNNNN.dat)
+// The mapping reserves address space beyond the end of the file, so appends
+// to the active file only move nValid forward; bytes past nValid are never read.
+class CBlockFileMapping
+{
+    CBlockFileMapping(const CBlockFileMapping &)=delete;
+    CBlockFileMapping(CBlockFileMapping &&)=delete;
+    CBlockFileMapping &operator=(const CBlockFileMapping &)=delete;
+    CBlockFileMapping &operator=(CBlockFileMapping &&)=delete;
+private:
+    int fd;
+    const char *pbase;
+    size_t nMapped;
+    std::atomic<size_t> nValid;
+public:
+    CBlockFileMapping(int fdIn, const char *pbaseIn, size_t nMappedIn, size_t nValidIn) noexcept :
+        fd(fdIn), pbase(pbaseIn), nMapped(nMappedIn), nValid(nValidIn) {}
+    ~CBlockFileMapping();
+
+    const char *begin() const noexcept {return pbase;}
+    size_t size() const noexcept {return nValid.load();}
+    // size(), cut to the current file size if the file was truncated: a read past
+    // the end of the file through the mapping raises SIGBUS instead of an error
+    size_t readable() const noexcept;
+    size_t capacity() const noexcept {return nMapped;}
+    int get_fd() const noexcept {return fd;}
+    void set_size(size_t nValidIn) noexcept {nValid.store(nValidIn);}
+};
+
+// Deserializer that reads straight from a block file mapping (no stdio, no copy of the file)
+// It holds a reference to the mapping, so the file stays mapped while it is in use.
+// Reads stop at readable() as of construction; callers fall back to stdio on failure.
+class CSpanReader final : public CTypeVersion
+{
+    CSpanReader()=delete;
+    CSpanReader(const CSpanReader &)=delete;
+    CSpanReader &operator=(const CSpanReader &)=delete;
+private:
+    std::shared_ptr<const CBlockFileMapping> pmap;
+    const char *pcur;
+    const char *pend;
+public:
+    CSpanReader(std::shared_ptr<const CBlockFileMapping> pmapIn, size_t nPos, int nType, int nVersion) noexcept :
+        CTypeVersion(nType, nVersion), pmap(pmapIn) {
+        const size_t nSize = pmap->readable();
+        pcur = pmap->begin() + std::min(nPos, nSize);
+        pend = pmap->begin() + nSize;
+    }
+
+    CSpanReader &read(char *pch, size_t nSize) {
+        if ((size_t)(pend - pcur) < nSize)
+            throw std::ios_base::failure("CSpanReader::read : end of data");
+        std::memcpy(pch, pcur, nSize);
+        pcur += nSize;
+        return *this;
+    }
+
+    CSpanReader &seek(size_t nPos) {
+        if (nPos > (size_t)(pend - pmap->begin()))
+            throw std::ios_base::failure("CSpanReader::seek : out of range");
+        pcur = pmap->begin() + nPos;
+        return *this;
+    }
+
+    size_t tell() const noexcept {
+        return pcur - pmap->begin();
+    }
+
+    template<typename T>
+    CSpanReader &operator>>(T &obj) {
+        ::Unserialize(*this, obj);
+        return *this;
+    }
+};
+
+// Reference-counted pool of block file mappings
+// Readers that get nullptr (mapping disabled or failed) fall back to file_open::OpenBlockFile.
+class block_mmap : private no_instance
+{
+private:
+    static CCriticalSection cs;
+    static std::map<unsigned int, std::shared_ptr<CBlockFileMapping> > mapFiles;
+    static bool fEnabled;
+
+    static std::shared_ptr<CBlockFileMapping> Map(unsigned int nFile);
+public:
+    static constexpr size_t MAP_RESERVE = 64 * 1024 * 1024; // address space kept for appends
+
+    static void SetEnabled(bool fEnable);
+    static bool IsEnabled() {return fEnabled;}
+
+    // mapping that covers nPos (the file size is re-checked if nPos is beyond the known end)
+    static std::shared_ptr<const CBlockFileMapping> Get(unsigned int nFile, size_t nPos);
+
+    // the writer appended to nFile; its data now ends at nEnd
+    static void NotifyAppend(unsigned int nFile, size_t nEnd);
+
+    // drop all mappings (block files are removed or replaced)
+    static void CloseAll();
+};
+
+#endif // SORACHANCOIN_BLOCK_MMAP_H
@@ -0,0 +1,142 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <file_operate/block_store.h>
+#include <file_operate/block_mmap.h>
+#include <file_operate/file_open.h>
+#include <file_operate/iofs.h>
+#include <util/time.h>
+
+#ifdef WIN32
+# include <io.h>
+#else
+# include <fcntl.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+CCriticalSection block_store::cs;
+FILE *block_store::fileActive = nullptr;
+unsigned int block_store::nFileActive = 0;
+uint64_t block_store::nPosActive = 0;
+uint64_t block_store::nAllocated = 0;
+uint64_t block_store::nUnsyncedBytes = 0;
+int64_t block_store::nLastSync = 0;
+uint64_t block_store::nSyncBytes = (uint64_t)block_store::DEFAULT_SYNC_MB << 20;
+int64_t block_store::nSyncInterval = block_store::DEFAULT_SYNC_INTERVAL;
+
+static int64_t block_store_tell_end(FILE *file) {
+#ifdef WIN32
+    if (::_fseeki64(file, 0, SEEK_END) != 0)
+        return -1;
+    return ::_ftelli64(file);
+#else
+    if (::fseeko(file, 0, SEEK_END) != 0)
+        return -1;
+    return (int64_t)::ftello(file);
+#endif
+}
+
+void block_store::SetSyncPolicy(int nMiB, int nSeconds) {
+    LOCK(cs);
+    nSyncBytes = (uint64_t)std::max(nMiB, 1) << 20;
+    nSyncInterval = std::max(nSeconds, 1);
+}
+
+// Note: cs must be held
+bool block_store::OpenActive(uint64_t nNeed) {
+    if (fileActive && nPosActive + nNeed <= MAX_BLOCKFILE_SIZE)
+        return true;
+
+    if (fileActive) {
+        CloseActive();
+        ++nFileActive;
+    }
+    if (nFileActive == 0)
+        nFileActive = 1;
+
+    for (;;) {
+        FILE *file = file_open::OpenBlockFile(nFileActive, 0, "ab");
+        if (! file)
+            return false;
+        const int64_t nEnd = block_store_tell_end(file);
+        if (nEnd < 0) {
+            ::fclose(file);
+            return false;
+        }
+        if ((uint64_t)nEnd + nNeed <= MAX_BLOCKFILE_SIZE) {
+            fileActive = file;
+            nPosActive = (uint64_t)nEnd;
+            nAllocated = nPosActive;
+            nLastSync = util::GetTime();
+            return true;
+        }
+        ::fclose(file);
+        ++nFileActive;
+    }
+}
+
+// Note: cs must be held
+void block_store::CloseActive() {
+    if (fileActive) {
+        iofs::FileCommit(fileActive);
+        ::fclose(fileActive);
+    }
+    fileActive = nullptr;
+    nPosActive = 0;
+    nAllocated = 0;
+    nUnsyncedBytes = 0;
+}
+
+// Reserve disk blocks ahead of the appends without changing the file size,
+// so appending, the file-size based restart logic and block_mmap stay as they are.
+// Note: cs must be held
+void block_store::Preallocate(uint64_t nEnd) {
+    if (nEnd <= nAllocated)
+        return;
+
+    uint64_t nNewAllocated = std::min(((nEnd + PREALLOCATE_CHUNK - 1) / PREALLOCATE_CHUNK) * PREALLOCATE_CHUNK, MAX_BLOCKFILE_SIZE);
+    if (nNewAllocated < nEnd)
+        nNewAllocated = nEnd;
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    ::fallocate(::fileno(fileActive), FALLOC_FL_KEEP_SIZE, (off_t)nAllocated, (off_t)(nNewAllocated - nAllocated));
+#elif defined(MAC_OSX) && defined(F_PREALLOCATE)
+    fstore_t fst;
+    fst.fst_flags = F_ALLOCATECONTIG;
+    fst.fst_posmode = F_PEOFPOSMODE;
+    fst.fst_offset = 0;
+    fst.fst_length = (off_t)(nNewAllocated - nAllocated);
+    fst.fst_bytesalloc = 0;
+    if (::fcntl(::fileno(fileActive), F_PREALLOCATE, &fst) == -1) {
+        fst.fst_flags = F_ALLOCATEALL;
+        ::fcntl(::fileno(fileActive), F_PREALLOCATE, &fst);
+    }
+#endif
+    nAllocated = nNewAllocated; // best effort: a failed preallocation only costs fragmentation
+}
+
+// Note: cs must be held
+void block_store::Sync() {
+    if (fileActive)
+        iofs::FileCommit(fileActive);
+    nUnsyncedBytes = 0;
+    nLastSync = util::GetTime();
+}
+
+// Note: cs must be held
+void block_store::Written(uint64_t nBytes, bool fInitialDownload) {
+    block_mmap::NotifyAppend(nFileActive, (size_t)nPosActive);
+
+    // Outside initial download every block is committed before it is indexed.
+    // During initial download fsyncs are grouped by bytes written and by time.
+    nUnsyncedBytes += nBytes;
+    if (!fInitialDownload || nUnsyncedBytes >= nSyncBytes || util::GetTime() - nLastSync >= nSyncInterval)
+        Sync();
+}
+
+void block_store::Flush() {
+    LOCK(cs);
+    CloseActive();
+    nFileActive = 0; // rescan from blk0001.dat when writing again
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_BLOCK_STORE_H
+#define SORACHANCOIN_BLOCK_STORE_H
+
+#include <stdio.h>
+#include <serialize.h>
+#include <version.h>
+#include <sync/sync.h>
+#include <const/no_instance.h>
+#include <util/logging.h>
+
+// Block file writer
+// Keeps the active blkNNNN.dat open for appending, tracks the write position as a
+// 64-bit offset instead of asking ftell, preallocates the file in chunks and groups
+// fsyncs during initial block download by time and by bytes written.
+//
+// Note: CDiskTxPos and CDiskBlockIndex store positions as uint32 in the tx index
+// database, so a block file still ends below MAX_BLOCKFILE_SIZE. Widening those
+// fields needs a DATABASE_VERSION bump and a reindex.
+class block_store : private no_instance
+{
+private:
+    static CCriticalSection cs;
+    static FILE *fileActive;
+    static unsigned int nFileActive;
+    static uint64_t nPosActive;       // end of the data in the active file
+    static uint64_t nAllocated;       // preallocated up to here (file size is not changed)
+    static uint64_t nUnsyncedBytes;
+    static int64_t nLastSync;
+    static uint64_t nSyncBytes;
+    static int64_t nSyncInterval;
+
+    static bool OpenActive(uint64_t nNeed);
+    static void CloseActive();
+    static void Preallocate(uint64_t nEnd);
+    static void Sync();
+    static void Written(uint64_t nBytes, bool fInitialDownload);
+public:
+    static constexpr uint64_t MAX_BLOCKFILE_SIZE = (uint64_t)0x7F000000 - compact_size::MAX_SIZE;
+    static constexpr uint64_t PREALLOCATE_CHUNK = 16 * 1024 * 1024;
+    static constexpr int DEFAULT_SYNC_MB = 64;
+    static constexpr int DEFAULT_SYNC_INTERVAL = 30; // seconds
+
+    // IBD fsync policy: -blocksyncmb=<n>, -blocksyncinterval=<n>
+    static void SetSyncPolicy(int nMiB, int nSeconds);
+
+    // Append one block record (message start, size, block) to the active file.
+    template <typename BLOCK>
+    static bool Write(const BLOCK &block, const unsigned char pchMessageStart[4], unsigned int &nFileRet, unsigned int &nBlockPosRet, bool fInitialDownload) {
+        LOCK(cs);
+        const unsigned int nSize = ::GetSerializeSize(block);
+        const uint64_t nRecord = 4 + sizeof(nSize) + nSize;
+        if (! OpenActive(nRecord))
+            return logging::error("block_store::Write() : no block file available");
+
+        Preallocate(nPosActive + nRecord);
+        try {
+            CAutoFile fileout(fileActive, SER_DISK, version::CLIENT_VERSION);
+            fileout.write((const char *)pchMessageStart, 4);
+            fileout << nSize;
+            fileout << block;
+            fileout.release(); // the active file stays open
+        } catch (const std::exception &e) {
+            fileActive = nullptr; // closed by ~CAutoFile
+            CloseActive(); // the position is unknown now: reopen and take it from the file size
+            return logging::error("block_store::Write() : %s", e.what());
+        }
+
+        // readers (stdio and block_mmap) must see the block before it is indexed
+        if (::fflush(fileActive) != 0) {
+            CloseActive();
+            return logging::error("block_store::Write() : fflush failed");
+        }
+
+        nFileRet = nFileActive;
+        nBlockPosRet = (unsigned int)(nPosActive + 4 + sizeof(nSize));
+        nPosActive += nRecord;
+        Written(nRecord, fInitialDownload);
+        return true;
+    }
+
+    // fsync and close the active file (shutdown)
+    static void Flush();
+};
+
+#endif // SORACHANCOIN_BLOCK_STORE_H
@@ -52,25 +52,6 @@ public:
         }
         return true;
     }
-    static FILE *AppendBlockFile(unsigned int &nFileRet) {
-        static CCriticalSection cs;
-        static unsigned int nCurrentBlockFile = 1;
-        LOCK(cs);
-        nFileRet = 0;
-        for (;;) {
-            FILE *file = file_open::OpenBlockFile(nCurrentBlockFile, 0, "ab");
-            if (! file) return nullptr;
-            if (::fseek(file, 0, SEEK_END) != 0) return nullptr;
-
-            // FAT32 file size max 4GB, fseek and ftell max 2GB, so we must stay under 2GB
-            if (ftell(file) < (long)(0x7F000000 - compact_size::MAX_SIZE)) {
-                nFileRet = nCurrentBlockFile;
-                return file;
-            }
-            ::fclose(file);
-            ++nCurrentBlockFile;
-        }
-    }
 };
 
 #endif
@@ -17,6 +17,9 @@
 #include <boot/shutdown.h>
 #include <block/block_process.h>
 #include <block/block_check.h>
+#include <block/prevout_cache.h>
+#include <file_operate/block_mmap.h>
+#include <file_operate/block_store.h>
 #include <quantum/quantum.h>
 #include <prime/autocheckpoint.h>
 #include <boost/format.hpp>
@@ -26,6 +29,7 @@
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <openssl/crypto.h>
+#include <crypto/sha256.h>
 #include <util/time.h>
 #include <util/logging.h>
 #include <util/thread.h>
@@ -34,6 +38,9 @@
 #include <const/net_processing.h>
 #include <const/net_params.h>
 #include <util/system.h>
+#include <block/block_index_snapshot.h>
+#include <key/pubkey.h>
+#include <script/sigcache.h>
 
 #ifndef WIN32
 # include <signal.h>
@@ -83,6 +90,12 @@ void boot::Shutdown(void *parg)
         // CTxDB().Close();
         CDBEnv::get_instance().Flush(false);
         net_node::StopNode();
+        block_store::Flush();
+        if (block_index_snapshot::IsEnabled()) {
+            LOCK(block_process::cs_main);
+            CTxDB txdb;
+            block_index_snapshot::Write(txdb, block_info::mapBlockIndex, block_info::hashBestChain);
+        }
         CDBEnv::get_instance().Flush(true);
         boost::filesystem::remove(iofs::GetPidFile());
 
@@ -471,6 +484,12 @@ std::string entry::HelpMessage()
         "  -datadir=<dir>         " + _("Specify data directory") + "\n" +
         "  -wallet=<file>         " + _("Specify wallet file (within data directory)") + "\n" +
         "  -dbcache=<n>           " + _("Set database cache size in megabytes (default: 25)") + "\n" +
+        "  -prevoutcache=<n>      " + _("Set the in-memory prevout (tx index) cache size in megabytes (default: 64)") + "\n" +
+        "  -maxsigcachesize=<n>   " + _("Limit the sum of the signature cache and script execution cache sizes to <n> megabytes (default: 32)") + "\n" +
+        "  -blockmmap             " + _("Read block files through memory mappings (default: 1)") + "\n" +
+        "  -blocksyncmb=<n>       " + _("During initial download, fsync block files after <n> megabytes written (default: 64)") + "\n" +
+        "  -blocksyncinterval=<n> " + _("During initial download, fsync block files at least every <n> seconds (default: 30)") + "\n" +
+        "  -indexsnapshot         " + _("Write the block index to a snapshot file on shutdown and load it on startup (default: 0)") + "\n" +
         "  -dblogsize=<n>         " + _("Set database disk log size in megabytes (default: 100)") + "\n" +
         "  -timeout=<n>           " + _("Specify connection timeout in milliseconds (default: 5000)") + "\n" +
         "  -proxy=<ip:port>       " + _("Connect through socks proxy") + "\n" +
@@ -480,6 +499,7 @@ std::string entry::HelpMessage()
         "  -dns                   " + _("Allow DNS lookups for -addnode, -seednode and -connect") + "\n" +
         "  -port=<port>           " + _("Listen for connections on <port> (default: 21587 or testnet: 31587)") + "\n" +
         "  -maxconnections=<n>    " + _("Maintain at most <n> connections to peers (default: 125)") + "\n" +
+        "  -netpoll=<method>      " + _("Wait for socket events with epoll or select (default: epoll where available)") + "\n" +
         "  -addnode=<ip>          " + _("Add a node to connect to and attempt to keep the connection open") + "\n" +
         "  -connect=<ip>          " + _("Connect only to the specified node(s)") + "\n" +
         "  -seednode=<ip>         " + _("Connect to a node to retrieve peer addresses, and disconnect") + "\n" +
@@ -548,6 +568,7 @@ std::string entry::HelpMessage()
         "  -blockminsize=<n>      "   + _("Set minimum block size in bytes (default: 0)") + "\n" +
         "  -blockmaxsize=<n>      "   + _("Set maximum block size in bytes (default: 250000)") + "\n" +
         "  -blockprioritysize=<n> "   + _("Set maximum size of high-priority/low-fee transactions in bytes (default: 27000)") + "\n" +
+        "  -stakeminerthreads=<n> "   + _("Set the number of stake miner kernel workers (0 = all cores, default: 1)") + "\n" +
 
         "\n" + _("SSL options: (see the Bitcoin Wiki for SSL setup instructions)") + "\n" +
         "  -rpcssl                                  " + _("Use OpenSSL (https) for JSON-RPC connections") + "\n" +
@@ -710,6 +731,9 @@ bool entry::AppInit2(bool restart/*=false*/)
         OpenDebugFile();
     }
 
+    // Select the SHA256 kernels (SHA-NI, SSE4.1, AVX2) used by SHA256D64 for Merkle trees
+    logging::LogPrintf("Using the '%s' SHA256 implementation\n", latest_crypto::SHA256AutoDetect().c_str());
+
     // ********************************************************* Step 3: parameter-to-internal-flags
     I_DEBUG_CS("Step 3: parameter-to-internal-flags")
 
@@ -727,6 +751,12 @@ bool entry::AppInit2(bool restart/*=false*/)
         block_info::nScriptCheckThreads = block_params::MAX_SCRIPTCHECK_THREADS;
     }
 
+    CPrevoutCache::cache.SetMaxSize(map_arg::GetArgInt("-prevoutcache", CPrevoutCache::DEFAULT_CACHE_SIZE));
+    sigcache::Setup(map_arg::GetArgInt("-maxsigcachesize", sigcache::DEFAULT_MAX_SIZE));
+    block_mmap::SetEnabled(map_arg::GetBoolArg("-blockmmap", true));
+    block_store::SetSyncPolicy(map_arg::GetArgInt("-blocksyncmb", block_store::DEFAULT_SYNC_MB), map_arg::GetArgInt("-blocksyncinterval", block_store::DEFAULT_SYNC_INTERVAL));
+    block_index_snapshot::SetEnabled(map_arg::GetBoolArg("-indexsnapshot", false));
+
     args_bool::fDebug = map_arg::GetBoolArg("-debug");
 
     // -debug implies fDebug*
@@ -766,6 +796,20 @@ bool entry::AppInit2(bool restart/*=false*/)
         }
     }
 
+    // never accept more peers than the file descriptor limit leaves room for
+    {
+        int nMaxConnections = std::max(map_arg::GetArgInt("-maxconnections", 125), 0);
+        const int nFD = lutil::RaiseFileDescriptorLimit(nMaxConnections + MIN_CORE_FILEDESCRIPTORS);
+        if (nFD < MIN_CORE_FILEDESCRIPTORS) {
+            return InitError(_("Not enough file descriptors available."));
+        }
+        if (nFD - MIN_CORE_FILEDESCRIPTORS < nMaxConnections) {
+            nMaxConnections = nFD - MIN_CORE_FILEDESCRIPTORS;
+            InitWarning(tfm::format(_("Warning: -maxconnections reduced to %d, because of system limitations."), nMaxConnections));
+        }
+        map_arg::SetMapArgsString("-maxconnections", tfm::format("%d", nMaxConnections));
+    }
+
     //
     // Put client version data into coinbase flags.
     //
@@ -860,11 +904,16 @@ bool entry::AppInit2(bool restart/*=false*/)
     }
 
     //I_DEBUG_CS("Step 4d: Script check ...");
+    // build the shared secp256k1 verify tables once, before any verifier runs
+    if (! CPubKey::ecmult::secp256k1_context::get_verify().is_built())
+        return InitError(_("Error: Failed to build the secp256k1 verify context."));
     if (block_info::nScriptCheckThreads) {
         logging::LogPrintf("Using %u threads for script verification\n", block_info::nScriptCheckThreads);
         for (int i=0; i < block_info::nScriptCheckThreads-1; ++i) {
             if(! bitthread::NewThread(block_check::thread::ThreadScriptCheck, nullptr))
                 bitthread::thread_error(std::string(__func__) + " :ThreadScriptCheck");
+            if(! bitthread::NewThread(block_check::thread::ThreadPrevoutFetch, nullptr))
+                bitthread::thread_error(std::string(__func__) + " :ThreadPrevoutFetch");
         }
     }
 
@@ -1068,6 +1117,13 @@ bool entry::AppInit2(bool restart/*=false*/)
         }
     }
 
+    miner::nStakeMinerThreads = map_arg::GetArgInt("-stakeminerthreads", 1);
+    if (miner::nStakeMinerThreads == 0) {
+        miner::nStakeMinerThreads = std::max<int>(boost::thread::hardware_concurrency(), 1);
+    } else if (miner::nStakeMinerThreads < 0) {
+        miner::nStakeMinerThreads = 1;
+    }
+
     if (map_arg::GetMapArgsCount("-reservebalance")) { // ppcoin: reserve balance amount
         if (! strenc::ParseMoney(map_arg::GetMapArgsString("-reservebalance").c_str(), miner::nReserveBalance)) {
             InitError(_("Invalid amount for -reservebalance=<amount>"));
@@ -1141,6 +1197,7 @@ bool entry::AppInit2(bool restart/*=false*/)
         logging::LogPrintf("Shutdown requested. Exiting.\n");
         return false;
     }
+    block_index_snapshot::SetIndexLoaded();
     logging::LogPrintf(" block index %15" PRId64 "ms\n", util::GetTimeMillis() - nStart);
 
     if (map_arg::GetBoolArg("-printblockindex") || map_arg::GetBoolArg("-printblocktree")) {
@@ -1151,7 +1208,7 @@ bool entry::AppInit2(bool restart/*=false*/)
     if (map_arg::GetMapArgsCount("-printblock")) {
         std::string strMatch = map_arg::GetMapArgsString("-printblock");
         int nFound = 0;
-        for (std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.begin(); mi != block_info::mapBlockIndex.end(); ++mi)
+        for (BlockMap::iterator mi = block_info::mapBlockIndex.begin(); mi != block_info::mapBlockIndex.end(); ++mi)
         {
             uint256 hash = (*mi).first;
             if (::strncmp(hash.ToString().c_str(), strMatch.c_str(), strMatch.size()) == 0) {
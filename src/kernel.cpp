@@ -106,7 +106,7 @@ bool bitkernel<T>::SelectBlockFromCandidates(std::vector<std::pair<int64_t, T> >
             return logging::error("bitkernel::SelectBlockFromCandidates: failed to find block index for candidate block %s", item.second.ToString().c_str());
         }
 
-        const CBlockIndex *pindex = block_info::mapBlockIndex[item.second];
+        const CBlockIndex *pindex = block_info::mapBlockIndex.get(item.second);
         if (fSelected && pindex->GetBlockTime() > nSelectionIntervalStop) {
             break;
         }
@@ -302,11 +302,14 @@ template <typename T>
 bool bitkernel<T>::GetKernelStakeModifier(T hashBlockFrom, uint64_t &nStakeModifier, int &nStakeModifierHeight, int64_t &nStakeModifierTime, bool fPrintProofOfStake)
 {
     nStakeModifier = 0;
+    const uint64_t nGeneration = CStakeModifierCache_impl<T>::cache.GetGeneration();
+    if (CStakeModifierCache_impl<T>::cache.Get(hashBlockFrom, nStakeModifier, nStakeModifierHeight, nStakeModifierTime))
+        return true;
     if (! block_info::mapBlockIndex.count(hashBlockFrom)) {
         return logging::error("bitkernel::GetKernelStakeModifier() : block not indexed");
     }
 
-    const CBlockIndex *pindexFrom = block_info::mapBlockIndex[hashBlockFrom];
+    const CBlockIndex *pindexFrom = block_info::mapBlockIndex.get(hashBlockFrom);
     nStakeModifierHeight = pindexFrom->get_nHeight();
     nStakeModifierTime = pindexFrom->GetBlockTime();
     int64_t nStakeModifierSelectionInterval = GetStakeModifierSelectionInterval();
@@ -335,6 +338,7 @@ bool bitkernel<T>::GetKernelStakeModifier(T hashBlockFrom, uint64_t &nStakeModif
     }
 
     nStakeModifier = pindex->get_nStakeModifier();
+    CStakeModifierCache_impl<T>::cache.Set(hashBlockFrom, nStakeModifier, nStakeModifierHeight, nStakeModifierTime, pindex->get_nHeight(), nGeneration);
     return true;
 }
 
@@ -381,15 +385,12 @@ bool bitkernel<T>::CheckStakeKernelHash(uint32_t nBits, const CBlock_impl<T> &bl
         return logging::error("bitkernel::CheckStakeKernelHash() : min age violation");
     }
 
-    CBigNum bnTargetPerCoinDay;
-    bnTargetPerCoinDay.SetCompact(nBits);
     int64_t nValueIn = txPrev.get_vout(prevout.get_n()).get_nValue();
 
     T hashBlockFrom = blockFrom.GetHash();
 
-    CBigNum bnCoinDayWeight = CBigNum(nValueIn) * GetWeight((int64_t)txPrev.get_nTime(), (int64_t)nTimeTx) / util::COIN / util::nOneDay;
-    //targetProofOfStake = (bnCoinDayWeight * bnTargetPerCoinDay).getuint256();
-    targetProofOfStake = (bnCoinDayWeight * bnTargetPerCoinDay).getuint<T>();
+    const CStakeTarget_impl<T> target(nBits, nValueIn, GetWeight((int64_t)txPrev.get_nTime(), (int64_t)nTimeTx));
+    targetProofOfStake = target.GetTarget();
 
     // Calculate hash
     CDataStream ss(SER_GETHASH, 0);
@@ -408,7 +409,7 @@ bool bitkernel<T>::CheckStakeKernelHash(uint32_t nBits, const CBlock_impl<T> &bl
         logging::LogPrintf("bitkernel::CheckStakeKernelHash() : using modifier 0x%016" PRIx64 " at height=%d timestamp=%s for block from height=%d timestamp=%s\n",
             nStakeModifier, nStakeModifierHeight,
             util::DateTimeStrFormat(nStakeModifierTime).c_str(),
-            block_info::mapBlockIndex[hashBlockFrom]->get_nHeight(),
+            block_info::mapBlockIndex.get(hashBlockFrom)->get_nHeight(),
             util::DateTimeStrFormat(blockFrom.GetBlockTime()).c_str());
         logging::LogPrintf("bitkernel::CheckStakeKernelHash() : check modifier=0x%016" PRIx64 " nTimeBlockFrom=%u nTxPrevOffset=%u nTimeTxPrev=%u nPrevout=%u nTimeTx=%u hashTarget=%s hashProof=%s\n",
             nStakeModifier,
@@ -417,14 +418,14 @@ bool bitkernel<T>::CheckStakeKernelHash(uint32_t nBits, const CBlock_impl<T> &bl
     }
 
     // Now check if proof-of-stake hash meets target protocol
-    if (CBigNum(hashProofOfStake) > bnCoinDayWeight * bnTargetPerCoinDay) {
+    if (! target.IsMet(hashProofOfStake)) {
         return false;
     }
     if (args_bool::fDebug && !fPrintProofOfStake) {
         logging::LogPrintf("bitkernel::CheckStakeKernelHash() : using modifier 0x%016" PRIx64 " at height=%d timestamp=%s for block from height=%d timestamp=%s\n",
             nStakeModifier, nStakeModifierHeight, 
             util::DateTimeStrFormat(nStakeModifierTime).c_str(),
-            block_info::mapBlockIndex[hashBlockFrom]->get_nHeight(),
+            block_info::mapBlockIndex.get(hashBlockFrom)->get_nHeight(),
             util::DateTimeStrFormat(blockFrom.GetBlockTime()).c_str());
         logging::LogPrintf("bitkernel::CheckStakeKernelHash() : pass modifier=0x%016" PRIx64 " nTimeBlockFrom=%u nTxPrevOffset=%u nTimeTxPrev=%u nPrevout=%u nTimeTx=%u hashTarget=%s hashProof=%s\n",
             nStakeModifier,
@@ -440,41 +441,18 @@ template <typename T>
 bool bitkernel<T>::ScanKernelForward(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, std::pair<uint32_t, uint32_t> &SearchInterval, std::vector<std::pair<T, uint32_t> > &solutions)
 {
     try {
-        //
-        // TODO: custom threads amount
-        //
-        uint32_t nThreads = boost::thread::hardware_concurrency();
-        if (nThreads == 0) {
-           nThreads = 1;
-           logging::LogPrintf("Warning: hardware_concurrency() failed in %s:%d\n", __FILE__, __LINE__);
-        }
-        uint32_t nPart = (SearchInterval.second - SearchInterval.first) / nThreads;
+        std::vector<CKernelScanJob::input> vInputs(1);
+        std::memcpy(vInputs[0].kernel, kernel, sizeof(vInputs[0].kernel));
+        vInputs[0].nInputTxTime = nInputTxTime;
+        vInputs[0].nValueIn = nValueIn;
 
-        KernelWorker **workers = new KernelWorker *[nThreads];
-        boost::thread_group group;
-        for(size_t i = 0; i < nThreads; ++i)
-        {
-            uint32_t nBegin = SearchInterval.first + nPart * i;
-            uint32_t nEnd = SearchInterval.first + nPart * (i + 1);
-            workers[i] = new KernelWorker(kernel, nBits, nInputTxTime, nValueIn, nBegin, nEnd);
-            boost::function<void()> workerFnc = boost::bind(&KernelWorker::Do, workers[i]);
-            group.create_thread(workerFnc);        // start thread
-        }
-
-        group.join_all();        // wali for all thread exit ...
+        // time windows on all cores
+        CKernelScanJob job(vInputs, nBits, SearchInterval.first, SearchInterval.second, 0);
+        job.Wait();
 
         solutions.clear();
-        for(size_t i = 0; i < nThreads; ++i)
-        {
-            std::vector<std::pair<T, uint32_t> > ws = workers[i]->GetSolutions();
-            solutions.insert(solutions.end(), ws.begin(), ws.end());
-        }
-
-        for(size_t i = 0; i < nThreads; ++i)
-        {
-            delete workers[i];
-        }
-        delete [] workers;
+        for(const CKernelScanJob::solution &sol: job.GetSolutions())
+            solutions.push_back(std::make_pair(sol.hash, sol.nTime));
 
         if (solutions.size() == 0) {
             // no solutions
@@ -561,4 +539,64 @@ bool bitkernel<T>::CheckStakeModifierCheckpoints(int nHeight, uint32_t nStakeMod
     return true;
 }
 
+template <typename T> CStakeModifierCache_impl<T> CStakeModifierCache_impl<T>::cache;
+
+template <typename T>
+CStakeModifierCache_impl<T>::CStakeModifierCache_impl() : nGeneration(0), nHits(0), nMisses(0) {}
+
+template <typename T>
+bool CStakeModifierCache_impl<T>::Get(const T &hashBlockFrom, uint64_t &nStakeModifier, int &nStakeModifierHeight, int64_t &nStakeModifierTime) {
+    LOCK(cs);
+    typename std::map<T, entry>::const_iterator mi = mapEntry.find(hashBlockFrom);
+    if (mi == mapEntry.end()) {
+        ++nMisses;
+        return false;
+    }
+    ++nHits;
+    nStakeModifier = mi->second.nStakeModifier;
+    nStakeModifierHeight = mi->second.nHeight;
+    nStakeModifierTime = mi->second.nTime;
+    return true;
+}
+
+template <typename T>
+void CStakeModifierCache_impl<T>::Set(const T &hashBlockFrom, uint64_t nStakeModifier, int nStakeModifierHeight, int64_t nStakeModifierTime, int nHeightEnd, uint64_t nGenerationFrom) {
+    LOCK(cs);
+    if (nGenerationFrom != nGeneration) // the walk may have followed cut pnext links
+        return;
+    if (mapEntry.size() >= MAX_ENTRIES && mapEntry.count(hashBlockFrom) == 0)
+        mapEntry.clear();
+    entry &e = mapEntry[hashBlockFrom];
+    e.nStakeModifier = nStakeModifier;
+    e.nHeight = nStakeModifierHeight;
+    e.nTime = nStakeModifierTime;
+    e.nHeightEnd = nHeightEnd;
+}
+
+template <typename T>
+void CStakeModifierCache_impl<T>::Disconnect(int nHeight) {
+    LOCK(cs);
+    ++nGeneration;
+    for (typename std::map<T, entry>::iterator mi = mapEntry.begin(); mi != mapEntry.end();) {
+        if (mi->second.nHeightEnd >= nHeight)
+            mi = mapEntry.erase(mi);
+        else
+            ++mi;
+    }
+}
+
+template <typename T>
+void CStakeModifierCache_impl<T>::Clear() {
+    LOCK(cs);
+    mapEntry.clear();
+}
+
+template <typename T>
+std::string CStakeModifierCache_impl<T>::ToString() const {
+    LOCK(cs);
+    return tfm::format("CStakeModifierCache(entries=%" PRIu64 ", hits=%" PRIu64 ", misses=%" PRIu64 ")",
+        (uint64_t)mapEntry.size(), nHits, nMisses);
+}
+
 template class bitkernel<uint256>;
+template class CStakeModifierCache_impl<uint256>;
@@ -85,4 +85,130 @@ public:
     }
 };
 
+//
+// Stake modifier cache
+// Memoizes GetKernelStakeModifier: the hash of the block containing the coin
+// maps to the modifier found about a selection interval later on the main
+// chain. Only successful lookups are stored, so an entry depends on the main
+// chain from the coin block up to nHeightEnd (the last block walked) and is
+// dropped by Disconnect() when a reorganization replaces any of those blocks.
+// Lookups may run without cs_main (scaninput), so a walk can race a
+// Reorganize: Set() only stores the entry if no Disconnect() happened since
+// the walk took its generation.
+// Singleton Class
+//
+template <typename T>
+class CStakeModifierCache_impl
+{
+private:
+    CStakeModifierCache_impl(const CStakeModifierCache_impl &)=delete;
+    CStakeModifierCache_impl(CStakeModifierCache_impl &&)=delete;
+    CStakeModifierCache_impl &operator=(const CStakeModifierCache_impl &)=delete;
+    CStakeModifierCache_impl &operator=(CStakeModifierCache_impl &&)=delete;
+
+    struct entry {
+        uint64_t nStakeModifier;
+        int nHeight;
+        int64_t nTime;
+        int nHeightEnd;
+    };
+
+    mutable CCriticalSection cs;
+    std::map<T, entry> mapEntry;
+    uint64_t nGeneration; // bumped by every Disconnect()
+    uint64_t nHits;
+    uint64_t nMisses;
+public:
+    static constexpr size_t MAX_ENTRIES = 200000; // full: start over
+    static CStakeModifierCache_impl cache;
+
+    CStakeModifierCache_impl(); // the node uses cache; the startup check builds its own
+
+    bool Get(const T &hashBlockFrom, uint64_t &nStakeModifier, int &nStakeModifierHeight, int64_t &nStakeModifierTime);
+    void Set(const T &hashBlockFrom, uint64_t nStakeModifier, int nStakeModifierHeight, int64_t nStakeModifierTime, int nHeightEnd, uint64_t nGenerationFrom);
+
+    // take before walking pnext; pass to Set()
+    uint64_t GetGeneration() const {
+        LOCK(cs);
+        return nGeneration;
+    }
+
+    // the main chain from nHeight upwards has been disconnected
+    void Disconnect(int nHeight);
+    void Clear();
+
+    size_t size() const {
+        LOCK(cs);
+        return mapEntry.size();
+    }
+    void GetStats(uint64_t &nHitsOut, uint64_t &nMissesOut) const {
+        LOCK(cs);
+        nHitsOut = nHits;
+        nMissesOut = nMisses;
+    }
+    std::string ToString() const;
+};
+using CStakeModifierCache = CStakeModifierCache_impl<uint256>;
+
+//
+// Proof-of-stake target: bnCoinDayWeight * bnTargetPerCoinDay in fixed-width integers
+// bnCoinDayWeight = nValueIn * nWeight / COIN / nOneDay (each division truncated toward zero)
+// bnTargetPerCoinDay = CBigNum::SetCompact(nBits) (MPI: nSize bytes, sign bit 0x00800000)
+// Bit-identical with the CBigNum arithmetic: GetTarget() is the low bits of the magnitude
+// (CBigNum::getuint), the sign and the bits above the width are kept for IsMet().
+//
+template <typename T>
+class CStakeTarget_impl
+{
+public:
+    CStakeTarget_impl(uint32_t nBits, int64_t nValueIn, int64_t nWeight) {
+        // |nValueIn * nWeight| < 2^127
+        nTarget = Abs64(nValueIn);
+        nTarget.MulU64(Abs64(nWeight));
+        nTarget.DivU32((uint32_t)util::COIN);
+        nTarget.DivU32((uint32_t)util::nOneDay);
+
+        const uint32_t nSize = nBits >> 24;
+        uint32_t nMantissa = nBits & 0x007fffff;
+        if (nSize <= 3)
+            nMantissa >>= 8 * (3 - nSize);
+        fOverflow = (nTarget.MulU32(nMantissa) != 0);
+        if (nSize > 3) {
+            const unsigned int nShift = 8 * (nSize - 3);
+            if (nShift >= nTarget.size() * 8)
+                fOverflow = fOverflow || !!nTarget;
+            else
+                fOverflow = fOverflow || !!(nTarget >> (nTarget.size() * 8 - nShift));
+            nTarget <<= nShift;
+        }
+
+        const bool fNegativeCompact = nSize >= 1 && (nBits & 0x00800000) != 0;
+        fNegative = (fOverflow || !!nTarget) && ((nValueIn < 0) != (nWeight < 0)) != fNegativeCompact;
+    }
+
+    // low bits of |target|
+    const T &GetTarget() const {return nTarget;}
+    bool IsNegative() const {return fNegative;}
+    bool IsOverflow() const {return fOverflow;}
+
+    // hashProofOfStake <= target
+    bool IsMet(const T &hashProofOfStake) const {
+        if (fNegative)
+            return false;
+        if (fOverflow)
+            return true;
+        return hashProofOfStake <= nTarget;
+    }
+
+private:
+    static uint64_t Abs64(int64_t n) {
+        return (n < 0) ? (uint64_t)(-(n + 1)) + 1: (uint64_t)n;
+    }
+
+    T nTarget;
+    bool fNegative;
+    bool fOverflow;
+};
+using CStakeTarget = CStakeTarget_impl<uint256>;
+
 #endif // PPCOIN_KERNEL_H
@@ -4,107 +4,242 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <vector>
+#include <algorithm>
 #include <inttypes.h>
 #include <kernel.h>
 #include <kernel_worker.h>
+#include <crypto/sha256.h>
 #include <util/thread.h>
 
-void KernelWorker::Do_generic()
+namespace {
+
+// Candidates hashed per SHA256DBlock call (lanes of the 8-way kernel)
+constexpr uint32_t KERNEL_SCAN_LANES = 8;
+
+//
+// Kernel hash of consecutive nTimeTx candidates.
+// The kernel is 28 bytes (24 bytes of prefix, nTimeTx), so the first SHA256 is
+// a single padded block: only the 4 bytes of nTimeTx change between candidates.
+//
+class CKernelScanner
 {
-    bitthread::SetThreadPriority(THREAD_PRIORITY_LOWEST);
+public:
+    explicit CKernelScanner(const unsigned char *kernel) {
+        std::memset(blocks, 0, sizeof(blocks));
+        for(uint32_t i = 0; i < KERNEL_SCAN_LANES; ++i) {
+            unsigned char *block = blocks + 64 * i;
+            std::memcpy(block, kernel, 8 + 16);
+            block[28] = 0x80;
+            block[63] = 28 * 8;
+        }
+    }
 
-    // Compute maximum possible target to filter out majority of obviously insufficient hashes
-    CBigNum bnTargetPerCoinDay; bnTargetPerCoinDay.SetCompact(nBits);
-    uint256 nMaxTarget = (bnTargetPerCoinDay * bnValueIn * block_check::nStakeMaxAge / util::COIN / util::nOneDay).getuint256();
+    // hashes[i]: kernel hash of nTimeTx + i (fForward) or nTimeTx - i
+    void Hash(uint32_t nTimeTx, uint32_t nCount, bool fForward, uint256 *hashes) {
+        assert(nCount <= KERNEL_SCAN_LANES);
+        for(uint32_t i = 0; i < nCount; ++i) {
+            const uint32_t nTime = fForward ? nTimeTx + i: nTimeTx - i;
+            std::memcpy(blocks + 64 * i + 8 + 16, &nTime, 4);
+        }
+        latest_crypto::SHA256DBlock((unsigned char *)hashes, blocks, nCount);
+    }
 
-    // Sha256 result buffer
-    uint32_t hashProofOfStake[8], hashProofOfStakeC[8];
-    uint256 *pnHashProofOfStake = (uint256 *)&hashProofOfStake;
-    uint256 *pnHashProofOfStakeC = (uint256 *)&hashProofOfStakeC;
+private:
+    unsigned char blocks[64 * KERNEL_SCAN_LANES];
+};
 
-    // Search forward in time from the given timestamp
-    // Stopping search in case of shutting down
+//
+// Kernel target of one input: the maximum target prefilter, then CStakeTarget per nTimeTx.
+//
+class CKernelTarget
+{
+public:
+    CKernelTarget(uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn) : nBits(nBits), nInputTxTime(nInputTxTime), nValueIn(nValueIn) {
+        // Maximum possible target to filter out the majority of obviously insufficient hashes
+        // (only with a non-negative value and compact: otherwise a negative weight can give a larger target)
+        const CStakeTarget maxTarget(nBits, nValueIn, block_check::nStakeMaxAge);
+        const bool fFilter = nValueIn >= 0 && (nBits & 0x00800000) == 0 && !maxTarget.IsOverflow();
+        nMax32 = fFilter ? maxTarget.GetTarget().Get32(7): 0xFFFFFFFF;
+    }
 
-    latest_crypto::CSHA256 sha256;
-    sha256.Write(kernel, 8 + 16);
-    latest_crypto::CSHA256 workerSha256 = sha256;
+    // top 32 bits above the maximum target: never a solution
+    bool IsAboveMax(const uint256 &hashProofOfStake) const {
+        return hashProofOfStake.Get32(7) > nMax32;
+    }
 
-    SHA256_CTX ctx;
-    SHA256_Init(&ctx);
-    SHA256_Update(&ctx, kernel, 8 + 16);    // Init new sha256 context and update it with first 24 bytes of kernel
-    SHA256_CTX workerCtx = ctx;             // save context
-    for (uint32_t nTimeTx = nIntervalBegin, nMaxTarget32 = nMaxTarget.Get32(7); nTimeTx < nIntervalEnd && !args_bool::fShutdown; nTimeTx++)
+    bool Check(const uint256 &hashProofOfStake, uint32_t nTimeTx) const {
+        const CStakeTarget target(nBits, nValueIn, bitkernel<uint256>::GetWeight((int64_t)nInputTxTime, (int64_t)nTimeTx));
+        return target.IsMet(hashProofOfStake);
+    }
+
+private:
+    uint32_t nBits;
+    uint32_t nInputTxTime;
+    int64_t nValueIn;
+    uint32_t nMax32;
+};
+
+//
+// Search forward in time from nIntervalBegin, stopping in case of shutting down or fCancel
+//
+void ScanKernelForward(const unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, uint32_t nIntervalBegin, uint32_t nIntervalEnd,
+                       const std::atomic<bool> &fCancel, uint64_t &nHashes, std::vector<std::pair<uint256, uint32_t> > &solutions)
+{
+    const CKernelTarget target(nBits, nInputTxTime, nValueIn);
+    CKernelScanner scanner(kernel);
+
+    uint256 hashProofOfStake[KERNEL_SCAN_LANES];
+    for (uint32_t nTimeTx = nIntervalBegin; nTimeTx < nIntervalEnd && !args_bool::fShutdown && !fCancel.load(std::memory_order_relaxed);)
     {
-        uint256 hashC;
-        sha256.Write((unsigned char *)&nTimeTx, 4);
-        sha256.Finalize((unsigned char *)&hashC);
-        latest_crypto::CSHA256().Write((unsigned char *)&hashC, sizeof(hashC)).Finalize((unsigned char *)&hashProofOfStakeC);
-        sha256 = workerSha256;
-
-        // Complete first hashing iteration
-        uint256 hash1;
-        SHA256_Update(&ctx, (unsigned char *)&nTimeTx, 4);
-        SHA256_Final((unsigned char *)&hash1, &ctx);
-        SHA256((unsigned char *)&hash1, sizeof(hashProofOfStake), (unsigned char *)&hashProofOfStake); // Calculate kernel hash
-        ctx = workerCtx;
-
-        assert(!"debug hashC == hash1");
-        assert(hashC==hash1);
-        assert(*pnHashProofOfStake==*pnHashProofOfStakeC);
-
-        // Skip if hash doesn't satisfy the maximum target
-        if (hashProofOfStake[7] > nMaxTarget32) {
-            continue;
-        } else {
-            CBigNum bnCoinDayWeight = bnValueIn * bitkernel<uint256>::GetWeight((int64_t)nInputTxTime, (int64_t)nTimeTx) / util::COIN / util::nOneDay;
-            CBigNum bnTargetProofOfStake = bnCoinDayWeight * bnTargetPerCoinDay;
-            if (bnTargetProofOfStake >= CBigNum(*pnHashProofOfStake)) {
-                solutions.push_back(std::pair<uint256, uint32_t>(*pnHashProofOfStake, nTimeTx));
-            }
+        const uint32_t nCount = std::min(KERNEL_SCAN_LANES, nIntervalEnd - nTimeTx);
+        scanner.Hash(nTimeTx, nCount, true, hashProofOfStake);
+        nHashes += nCount;
+        for (uint32_t i = 0; i < nCount; ++i)
+        {
+            // Skip if hash doesn't satisfy the maximum target
+            if (target.IsAboveMax(hashProofOfStake[i]))
+                continue;
+            if (target.Check(hashProofOfStake[i], nTimeTx + i))
+                solutions.push_back(std::pair<uint256, uint32_t>(hashProofOfStake[i], nTimeTx + i));
         }
+        nTimeTx += nCount;
     }
 }
 
+} // namespace
+
+void KernelWorker::Do_generic()
+{
+    bitthread::SetThreadPriority(THREAD_PRIORITY_LOWEST);
+
+    const std::atomic<bool> fCancel(false);
+    uint64_t nHashes = 0;
+    ScanKernelForward(kernel, nBits, nInputTxTime, nValueIn, nIntervalBegin, nIntervalEnd, fCancel, nHashes, solutions);
+}
+
 //
 // [static] Scan given kernel for solutions
 //
 bool KernelWorker::ScanKernelBackward(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, std::pair<uint32_t, uint32_t> &SearchInterval, std::pair<uint256, uint32_t> &solution)
 {
-    CBigNum bnTargetPerCoinDay; bnTargetPerCoinDay.SetCompact(nBits);
-    CBigNum bnValueIn(nValueIn);
+    const std::atomic<bool> fCancel(false);
+    uint64_t nHashes = 0;
+    return ScanKernelBackward(kernel, nBits, nInputTxTime, nValueIn, SearchInterval, solution, fCancel, nHashes);
+}
 
-    // Get maximum possible target to filter out the majority of obviously insufficient hashes
-    uint256 nMaxTarget = (bnTargetPerCoinDay * bnValueIn * block_check::nStakeMaxAge / util::COIN / util::nOneDay).getuint256();
+bool KernelWorker::ScanKernelBackward(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, std::pair<uint32_t, uint32_t> &SearchInterval, std::pair<uint256, uint32_t> &solution, const std::atomic<bool> &fCancel, uint64_t &nHashes)
+{
+    const CKernelTarget target(nBits, nInputTxTime, nValueIn);
+    CKernelScanner scanner(kernel);
 
     // Search backward in time from the given timestamp Stopping search in case of shutting down
-    SHA256_CTX ctx;
-    SHA256_Init(&ctx);
-    SHA256_Update(&ctx, kernel, 8 + 16);           // Init new sha256 context and update it with first 24 bytes of kernel
-    SHA256_CTX workerCtx = ctx;                    // save context
-    for (uint32_t nTimeTx = SearchInterval.first; nTimeTx > SearchInterval.second && !args_bool::fShutdown; nTimeTx--)
+    uint256 hashProofOfStake[KERNEL_SCAN_LANES];
+    for (uint32_t nTimeTx = SearchInterval.first; nTimeTx > SearchInterval.second && !args_bool::fShutdown && !fCancel.load(std::memory_order_relaxed);)
     {
-        // Complete first hashing iteration
-        uint256 hash1;
-        SHA256_Update(&ctx, (unsigned char*)&nTimeTx, 4);
-        SHA256_Final((unsigned char*)&hash1, &ctx);
-        ctx = workerCtx;
-
-        // Calculate kernel hash
-        uint256 hashProofOfStake;
-        SHA256((unsigned char*)&hash1, sizeof(hashProofOfStake), (unsigned char *)&hashProofOfStake);
-
-        // Skip if hash doesn't satisfy the maximum target
-        if (hashProofOfStake > nMaxTarget) {
-            continue;
-        } else {
-            CBigNum bnCoinDayWeight = bnValueIn * bitkernel<uint256>::GetWeight((int64_t)nInputTxTime, (int64_t)nTimeTx) / util::COIN / util::nOneDay;
-            CBigNum bnTargetProofOfStake = bnCoinDayWeight * bnTargetPerCoinDay;
-            if (bnTargetProofOfStake >= CBigNum(hashProofOfStake)) {
-                solution.first = hashProofOfStake;
-                solution.second = nTimeTx;
+        const uint32_t nCount = std::min(KERNEL_SCAN_LANES, nTimeTx - SearchInterval.second);
+        scanner.Hash(nTimeTx, nCount, false, hashProofOfStake);
+        nHashes += nCount;
+        for (uint32_t i = 0; i < nCount; ++i)
+        {
+            // Skip if hash doesn't satisfy the maximum target
+            if (target.IsAboveMax(hashProofOfStake[i]))
+                continue;
+            if (target.Check(hashProofOfStake[i], nTimeTx - i)) {
+                solution.first = hashProofOfStake[i];
+                solution.second = nTimeTx - i;
                 return true;
             }
         }
+        nTimeTx -= nCount;
     }
     return false;
 }
+
+CKernelScanJob::CKernelScanJob(const std::vector<input> &vInputsIn, uint32_t nBitsIn, uint32_t nIntervalBeginIn, uint32_t nIntervalEndIn, int nThreadsIn, uint32_t nChunkTimeIn) :
+    vInputs(vInputsIn), nBits(nBitsIn), nIntervalBegin(nIntervalBeginIn), nIntervalEnd(std::max(nIntervalBeginIn, nIntervalEndIn)), nChunkTime(std::max(nChunkTimeIn, KERNEL_SCAN_LANES)),
+    nNextChunk(0), nChunksDone(0), nHashes(0), fCancel(false), nRunning(0)
+{
+    nChunksPerInput = ((uint64_t)nIntervalEnd - nIntervalBegin + nChunkTime - 1) / nChunkTime;
+    nChunks = nChunksPerInput * vInputs.size();
+
+    // scanning is CPU bound: more workers than cores only add threads
+    const int nMaxThreads = std::max((int)boost::thread::hardware_concurrency(), 1);
+    nThreads = nThreadsIn;
+    if (nThreads <= 0 || nThreads > nMaxThreads)
+        nThreads = nMaxThreads;
+    if ((uint64_t)nThreads > nChunks)
+        nThreads = (int)std::max(nChunks, (uint64_t)1);
+
+    // the destructor does not run if this throws: stop and join the workers already started
+    try {
+        for (int i = 0; i < nThreads; ++i) {
+            ++nRunning;
+            try {
+                group.create_thread(boost::bind(&CKernelScanJob::Thread, this));
+            } catch (...) {
+                --nRunning;
+                throw;
+            }
+        }
+    } catch (...) {
+        Cancel();
+        Wait();
+        throw;
+    }
+}
+
+CKernelScanJob::~CKernelScanJob()
+{
+    Cancel();
+    Wait();
+}
+
+void CKernelScanJob::Wait()
+{
+    group.join_all();
+}
+
+std::vector<CKernelScanJob::solution> CKernelScanJob::GetSolutions() const
+{
+    std::vector<solution> vRet;
+    {
+        LOCK(cs);
+        vRet = vSolutions;
+    }
+    std::sort(vRet.begin(), vRet.end());
+    return vRet;
+}
+
+void CKernelScanJob::Thread()
+{
+    bitthread::SetThreadPriority(THREAD_PRIORITY_LOWEST);
+
+    // chunks of one input are adjacent, so its solutions are complete early
+    uint64_t nLocalHashes = 0;
+    std::vector<std::pair<uint256, uint32_t> > result;
+    for (uint64_t nChunk = nNextChunk++; nChunk < nChunks && !args_bool::fShutdown && !fCancel.load(std::memory_order_relaxed); nChunk = nNextChunk++)
+    {
+        const size_t nInput = (size_t)(nChunk / nChunksPerInput);
+        const uint32_t nBegin = nIntervalBegin + (uint32_t)(nChunk % nChunksPerInput) * nChunkTime;
+        const uint32_t nEnd = (nIntervalEnd - nBegin > nChunkTime) ? nBegin + nChunkTime: nIntervalEnd;
+        const input &in = vInputs[nInput];
+
+        result.clear();
+        nLocalHashes = 0;
+        ScanKernelForward(in.kernel, nBits, in.nInputTxTime, in.nValueIn, nBegin, nEnd, fCancel, nLocalHashes, result);
+        nHashes += nLocalHashes;
+        if (! result.empty()) {
+            LOCK(cs);
+            for (const std::pair<uint256, uint32_t> &r: result) {
+                solution sol;
+                sol.nInput = nInput;
+                sol.hash = r.first;
+                sol.nTime = r.second;
+                vSolutions.push_back(sol);
+            }
+        }
+        if (! fCancel.load(std::memory_order_relaxed))
+            ++nChunksDone;
+    }
+    --nRunning;
+}
@@ -11,7 +11,10 @@
 #include <stdint.h>
 #include <uint256.h>
 #include <vector>
+#include <atomic>
 #include <script/scriptnum.h>
+#include <sync/sync.h>
+#include <boost/thread/thread.hpp>
 
 class KernelWorker
 {
@@ -19,7 +22,7 @@ public:
     using kernel_worker_result = std::vector<std::pair<uint256, uint32_t> >;
 
     KernelWorker(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, uint32_t nIntervalBegin, uint32_t nIntervalEnd) 
-        : kernel(kernel), nBits(nBits), nInputTxTime(nInputTxTime), bnValueIn(nValueIn), nIntervalBegin(nIntervalBegin), nIntervalEnd(nIntervalEnd) {
+        : kernel(kernel), nBits(nBits), nInputTxTime(nInputTxTime), nValueIn(nValueIn), nIntervalBegin(nIntervalBegin), nIntervalEnd(nIntervalEnd) {
         solutions = std::vector<std::pair<uint256, uint32_t> >();
     }
     ~KernelWorker() {}
@@ -40,7 +43,7 @@ private:
     KernelWorker(KernelWorker &&)=delete;
     KernelWorker &operator =(KernelWorker &&)=delete;
 
-    // One way hashing.
+    // Kernel hashes of 8 timestamps per step (crypto/sha256 SHA256DBlock).
     void Do_generic();
 
     // Kernel solutions.
@@ -50,7 +53,7 @@ private:
     uint8_t  *kernel;
     uint32_t nBits;
     uint32_t nInputTxTime;
-    CBigNum  bnValueIn;
+    int64_t  nValueIn;
 
     // Interval boundaries.
     uint32_t nIntervalBegin;
@@ -58,6 +61,95 @@ private:
 public:
     // Scan given kernel for solutions
     static bool ScanKernelBackward(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, std::pair<uint32_t, uint32_t> &SearchInterval, std::pair<uint256, uint32_t> &solution);
+
+    // Same, stopping once fCancel is set (another worker found a solution); nHashes counts the kernel hashes computed
+    static bool ScanKernelBackward(unsigned char *kernel, uint32_t nBits, uint32_t nInputTxTime, int64_t nValueIn, std::pair<uint32_t, uint32_t> &SearchInterval, std::pair<uint256, uint32_t> &solution, const std::atomic<bool> &fCancel, uint64_t &nHashes);
+};
+
+//
+// Kernel scan job: the (input x time window) space of several inputs, split
+// into chunks of nChunkTime seconds that a pool of worker threads pulls in
+// order. Solutions and progress can be read while the job is running;
+// Cancel() stops every worker within one hashing step.
+//
+class CKernelScanJob
+{
+public:
+    static constexpr uint32_t DEFAULT_CHUNK_TIME = 6 * 60 * 60;
+
+    struct input {
+        unsigned char kernel[24]; // static part of the kernel (nTimeTx follows)
+        uint32_t nInputTxTime;
+        int64_t nValueIn;
+    };
+
+    struct solution {
+        size_t nInput;            // index into the job inputs
+        uint256 hash;
+        uint32_t nTime;
+        bool operator<(const solution &obj) const {
+            return (nInput < obj.nInput) || (nInput == obj.nInput && nTime < obj.nTime);
+        }
+    };
+
+    // starts the workers (nThreads <= 0 or above hardware_concurrency: hardware_concurrency)
+    CKernelScanJob(const std::vector<input> &vInputs, uint32_t nBits, uint32_t nIntervalBegin, uint32_t nIntervalEnd, int nThreads, uint32_t nChunkTime = DEFAULT_CHUNK_TIME);
+    ~CKernelScanJob();
+
+    void Cancel() {
+        fCancel.store(true);
+    }
+    void Wait();
+
+    bool IsDone() const {
+        return nRunning.load() == 0;
+    }
+    bool IsCancelled() const {
+        return fCancel.load();
+    }
+    uint64_t GetChunks() const {
+        return nChunks;
+    }
+    uint64_t GetChunksDone() const {
+        return nChunksDone.load();
+    }
+    uint64_t GetHashes() const {
+        return nHashes.load();
+    }
+    int GetThreads() const {
+        return nThreads;
+    }
+
+    // solutions found so far, sorted by input and time
+    std::vector<solution> GetSolutions() const;
+
+private:
+    CKernelScanJob()=delete;
+    CKernelScanJob(const CKernelScanJob &)=delete;
+    CKernelScanJob &operator =(const CKernelScanJob &)=delete;
+    CKernelScanJob(CKernelScanJob &&)=delete;
+    CKernelScanJob &operator =(CKernelScanJob &&)=delete;
+
+    void Thread();
+
+    const std::vector<input> vInputs;
+    const uint32_t nBits;
+    const uint32_t nIntervalBegin;
+    const uint32_t nIntervalEnd;
+    const uint32_t nChunkTime;
+    uint64_t nChunksPerInput;
+    uint64_t nChunks;
+    int nThreads;
+
+    std::atomic<uint64_t> nNextChunk;
+    std::atomic<uint64_t> nChunksDone;
+    std::atomic<uint64_t> nHashes;
+    std::atomic<bool> fCancel;
+    std::atomic<int> nRunning;
+
+    mutable CCriticalSection cs;
+    std::vector<solution> vSolutions;
+    boost::thread_group group;
 };
 
 #endif
@@ -42,12 +42,16 @@ bool CPubKey::IsFullyValid_BIP66() const noexcept {
 }
 
 bool CPubKey::Verify(const uint256 &hash, const key_vector &vchSig) const noexcept {
-    auto bip66 = [this, &hash, &vchSig]() {
-        return Verify_BIP66(hash, vchSig);
+    return Verify(hash, vchSig.data(), vchSig.size());
+}
+
+bool CPubKey::Verify(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen) const noexcept {
+    auto bip66 = [this, &hash, pchSig, nSigLen]() {
+        return Verify_BIP66(hash, pchSig, nSigLen);
     };
-    auto openssl = [this, &hash, &vchSig]() {
+    auto openssl = [this, &hash, pchSig, nSigLen]() {
         DEBUGCS_CHECK("by OpenSSL");
-        if (vchSig.empty() || !IsValid())
+        if (nSigLen == 0 || !IsValid())
             return false;
 
         EC_KEY *pkey = ::EC_KEY_new_by_curve_name(NID_secp256k1);
@@ -62,14 +66,14 @@ bool CPubKey::Verify(const uint256 &hash, const key_vector &vchSig) const noexce
         do {
             uint8_t *norm_der = nullptr;
             const uint8_t *pbegin = &vch_[0];
-            const uint8_t *sigptr = &vchSig[0];
+            const uint8_t *sigptr = pchSig;
 
             // Trying to parse public key
             if (! ::o2i_ECPublicKey(&pkey, &pbegin, size()))
                 break;
 
             // New versions of OpenSSL are rejecting a non-canonical DER signatures, de/re-serialize first.
-            if (::d2i_ECDSA_SIG(&norm_sig, &sigptr, vchSig.size()) == nullptr)
+            if (::d2i_ECDSA_SIG(&norm_sig, &sigptr, nSigLen) == nullptr)
                 break;
 
             int derlen = 0;
@@ -86,7 +90,6 @@ bool CPubKey::Verify(const uint256 &hash, const key_vector &vchSig) const noexce
         return ret;
     };
 
-    debugcs::instance() << "CPubKey " << __func__ << " Bip66 mode: " << entry::b66mode << debugcs::endl();
     if(entry::b66mode == entry::Bip66_STRICT) {
         return bip66() && openssl();
     } else if (entry::b66mode == entry::Bip66_ADVISORY) {
@@ -98,6 +101,10 @@ bool CPubKey::Verify(const uint256 &hash, const key_vector &vchSig) const noexce
 }
 
 bool CPubKey::Verify_BIP66(const uint256 &hash, const key_vector &vchSig) const noexcept {
+    return Verify_BIP66(hash, vchSig.data(), vchSig.size());
+}
+
+bool CPubKey::Verify_BIP66(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen) const noexcept {
     DEBUGCS_CHECK("by libsecp256k1");
     if (! IsValid())
         return false;
@@ -105,7 +112,7 @@ bool CPubKey::Verify_BIP66(const uint256 &hash, const key_vector &vchSig) const
     secp256k1_signature sig;
     if (! secp256k1_ec_pubkey_parse(&pubkey, vch_, size()))
         return false;
-    if (! ecdsa_signature_parse_der_lax(&sig, vchSig.data(), vchSig.size()))
+    if (! ecdsa_signature_parse_der_lax(&sig, pchSig, nSigLen))
         return false;
 
     /* libsecp256k1's ECDSA verification requires lower-S signatures, which have
@@ -398,6 +405,446 @@ bool CPubKey::ReserealizeSignature(key_vector &vchSig) noexcept {
     c2 += (c1 < over) ? 1 : 0;  /* never overflows by contract */ \
 }
 
+#ifdef USE_WIDEMUL_INT128
+// 64-bit limb products (src/secp256k1: field_5x52_int128_impl.h, scalar_4x64_impl.h)
+// The 10x26 field element and the 8x32 scalar are repacked into 5x52 / 4x64 limbs, multiplied
+// with 64x64->128 bit products and unpacked: 25 instead of 100 multiplications for a field
+// product, 16 instead of 64 for a scalar product.
+namespace {
+typedef unsigned __int128 uint128_t;
+
+// [n0 .. n9] (magnitude <= 8) -> [t0 .. t4]: the 5x52 limbs stay within the 5x52 magnitude bounds
+inline void secp256k1_fe_pack_5x52(uint64_t *t, const uint32_t *n) {
+    t[0] = n[0] + ((uint64_t)n[1] << 26);
+    t[1] = n[2] + ((uint64_t)n[3] << 26);
+    t[2] = n[4] + ((uint64_t)n[5] << 26);
+    t[3] = n[6] + ((uint64_t)n[7] << 26);
+    t[4] = n[8] + ((uint64_t)n[9] << 26);
+}
+
+// [t0 .. t4] (t0..t3 52 bits, t4 49 bits) -> [n0 .. n9] of magnitude 1
+inline void secp256k1_fe_unpack_5x52(uint32_t *n, const uint64_t *t) {
+    const uint32_t M = 0x3FFFFFFUL;
+    n[0] = t[0] & M; n[1] = (uint32_t)(t[0] >> 26);
+    n[2] = t[1] & M; n[3] = (uint32_t)(t[1] >> 26);
+    n[4] = t[2] & M; n[5] = (uint32_t)(t[2] >> 26);
+    n[6] = t[3] & M; n[7] = (uint32_t)(t[3] >> 26);
+    n[8] = t[4] & M; n[9] = (uint32_t)(t[4] >> 26);
+
+    // fold bit 22 of n[9] (2^256 = 0x1000003D1 mod p), as secp256k1_fe_normalize_weak
+    const uint32_t x = n[9] >> 22;
+    n[9] &= 0x03FFFFFUL;
+    n[0] += x * 0x3D1UL;
+    n[1] += (x << 6);
+}
+
+void secp256k1_fe_mul_inner_5x52(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
+    uint128_t c, d;
+    uint64_t t3, t4, tx, u0;
+    uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+    const uint64_t M = 0xFFFFFFFFFFFFFULL, R = 0x1000003D10ULL;
+
+    VERIFY_BITS(a[0], 56);
+    VERIFY_BITS(a[1], 56);
+    VERIFY_BITS(a[2], 56);
+    VERIFY_BITS(a[3], 56);
+    VERIFY_BITS(a[4], 52);
+    VERIFY_BITS(b[0], 56);
+    VERIFY_BITS(b[1], 56);
+    VERIFY_BITS(b[2], 56);
+    VERIFY_BITS(b[3], 56);
+    VERIFY_BITS(b[4], 52);
+    VERIFY_CHECK(r != b);
+
+    /*  [... a b c] is a shorthand for ... + a<<104 + b<<52 + c<<0 mod n.
+     *  px is a shorthand for sum(a[i]*b[x-i], i=0..x).
+     *  Note that [x 0 0 0 0 0] = [x*R].
+     */
+    d  = (uint128_t)a0 * b[3]
+       + (uint128_t)a1 * b[2]
+       + (uint128_t)a2 * b[1]
+       + (uint128_t)a3 * b[0];
+    VERIFY_BITS(d, 114);
+    /* [d 0 0 0] = [p3 0 0 0] */
+    c  = (uint128_t)a4 * b[4];
+    VERIFY_BITS(c, 112);
+    /* [c 0 0 0 0 d 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+    d += (c & M) * R; c >>= 52;
+    VERIFY_BITS(d, 115);
+    VERIFY_BITS(c, 60);
+    /* [c 0 0 0 0 0 d 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+    t3 = d & M; d >>= 52;
+    VERIFY_BITS(t3, 52);
+    VERIFY_BITS(d, 63);
+    /* [c 0 0 0 0 d t3 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+
+    d += (uint128_t)a0 * b[4]
+       + (uint128_t)a1 * b[3]
+       + (uint128_t)a2 * b[2]
+       + (uint128_t)a3 * b[1]
+       + (uint128_t)a4 * b[0];
+    VERIFY_BITS(d, 115);
+    /* [c 0 0 0 0 d t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    d += c * R;
+    VERIFY_BITS(d, 116);
+    /* [d t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    t4 = d & M; d >>= 52;
+    VERIFY_BITS(t4, 52);
+    VERIFY_BITS(d, 64);
+    /* [d t4 t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    tx = (t4 >> 48); t4 &= (M >> 4);
+    VERIFY_BITS(tx, 4);
+    VERIFY_BITS(t4, 48);
+    /* [d t4+(tx<<48) t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+
+    c  = (uint128_t)a0 * b[0];
+    VERIFY_BITS(c, 112);
+    /* [d t4+(tx<<48) t3 0 0 c] = [p8 0 0 0 p4 p3 0 0 p0] */
+    d += (uint128_t)a1 * b[4]
+       + (uint128_t)a2 * b[3]
+       + (uint128_t)a3 * b[2]
+       + (uint128_t)a4 * b[1];
+    VERIFY_BITS(d, 115);
+    /* [d t4+(tx<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    u0 = d & M; d >>= 52;
+    VERIFY_BITS(u0, 52);
+    VERIFY_BITS(d, 63);
+    /* [d u0 t4+(tx<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    /* [d 0 t4+(tx<<48)+(u0<<52) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    u0 = (u0 << 4) | tx;
+    VERIFY_BITS(u0, 56);
+    /* [d 0 t4+(u0<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    c += (uint128_t)u0 * (R >> 4);
+    VERIFY_BITS(c, 115);
+    /* [d 0 t4 t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    r[0] = c & M; c >>= 52;
+    VERIFY_BITS(r[0], 52);
+    VERIFY_BITS(c, 61);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 0 p5 p4 p3 0 0 p0] */
+
+    c += (uint128_t)a0 * b[1]
+       + (uint128_t)a1 * b[0];
+    VERIFY_BITS(c, 114);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 0 p5 p4 p3 0 p1 p0] */
+    d += (uint128_t)a2 * b[4]
+       + (uint128_t)a3 * b[3]
+       + (uint128_t)a4 * b[2];
+    VERIFY_BITS(d, 114);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+    c += (d & M) * R; d >>= 52;
+    VERIFY_BITS(c, 115);
+    VERIFY_BITS(d, 62);
+    /* [d 0 0 t4 t3 0 c r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+    r[1] = c & M; c >>= 52;
+    VERIFY_BITS(r[1], 52);
+    VERIFY_BITS(c, 63);
+    /* [d 0 0 t4 t3 c r1 r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+
+    c += (uint128_t)a0 * b[2]
+       + (uint128_t)a1 * b[1]
+       + (uint128_t)a2 * b[0];
+    VERIFY_BITS(c, 114);
+    /* [d 0 0 t4 t3 c r1 r0] = [p8 0 p6 p5 p4 p3 p2 p1 p0] */
+    d += (uint128_t)a3 * b[4]
+       + (uint128_t)a4 * b[3];
+    VERIFY_BITS(d, 114);
+    /* [d 0 0 t4 t3 c t1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c += (d & M) * R; d >>= 52;
+    VERIFY_BITS(c, 115);
+    VERIFY_BITS(d, 62);
+    /* [d 0 0 0 t4 t3 c r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[2] = c & M; c >>= 52;
+    VERIFY_BITS(r[2], 52);
+    VERIFY_BITS(c, 63);
+    /* [d 0 0 0 t4 t3+c r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c   += d * R + t3;
+    VERIFY_BITS(c, 100);
+    /* [t4 c r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[3] = c & M; c >>= 52;
+    VERIFY_BITS(r[3], 52);
+    VERIFY_BITS(c, 48);
+    /* [t4+c r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c   += t4;
+    VERIFY_BITS(c, 49);
+    /* [c r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[4] = c;
+    VERIFY_BITS(r[4], 49);
+    /* [r4 r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+}
+
+void secp256k1_fe_sqr_inner_5x52(uint64_t *r, const uint64_t *a) {
+    uint128_t c, d;
+    uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+    int64_t t3, t4, tx, u0;
+    const uint64_t M = 0xFFFFFFFFFFFFFULL, R = 0x1000003D10ULL;
+
+    VERIFY_BITS(a[0], 56);
+    VERIFY_BITS(a[1], 56);
+    VERIFY_BITS(a[2], 56);
+    VERIFY_BITS(a[3], 56);
+    VERIFY_BITS(a[4], 52);
+
+    /**  [... a b c] is a shorthand for ... + a<<104 + b<<52 + c<<0 mod n.
+     *  px is a shorthand for sum(a[i]*a[x-i], i=0..x).
+     *  Note that [x 0 0 0 0 0] = [x*R].
+     */
+    d  = (uint128_t)(a0*2) * a3
+       + (uint128_t)(a1*2) * a2;
+    VERIFY_BITS(d, 114);
+    /* [d 0 0 0] = [p3 0 0 0] */
+    c  = (uint128_t)a4 * a4;
+    VERIFY_BITS(c, 112);
+    /* [c 0 0 0 0 d 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+    d += (c & M) * R; c >>= 52;
+    VERIFY_BITS(d, 115);
+    VERIFY_BITS(c, 60);
+    /* [c 0 0 0 0 0 d 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+    t3 = d & M; d >>= 52;
+    VERIFY_BITS(t3, 52);
+    VERIFY_BITS(d, 63);
+    /* [c 0 0 0 0 d t3 0 0 0] = [p8 0 0 0 0 p3 0 0 0] */
+
+    a4 *= 2;
+    d += (uint128_t)a0 * a4
+       + (uint128_t)(a1*2) * a3
+       + (uint128_t)a2 * a2;
+    VERIFY_BITS(d, 115);
+    /* [c 0 0 0 0 d t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    d += c * R;
+    VERIFY_BITS(d, 116);
+    /* [d t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    t4 = d & M; d >>= 52;
+    VERIFY_BITS(t4, 52);
+    VERIFY_BITS(d, 64);
+    /* [d t4 t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+    tx = (t4 >> 48); t4 &= (M >> 4);
+    VERIFY_BITS(tx, 4);
+    VERIFY_BITS(t4, 48);
+    /* [d t4+(tx<<48) t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0] */
+
+    c  = (uint128_t)a0 * a0;
+    VERIFY_BITS(c, 112);
+    /* [d t4+(tx<<48) t3 0 0 c] = [p8 0 0 0 p4 p3 0 0 p0] */
+    d += (uint128_t)a1 * a4
+       + (uint128_t)(a2*2) * a3;
+    VERIFY_BITS(d, 114);
+    /* [d t4+(tx<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    u0 = d & M; d >>= 52;
+    VERIFY_BITS(u0, 52);
+    VERIFY_BITS(d, 62);
+    /* [d u0 t4+(tx<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    /* [d 0 t4+(tx<<48)+(u0<<52) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    u0 = (u0 << 4) | tx;
+    VERIFY_BITS(u0, 56);
+    /* [d 0 t4+(u0<<48) t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    c += (uint128_t)u0 * (R >> 4);
+    VERIFY_BITS(c, 113);
+    /* [d 0 t4 t3 0 0 c] = [p8 0 0 p5 p4 p3 0 0 p0] */
+    r[0] = c & M; c >>= 52;
+    VERIFY_BITS(r[0], 52);
+    VERIFY_BITS(c, 61);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 0 p5 p4 p3 0 0 p0] */
+
+    a0 *= 2;
+    c += (uint128_t)a0 * a1;
+    VERIFY_BITS(c, 114);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 0 p5 p4 p3 0 p1 p0] */
+    d += (uint128_t)a2 * a4
+       + (uint128_t)a3 * a3;
+    VERIFY_BITS(d, 114);
+    /* [d 0 t4 t3 0 c r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+    c += (d & M) * R; d >>= 52;
+    VERIFY_BITS(c, 115);
+    VERIFY_BITS(d, 62);
+    /* [d 0 0 t4 t3 0 c r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+    r[1] = c & M; c >>= 52;
+    VERIFY_BITS(r[1], 52);
+    VERIFY_BITS(c, 63);
+    /* [d 0 0 t4 t3 c r1 r0] = [p8 0 p6 p5 p4 p3 0 p1 p0] */
+
+    c += (uint128_t)a0 * a2
+       + (uint128_t)a1 * a1;
+    VERIFY_BITS(c, 114);
+    /* [d 0 0 t4 t3 c r1 r0] = [p8 0 p6 p5 p4 p3 p2 p1 p0] */
+    d += (uint128_t)a3 * a4;
+    VERIFY_BITS(d, 114);
+    /* [d 0 0 t4 t3 c r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c += (d & M) * R; d >>= 52;
+    VERIFY_BITS(c, 115);
+    VERIFY_BITS(d, 62);
+    /* [d 0 0 0 t4 t3 c r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[2] = c & M; c >>= 52;
+    VERIFY_BITS(r[2], 52);
+    VERIFY_BITS(c, 63);
+    /* [d 0 0 0 t4 t3+c r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c   += d * R + t3;
+    VERIFY_BITS(c, 100);
+    /* [t4 c r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[3] = c & M; c >>= 52;
+    VERIFY_BITS(r[3], 52);
+    VERIFY_BITS(c, 48);
+    /* [t4+c r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    c   += t4;
+    VERIFY_BITS(c, 49);
+    /* [c r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+    r[4] = c;
+    VERIFY_BITS(r[4], 49);
+    /* [r4 r3 r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0] */
+}
+
+// 192 bit accumulator (c0,c1,c2): the 64-bit forms of the mul_add / sum_add / extract_low macros
+struct secp256k1_acc192 {
+    uint64_t c0, c1, c2;
+    explicit secp256k1_acc192(uint64_t c) : c0(c), c1(0), c2(0) {}
+
+    // Add a*b. c2 must never overflow.
+    void mul_add(uint64_t a, uint64_t b) {
+        const uint128_t t = (uint128_t)a * b;
+        uint64_t th = (uint64_t)(t >> 64), tl = (uint64_t)t;
+        c0 += tl;
+        th += (c0 < tl) ? 1 : 0;
+        c1 += th;
+        c2 += (c1 < th) ? 1 : 0;
+        VERIFY_CHECK((c1 >= th) || (c2 != 0));
+    }
+    // Add a*b. c1 must never overflow.
+    void mul_add_fast(uint64_t a, uint64_t b) {
+        const uint128_t t = (uint128_t)a * b;
+        uint64_t th = (uint64_t)(t >> 64), tl = (uint64_t)t;
+        c0 += tl;
+        th += (c0 < tl) ? 1 : 0;
+        c1 += th;
+        VERIFY_CHECK(c1 >= th);
+    }
+    // Add a. c2 must never overflow.
+    void sum_add(uint64_t a) {
+        c0 += a;
+        const unsigned int over = (c0 < a) ? 1 : 0;
+        c1 += over;
+        c2 += (c1 < over) ? 1 : 0;
+    }
+    // Add a. c1 must never overflow, c2 must be zero.
+    void sum_add_fast(uint64_t a) {
+        c0 += a;
+        c1 += (c0 < a) ? 1 : 0;
+        VERIFY_CHECK((c1 != 0) | (c0 >= a));
+        VERIFY_CHECK(c2 == 0);
+    }
+    // Extract the lowest 64 bits and shift the number right by 64 bits.
+    uint64_t extract_low() {
+        const uint64_t n = c0;
+        c0 = c1; c1 = c2; c2 = 0;
+        return n;
+    }
+    // As extract_low, c2 is required to be zero.
+    uint64_t extract_low_fast() {
+        const uint64_t n = c0;
+        c0 = c1; c1 = 0;
+        VERIFY_CHECK(c2 == 0);
+        return n;
+    }
+};
+
+// Limbs of 2^256 minus the secp256k1 order.
+constexpr uint64_t SECP256K1_N64_C_0 = ~(((uint64_t)CPubKey::SECP256K1_N_1 << 32) | CPubKey::SECP256K1_N_0) + 1;
+constexpr uint64_t SECP256K1_N64_C_1 = ~(((uint64_t)CPubKey::SECP256K1_N_3 << 32) | CPubKey::SECP256K1_N_2);
+
+inline void secp256k1_scalar_pack_4x64(uint64_t *t, const uint32_t *d, int nLimbs) {
+    for (int i = 0; i < nLimbs; ++i)
+        t[i] = d[2 * i] | ((uint64_t)d[2 * i + 1] << 32);
+}
+
+inline void secp256k1_scalar_unpack_4x64(uint32_t *d, const uint64_t *t, int nLimbs) {
+    for (int i = 0; i < nLimbs; ++i) {
+        d[2 * i] = (uint32_t)t[i];
+        d[2 * i + 1] = (uint32_t)(t[i] >> 32);
+    }
+}
+
+// l[0..7] = a[0..3] * b[0..3]
+void secp256k1_scalar_mul_512_4x64(uint64_t *l, const uint64_t *a, const uint64_t *b) {
+    for (int i = 0; i < 8; ++i)
+        l[i] = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 4; ++j) {
+            const uint128_t t = (uint128_t)a[i] * b[j] + l[i + j] + carry;
+            l[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        l[i + 4] = carry;
+    }
+}
+
+// r[0..3] + 2^256 * (return value) = l[0..7] mod n, the result is below 2^256 + n
+uint64_t secp256k1_scalar_reduce_512_4x64(uint64_t *r, const uint64_t *l) {
+    const uint64_t n0 = l[4], n1 = l[5], n2 = l[6], n3 = l[7];
+    uint64_t m0, m1, m2, m3, m4, m5, m6;
+    uint64_t p0, p1, p2, p3, p4;
+
+    /* Reduce 512 bits into 385. */
+    /* m[0..6] = l[0..3] + n[0..3] * SECP256K1_N_C. */
+    secp256k1_acc192 acc(l[0]);
+    acc.mul_add_fast(n0, SECP256K1_N64_C_0);
+    m0 = acc.extract_low_fast();
+    acc.sum_add_fast(l[1]);
+    acc.mul_add(n1, SECP256K1_N64_C_0);
+    acc.mul_add(n0, SECP256K1_N64_C_1);
+    m1 = acc.extract_low();
+    acc.sum_add(l[2]);
+    acc.mul_add(n2, SECP256K1_N64_C_0);
+    acc.mul_add(n1, SECP256K1_N64_C_1);
+    acc.sum_add(n0);
+    m2 = acc.extract_low();
+    acc.sum_add(l[3]);
+    acc.mul_add(n3, SECP256K1_N64_C_0);
+    acc.mul_add(n2, SECP256K1_N64_C_1);
+    acc.sum_add(n1);
+    m3 = acc.extract_low();
+    acc.mul_add(n3, SECP256K1_N64_C_1);
+    acc.sum_add(n2);
+    m4 = acc.extract_low();
+    acc.sum_add_fast(n3);
+    m5 = acc.extract_low_fast();
+    VERIFY_CHECK(acc.c0 <= 1);
+    m6 = acc.c0;
+
+    /* Reduce 385 bits into 258. */
+    /* p[0..4] = m[0..3] + m[4..6] * SECP256K1_N_C. */
+    secp256k1_acc192 acc2(m0);
+    acc2.mul_add_fast(m4, SECP256K1_N64_C_0);
+    p0 = acc2.extract_low_fast();
+    acc2.sum_add_fast(m1);
+    acc2.mul_add(m5, SECP256K1_N64_C_0);
+    acc2.mul_add(m4, SECP256K1_N64_C_1);
+    p1 = acc2.extract_low();
+    acc2.sum_add(m2);
+    acc2.mul_add(m6, SECP256K1_N64_C_0);
+    acc2.mul_add(m5, SECP256K1_N64_C_1);
+    acc2.sum_add(m4);
+    p2 = acc2.extract_low();
+    acc2.sum_add_fast(m3);
+    acc2.mul_add_fast(m6, SECP256K1_N64_C_1);
+    acc2.sum_add_fast(m5);
+    p3 = acc2.extract_low_fast();
+    p4 = acc2.c0 + m6;
+    VERIFY_CHECK(p4 <= 2);
+
+    /* Reduce 258 bits into 256. */
+    /* r[0..3] = p[0..3] + p[4] * SECP256K1_N_C. */
+    uint128_t c = p0 + (uint128_t)SECP256K1_N64_C_0 * p4;
+    r[0] = (uint64_t)c; c >>= 64;
+    c += p1 + (uint128_t)SECP256K1_N64_C_1 * p4;
+    r[1] = (uint64_t)c; c >>= 64;
+    c += p2 + (uint128_t)p4;
+    r[2] = (uint64_t)c; c >>= 64;
+    c += p3;
+    r[3] = (uint64_t)c; c >>= 64;
+    return (uint64_t)c;
+}
+} // namespace
+#endif // USE_WIDEMUL_INT128
+
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
 /* optimal for 128-bit and 256-bit exponents. */
@@ -884,6 +1331,7 @@ void CPubKey::ecmult::secp256k1_fe_add(secp256k1_fe *r, const secp256k1_fe *a) n
 }
 
 void CPubKey::ecmult::secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a) noexcept {
+#ifndef USE_WIDEMUL_INT128
     auto secp256k1_fe_sqr_inner = [](uint32_t *r, const uint32_t *a) {
         uint64_t c, d;
         uint64_t u0, u1, u2, u3, u4, u5, u6, u7, u8;
@@ -1157,11 +1605,19 @@ void CPubKey::ecmult::secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a) n
         VERIFY_BITS(r[2], 27);
         /* [r9 r8 r7 r6 r5 r4 r3 r2 r1 r0] = [p18 p17 p16 p15 p14 p13 p12 p11 p10 p9 p8 p7 p6 p5 p4 p3 p2 p1 p0] */
     };
+#endif
 #ifdef VERIFY
     VERIFY_CHECK(a->magnitude <= 8);
     secp256k1_fe_verify(a);
 #endif
+#ifdef USE_WIDEMUL_INT128
+    uint64_t t[5], u[5];
+    secp256k1_fe_pack_5x52(t, a->n);
+    secp256k1_fe_sqr_inner_5x52(u, t);
+    secp256k1_fe_unpack_5x52(r->n, u);
+#else
     secp256k1_fe_sqr_inner(r->n, a->n);
+#endif
 #ifdef VERIFY
     r->magnitude = 1;
     r->normalized = 0;
@@ -1170,6 +1626,7 @@ void CPubKey::ecmult::secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a) n
 }
 
 void CPubKey::ecmult::secp256k1_fe_mul(secp256k1_fe *r, const secp256k1_fe *a, const secp256k1_fe * SECP256K1_RESTRICT b) noexcept {
+#ifndef USE_WIDEMUL_INT128
     auto secp256k1_fe_mul_inner = [](uint32_t *r, const uint32_t *a, const uint32_t * SECP256K1_RESTRICT b) {
         uint64_t c, d;
         uint64_t u0, u1, u2, u3, u4, u5, u6, u7, u8;
@@ -1498,6 +1955,7 @@ void CPubKey::ecmult::secp256k1_fe_mul(secp256k1_fe *r, const secp256k1_fe *a, c
         VERIFY_BITS(r[2], 27);
         /* [r9 r8 r7 r6 r5 r4 r3 r2 r1 r0] = [p18 p17 p16 p15 p14 p13 p12 p11 p10 p9 p8 p7 p6 p5 p4 p3 p2 p1 p0] */
     };
+#endif
 #ifdef VERIFY
     VERIFY_CHECK(a->magnitude <= 8);
     VERIFY_CHECK(b->magnitude <= 8);
@@ -1505,7 +1963,15 @@ void CPubKey::ecmult::secp256k1_fe_mul(secp256k1_fe *r, const secp256k1_fe *a, c
     secp256k1_fe_verify(b);
     VERIFY_CHECK(r != b);
 #endif
+#ifdef USE_WIDEMUL_INT128
+    uint64_t ta[5], tb[5], u[5];
+    secp256k1_fe_pack_5x52(ta, a->n);
+    secp256k1_fe_pack_5x52(tb, b->n);
+    secp256k1_fe_mul_inner_5x52(u, ta, tb);
+    secp256k1_fe_unpack_5x52(r->n, u);
+#else
     secp256k1_fe_mul_inner(r->n, a->n, b->n);
+#endif
 #ifdef VERIFY
     r->magnitude = 1;
     r->normalized = 0;
@@ -1571,7 +2037,6 @@ int CPubKey::ecmult::secp256k1_fe_normalizes_to_zero(const secp256k1_fe *r) noex
     /* ... except for a possible carry at bit 22 of t9 (i.e. bit 256 of the field element) */
     VERIFY_CHECK(t9 >> 23 == 0);
 
-    DEBUGCS_CHECK((std::string("step1 z0, z1: ") + std::to_string(z0) + "," + std::to_string(z1)).c_str());
     return (z0 == 0) | (z1 == 0x3FFFFFFUL);
 }
 
@@ -1775,6 +2240,12 @@ void CPubKey::ecmult::secp256k1_gej_set_ge(secp256k1_gej *r, const secp256k1_ge
 }
 
 void CPubKey::secp256k1_scalar_sqr_512(uint32_t *l, const secp256k1_unit *a) noexcept {
+#ifdef USE_WIDEMUL_INT128
+    uint64_t ta[4], tl[8];
+    secp256k1_scalar_pack_4x64(ta, a->d, 4);
+    secp256k1_scalar_mul_512_4x64(tl, ta, ta);
+    secp256k1_scalar_unpack_4x64(l, tl, 8);
+#else
     /* 96 bit accumulator. */
     uint32_t c0 = 0, c1 = 0, c2 = 0;
 
@@ -1832,9 +2303,19 @@ void CPubKey::secp256k1_scalar_sqr_512(uint32_t *l, const secp256k1_unit *a) noe
     extract_fast(l[14]);
     VERIFY_CHECK(c1 == 0);
     l[15] = c0;
+#endif
 }
 
 void CPubKey::secp256k1_scalar_reduce_512(secp256k1_unit *r, const uint32_t *l) noexcept {
+#ifdef USE_WIDEMUL_INT128
+    uint64_t tl[8], tr[4];
+    secp256k1_scalar_pack_4x64(tl, l, 8);
+    const uint64_t c = secp256k1_scalar_reduce_512_4x64(tr, tl);
+    secp256k1_scalar_unpack_4x64(r->d, tr, 4);
+
+    /* Final reduction of r. */
+    secp256k1_scalar_reduce(r, (uint32_t)c + secp256k1_scalar_check_overflow(r));
+#else
     uint64_t c;
     uint32_t n0 = l[8], n1 = l[9], n2 = l[10], n3 = l[11], n4 = l[12], n5 = l[13], n6 = l[14], n7 = l[15];
     uint32_t m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12;
@@ -1974,6 +2455,7 @@ void CPubKey::secp256k1_scalar_reduce_512(secp256k1_unit *r, const uint32_t *l)
 
     /* Final reduction of r. */
     secp256k1_scalar_reduce(r, c + secp256k1_scalar_check_overflow(r));
+#endif
 }
 
 void CPubKey::secp256k1_scalar_sqr(secp256k1_unit *r, const secp256k1_unit *a) noexcept {
@@ -1983,6 +2465,13 @@ void CPubKey::secp256k1_scalar_sqr(secp256k1_unit *r, const secp256k1_unit *a) n
 }
 
 void CPubKey::secp256k1_scalar_mul_512(uint32_t *l, const secp256k1_unit *a, const secp256k1_unit *b) noexcept {
+#ifdef USE_WIDEMUL_INT128
+    uint64_t ta[4], tb[4], tl[8];
+    secp256k1_scalar_pack_4x64(ta, a->d, 4);
+    secp256k1_scalar_pack_4x64(tb, b->d, 4);
+    secp256k1_scalar_mul_512_4x64(tl, ta, tb);
+    secp256k1_scalar_unpack_4x64(l, tl, 8);
+#else
     /* 96 bit accumulator. */
     uint32_t c0 = 0, c1 = 0, c2 = 0;
 
@@ -2068,6 +2557,7 @@ void CPubKey::secp256k1_scalar_mul_512(uint32_t *l, const secp256k1_unit *a, con
     extract_fast(l[14]);
     VERIFY_CHECK(c1 == 0);
     l[15] = c0;
+#endif
 }
 
 void CPubKey::secp256k1_scalar_mul(secp256k1_unit *r, const secp256k1_unit *a, const secp256k1_unit *b) noexcept {
@@ -2874,8 +3364,8 @@ int CPubKey::secp256k1_ecmult(ecmult::secp256k1_gej *r, const ecmult::secp256k1_
     };
 #endif
 
-    ecmult::secp256k1_context ctx;
-    ARG_CHECK(ctx.build() != false);
+    const ecmult::secp256k1_context &ctx = ecmult::secp256k1_context::get_verify();
+    ARG_CHECK(ctx.is_built());
 
     ecmult::secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
     ecmult::secp256k1_ge tmpa;
@@ -3737,6 +4227,25 @@ bool CPubKey::ecmult::secp256k1_ecmult_odd_multiples_table_storage_var(int n, se
     return true;
 }
 
+bool CPubKey::ecmult::secp256k1_context::is_built() const noexcept {
+#ifdef USE_ENDOMORPHISM
+    return pre_g_ != nullptr && pre_g_128_ != nullptr;
+#else
+    return pre_g_ != nullptr;
+#endif
+}
+
+// The generator tables (ECMULT_TABLE_SIZE(WINDOW_G) odd multiples) cost far more to build
+// than one verification, so they are built once and only read afterwards.
+// The first call (init, before the script check threads) builds them; C++11 makes the
+// static initialization thread-safe.
+const CPubKey::ecmult::secp256k1_context &CPubKey::ecmult::secp256k1_context::get_verify() noexcept {
+    static secp256k1_context ctx_verify;
+    static const bool fBuilt = ctx_verify.build();
+    (void)fBuilt;
+    return ctx_verify;
+}
+
 CPubKey::ecmult::secp256k1_context::secp256k1_context() noexcept {
     init();
 }
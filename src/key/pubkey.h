@@ -91,6 +91,12 @@ public:
 #define USE_SCALAR_INV_BUILTIN 1
 //#define USE_FIELD_10X26 1
 //#define USE_SCALAR_8X32 1
+    // secp256k1_fe and secp256k1_unit keep the 10x26 / 8x32 layout. Where the compiler has a
+    // 128-bit integer, the field and scalar products run on 5x52 / 4x64 limbs instead.
+    // (define USE_FORCE_WIDEMUL_INT64 to keep the 32-bit limb products)
+#if defined(__SIZEOF_INT128__) && !defined(USE_FORCE_WIDEMUL_INT64)
+# define USE_WIDEMUL_INT128 1
+#endif
 
     static constexpr int CURVE_B = 7;
 
@@ -208,6 +214,8 @@ public:
             void init() noexcept;
             bool build() noexcept;
             void clear() noexcept;
+            bool is_built() const noexcept;
+            static const secp256k1_context &get_verify() noexcept; // shared by all verifiers, built once
             secp256k1_context() noexcept;
             secp256k1_context(const secp256k1_context &)=delete;
             secp256k1_context(secp256k1_context &&)=delete;
@@ -433,6 +441,8 @@ public:
     // [OpenSSL] If this public key is not fully valid, the return value will be false.
     bool Verify(const uint256 &hash, const key_vector &vchSig) const noexcept;
     bool Verify_BIP66(const uint256 &hash, const key_vector &vchSig) const noexcept;
+    bool Verify(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen) const noexcept;
+    bool Verify_BIP66(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen) const noexcept;
 
     // Check whether a signature is normalized (lower-S). [libsecp256k1]
     static bool CheckLowS(const std::vector<unsigned char> &vchSig) noexcept;
@@ -95,7 +95,7 @@ int CTxIndex::GetDepthInMainChain() const noexcept
     }
 
     // Find the block in the index
-    std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(block.GetHash());
+    BlockMap::iterator mi = block_info::mapBlockIndex.find(block.GetHash());
     if (mi == block_info::mapBlockIndex.end()) {
         return 0;
     }
@@ -387,12 +387,7 @@ private:
         //
         // block headers
         //
-        std::map<uint256, CBlockIndex *>::iterator it1 = block_info::mapBlockIndex.begin();
-        for (; it1 != block_info::mapBlockIndex.end(); it1++)
-        {
-            delete (*it1).second;
-        }
-        block_info::mapBlockIndex.clear();
+        block_info::mapBlockIndex.clear(); // also frees the CBlockIndex arena
 
         //
         // orphan blocks
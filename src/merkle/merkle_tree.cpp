@@ -7,9 +7,33 @@
 #include <merkle/merkle_tree.h>
 #include <uint256.h>
 #include <block/transaction.h>
+#include <crypto/sha256.h>
 
 template <typename T, typename SRC>
 T CMerkleTree<T, SRC>::BuildMerkleTree() const {
+    static_assert(sizeof(T) == latest_crypto::CSHA256::OUTPUT_SIZE, "CMerkleTree: SHA256D64 requires 32-byte nodes");
+    vMerkleTree.clear();
+    vMerkleTree.reserve(vtx.size() * 2 + 16);
+    for(const SRC &tx: vtx) vMerkleTree.push_back(tx.GetHash());
+    int j=0;
+    for (int nSize=(int)vtx.size(); nSize>1; nSize=(nSize+1)/2) {
+        // Each level is hashed in one SHA256D64 call, which runs the 8/4/2-way kernels
+        // selected by SHA256AutoDetect. Adjacent nodes already form the 64-byte inputs;
+        // an odd last node is paired with itself.
+        const int nPairs = nSize / 2;
+        vMerkleTree.resize(j + nSize + (nSize + 1) / 2);
+        latest_crypto::SHA256D64((unsigned char *)&vMerkleTree[j + nSize], (const unsigned char *)&vMerkleTree[j], nPairs);
+        if (nSize & 1) {
+            const T &last = vMerkleTree[j + nSize - 1];
+            vMerkleTree[j + nSize + nPairs] = hash_basis::Hash(BEGIN(last), END(last), BEGIN(last), END(last));
+        }
+        j+=nSize;
+    }
+    return (vMerkleTree.empty()? 0: vMerkleTree.back());
+}
+
+template <typename T, typename SRC>
+T CMerkleTree<T, SRC>::BuildMerkleTreeScalar() const {
     vMerkleTree.clear();
     for(const SRC &tx: vtx) vMerkleTree.push_back(tx.GetHash());
     int j=0;
@@ -36,6 +36,7 @@ protected:
 
 public:
     T BuildMerkleTree() const;
+    T BuildMerkleTreeScalar() const; // pairwise reference path (bench and verification)
     vMerkle_t GetMerkleBranch(int nIndex) const;
     static T CheckMerkleBranch(T hash, const vMerkle_t &vMerkleBranch, int nIndex);
 };
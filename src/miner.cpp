@@ -12,11 +12,19 @@
 #include <block/block_process.h>
 #include <miner/diff.h>
 #include <util/thread.h>
+#include <util/time.h>
+#include <boost/thread/thread.hpp>
 
 const unsigned int miner::pSHA256InitState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
 unsigned int miner::nMaxStakeSearchInterval = 60;
 uint64_t miner::nStakeInputsMapSize = 0;
 int64_t miner::nReserveBalance = 0;
+int miner::nStakeMinerThreads = 1;
+CCriticalSection miner::cs_KernelWorkerStats;
+std::vector<miner::kernel_worker_stats> miner::vKernelWorkerStats;
+std::map<uint256, miner::stake_tx_pos> miner::mapStakeTxPos;
+CCriticalSection miner::cs_StakeTxChanged;
+std::set<uint256> miner::setStakeTxChanged;
 
 int miner::FormatHashBlocks(void *pbuffer, unsigned int len)
 {
@@ -584,7 +592,7 @@ bool miner::CheckStake(CBlock *pblock, CWallet &wallet)
 }
 
 //
-// Fill the inputs map with precalculated contexts and metadata
+// Update the inputs map with precalculated contexts and metadata
 //
 bool miner::FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMap)
 {
@@ -594,8 +602,15 @@ bool miner::FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMa
         return false;
     }
 
+    struct stake_coin {
+        MidstateMap::key_type key;
+        uint32_t nTime;
+        int64_t nValue;
+    };
+    std::vector<stake_coin> vNewCoins;      // selected, not in the map yet
+    std::vector<uint256> vNewTx;            // their transactions without a cached block position
+
     uint32_t nTime = bitsystem::GetAdjustedTime();
-    CTxDB txdb("r");
     {
         LOCK2(block_process::cs_main, pwallet->cs_wallet);
 
@@ -608,12 +623,23 @@ bool miner::FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMa
             return false;
         }
 
-        CBlock block;
-        CTxIndex txindex;
+        // Cached positions of transactions no longer in the main chain (reorganize)
+        for (std::map<uint256, stake_tx_pos>::iterator it = mapStakeTxPos.begin(); it != mapStakeTxPos.end();)
+        {
+            BlockMap::const_iterator mi = block_info::mapBlockIndex.find(it->second.hashBlock);
+            if (mi != block_info::mapBlockIndex.end() && mi->second->IsInMainChain()) {
+                ++it;
+                continue;
+            }
+            inputsMap.erase(inputsMap.lower_bound(std::make_pair(it->first, 0U)), inputsMap.upper_bound(std::make_pair(it->first, std::numeric_limits<unsigned int>::max())));
+            mapStakeTxPos.erase(it++);
+        }
 
+        std::set<MidstateMap::key_type> setSelected;
         for (CoinsSet::const_iterator pcoin = setCoins.begin(); pcoin != setCoins.end(); pcoin++)
         {
             std::pair<uint256, uint32_t> key = std::make_pair(pcoin->first->GetHash(), pcoin->second);
+            setSelected.insert(key);
 
             // Skip existent inputs
             if (inputsMap.find(key) != inputsMap.end()) {
@@ -632,8 +658,47 @@ bool miner::FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMa
                 continue;
             }
 
+            stake_coin coin;
+            coin.key = key;
+            coin.nTime = pcoin->first->get_nTime();
+            coin.nValue = pcoin->first->get_vout(pcoin->second).get_nValue();
+            vNewCoins.push_back(coin);
+            if (mapStakeTxPos.find(key.first) == mapStakeTxPos.end() && (vNewTx.empty() || vNewTx.back() != key.first)) {
+                vNewTx.push_back(key.first);
+            }
+        }
+
+        // Drop inputs that are no longer selected (spent, or above the reserve balance)
+        for (MidstateMap::iterator it = inputsMap.begin(); it != inputsMap.end();)
+        {
+            if (setSelected.count(it->first)) {
+                ++it;
+            } else {
+                inputsMap.erase(it++);
+            }
+        }
+
+        // ... and the cached positions of transactions none of whose outputs are selected
+        for (std::map<uint256, stake_tx_pos>::iterator it = mapStakeTxPos.begin(); it != mapStakeTxPos.end();)
+        {
+            std::set<MidstateMap::key_type>::const_iterator mi = setSelected.lower_bound(std::make_pair(it->first, 0U));
+            if (mi != setSelected.end() && mi->first == it->first) {
+                ++it;
+            } else {
+                mapStakeTxPos.erase(it++);
+            }
+        }
+    }
+
+    // Block positions of new transactions, read without holding cs_main
+    if (! vNewTx.empty()) {
+        CTxDB txdb("r");
+        CBlock block;
+        CTxIndex txindex;
+        for (const uint256 &hashTx: vNewTx)
+        {
             // Load transaction index item
-            if (! txdb.ReadTxIndex(pcoin->first->GetHash(), txindex)) {
+            if (! txdb.ReadTxIndex(hashTx, txindex)) {
                 continue;
             }
 
@@ -642,36 +707,114 @@ bool miner::FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMa
                 continue;
             }
 
+            stake_tx_pos pos;
+            pos.hashBlock = block.GetHash();
+            pos.nBlockTime = block.get_nTime();
+            pos.nTxOffset = txindex.get_pos().get_nTxPos() - txindex.get_pos().get_nBlockPos();
+            mapStakeTxPos[hashTx] = pos;
+        }
+    }
+
+    {
+        LOCK(block_process::cs_main);
+        for (const stake_coin &coin: vNewCoins)
+        {
+            std::map<uint256, stake_tx_pos>::const_iterator mi = mapStakeTxPos.find(coin.key.first);
+            if (mi == mapStakeTxPos.end()) {
+                continue;
+            }
+            const stake_tx_pos &pos = mi->second;
+
             // Only load coins meeting min age requirement
-            if (block_check::nStakeMinAge + block.get_nTime() > nTime - nMaxStakeSearchInterval) {
+            if (block_check::nStakeMinAge + pos.nBlockTime > nTime - nMaxStakeSearchInterval) {
                 continue;
             }
 
             // Get stake modifier
             uint64_t nStakeModifier = 0;
-            if (! bitkernel<uint256>::GetKernelStakeModifier(block.GetHash(), nStakeModifier)) {
+            if (! bitkernel<uint256>::GetKernelStakeModifier(pos.hashBlock, nStakeModifier)) {
                 continue;
             }
 
             // Build static part of kernel
             CDataStream ssKernel(SER_GETHASH, 0);
             ssKernel << nStakeModifier;
-            ssKernel << block.get_nTime() << (txindex.get_pos().get_nTxPos() - txindex.get_pos().get_nBlockPos()) << pcoin->first->get_nTime() << pcoin->second;
+            ssKernel << pos.nBlockTime << pos.nTxOffset << coin.nTime << coin.key.second;
 
             // (txid, vout.n) => (kernel, (tx.nTime, nAmount))
-            inputsMap[key] = std::make_pair(std::vector<unsigned char>(ssKernel.begin(), ssKernel.end()), std::make_pair(pcoin->first->get_nTime(), pcoin->first->get_vout(pcoin->second).get_nValue()));
+            inputsMap[coin.key] = std::make_pair(std::vector<unsigned char>(ssKernel.begin(), ssKernel.end()), std::make_pair(coin.nTime, coin.nValue));
         }
+    }
 
-        nStakeInputsMapSize = inputsMap.size();
+    nStakeInputsMapSize = inputsMap.size();
 
-        if (args_bool::fDebug) {
-            logging::LogPrintf("FillMap() : Map of %" PRIu64 " precalculated contexts has been created by stake miner\n", nStakeInputsMapSize);
-        }
+    if (args_bool::fDebug) {
+        logging::LogPrintf("FillMap() : Map of %" PRIu64 " precalculated contexts (%" PRIu64 " new, %" PRIu64 " block positions read)\n", nStakeInputsMapSize, (uint64_t)vNewCoins.size(), (uint64_t)vNewTx.size());
     }
 
     return true;
 }
 
+void miner::NotifyStakeTxChanged(CWallet *wallet, const uint256 &hashTx, ChangeType status)
+{
+    LOCK(cs_StakeTxChanged);
+    setStakeTxChanged.insert(hashTx);
+}
+
+//
+// Drop the inputs of changed wallet transactions that have been spent or removed
+//
+void miner::UpdateMap(CWallet *pwallet, MidstateMap &inputsMap)
+{
+    std::set<uint256> setChanged;
+    {
+        LOCK(cs_StakeTxChanged);
+        setChanged.swap(setStakeTxChanged);
+    }
+    if (setChanged.empty()) {
+        return;
+    }
+
+    LOCK(pwallet->cs_wallet);
+    for (MidstateMap::iterator it = inputsMap.begin(); it != inputsMap.end();)
+    {
+        if (setChanged.count(it->first.first)) {
+            std::map<uint256, CWalletTx>::const_iterator mi = pwallet->mapWallet.find(it->first.first);
+            if (mi == pwallet->mapWallet.end() || mi->second.IsSpent(it->first.second)) {
+                inputsMap.erase(it++);
+                continue;
+            }
+        }
+        ++it;
+    }
+    nStakeInputsMapSize = inputsMap.size();
+}
+
+//
+// One kernel worker of ScanMap
+//
+void miner::ScanShard(const std::vector<MidstateMap::const_iterator> &vInputs, size_t nWorker, size_t nThreads, uint32_t nBits, std::pair<uint32_t, uint32_t> interval, std::atomic<bool> &fFound, kernel_shard &shard)
+{
+    bitthread::SetThreadPriority(THREAD_PRIORITY_LOWEST);
+
+    // (txid, nout) => (kernel, (tx.nTime, nAmount))
+    for(size_t i = nWorker; i < vInputs.size() && !fFound.load(std::memory_order_relaxed); i += nThreads)
+    {
+        const MidstateMap::const_iterator &input = vInputs[i];
+        unsigned char *kernel = (unsigned char *)&input->second.first[0];
+        ++shard.nInputs;
+
+        // scan(State, Bits, Time, Amount, ...)
+        if (KernelWorker::ScanKernelBackward(kernel, nBits, input->second.second.first, input->second.second.second, interval, shard.solution, fFound, shard.nHashes)) {
+            // Solution found: cancel the other workers
+            shard.fSolved = true;
+            shard.LuckyInput = input->first; // (txid, nout)
+            fFound.store(true);
+            return;
+        }
+    }
+}
+
 //
 // Scan inputs map in order to find a solution
 //
@@ -685,16 +828,52 @@ bool miner::ScanMap(const MidstateMap &inputsMap, uint32_t nBits, MidstateMap::k
         interval.first = nSearchTime;
         interval.second = nSearchTime - std::min(nSearchTime - nLastCoinStakeSearchTime, nMaxStakeSearchInterval);
 
-        // (txid, nout) => (kernel, (tx.nTime, nAmount))
-        for(MidstateMap::const_iterator input = inputsMap.begin(); input != inputsMap.end(); input++)
+        // Partition the inputs map across the kernel workers
+        std::vector<MidstateMap::const_iterator> vInputs;
+        vInputs.reserve(inputsMap.size());
+        for(MidstateMap::const_iterator input = inputsMap.begin(); input != inputsMap.end(); ++input)
+            vInputs.push_back(input);
+
+        const size_t nThreads = std::max<size_t>(1, std::min<size_t>(nStakeMinerThreads, vInputs.size()));
+        std::vector<kernel_shard> vShards(nThreads);
+        std::atomic<bool> fFound(false);
+        const int64_t nStart = util::GetTimeMicros();
         {
-            unsigned char *kernel = (unsigned char *)&input->second.first[0];
+            // a worker that cannot be started leaves its shard to this thread
+            boost::thread_group group;
+            size_t nStarted = 1;
+            try {
+                for(; nStarted < nThreads; ++nStarted)
+                    group.create_thread(boost::bind(&miner::ScanShard, boost::cref(vInputs), nStarted, nThreads, nBits, interval, boost::ref(fFound), boost::ref(vShards[nStarted])));
+            } catch (const boost::thread_resource_error &e) {
+                static bool fLogged = false;
+                if (! fLogged) {
+                    logging::LogPrintf("ScanMap() : started %" PRIszu " of %" PRIszu " kernel workers (%s), scanning the rest serially\n", nStarted - 1, nThreads - 1, e.what());
+                    fLogged = true;
+                }
+            }
+            ScanShard(vInputs, 0, nThreads, nBits, interval, fFound, vShards[0]);
+            for(size_t i = nStarted; i < nThreads; ++i)
+                ScanShard(vInputs, i, nThreads, nBits, interval, fFound, vShards[i]);
+            group.join_all();
+        }
+        const double dTime = std::max<int64_t>(util::GetTimeMicros() - nStart, 1) / 1000000.0;
 
-            // scan(State, Bits, Time, Amount, ...)
-            if (KernelWorker::ScanKernelBackward(kernel, nBits, input->second.second.first, input->second.second.second, interval, solution)) {
-                // Solution found
-                LuckyInput = input->first; // (txid, nout)
+        {
+            LOCK(cs_KernelWorkerStats);
+            vKernelWorkerStats.assign(nThreads, kernel_worker_stats());
+            for(size_t i = 0; i < nThreads; ++i) {
+                vKernelWorkerStats[i].nInputs = vShards[i].nInputs;
+                vKernelWorkerStats[i].nHashes = vShards[i].nHashes;
+                vKernelWorkerStats[i].dKernelsPerSec = vShards[i].nHashes / dTime;
+            }
+        }
 
+        for(const kernel_shard &shard: vShards) {
+            if (shard.fSolved) {
+                // Solution found
+                LuckyInput = shard.LuckyInput;
+                solution = shard.solution;
                 return true;
             }
         }
@@ -709,6 +888,21 @@ bool miner::ScanMap(const MidstateMap &inputsMap, uint32_t nBits, MidstateMap::k
     return false;
 }
 
+std::vector<miner::kernel_worker_stats> miner::GetKernelWorkerStats()
+{
+    LOCK(cs_KernelWorkerStats);
+    return vKernelWorkerStats;
+}
+
+double miner::GetKernelsPerSec()
+{
+    LOCK(cs_KernelWorkerStats);
+    double dKernelsPerSec = 0.0;
+    for(const kernel_worker_stats &stats: vKernelWorkerStats)
+        dKernelsPerSec += stats.dKernelsPerSec;
+    return dKernelsPerSec;
+}
+
 void miner::ThreadStakeMiner(void *parg)
 {
     bitthread::SetThreadPriority(THREAD_PRIORITY_LOWEST);
@@ -721,6 +915,7 @@ void miner::ThreadStakeMiner(void *parg)
     if (! FillMap(pwallet, bitsystem::GetAdjustedTime(), inputsMap)) {
         return;
     }
+    pwallet->NotifyTransactionChanged.connect(&miner::NotifyStakeTxChanged);
 
     CBlockIndex *pindexPrev = block_info::pindexBest;
     uint32_t nBits = diff::spacing::GetNextTargetRequired(pindexPrev, true);
@@ -759,6 +954,7 @@ void miner::ThreadStakeMiner(void *parg)
                     continue;
                 }
             }
+            UpdateMap(pwallet, inputsMap);
             if (ScanMap(inputsMap, nBits, LuckyInput, solution)) {
                 bitthread::SetThreadPriority(THREAD_PRIORITY_NORMAL);
                 inputsMap.erase(inputsMap.find(LuckyInput));
@@ -820,5 +1016,6 @@ _endloop:
         excep::PrintException(NULL, "ThreadStakeMinter()");
     }
 
+    pwallet->NotifyTransactionChanged.disconnect(&miner::NotifyStakeTxChanged);
     logging::LogPrintf("ThreadStakeMinter exiting, %d threads remaining\n", net_node::vnThreadsRunning[THREAD_MINTER]);
 }
@@ -9,6 +9,7 @@
 
 #include "main.h"
 #include "wallet.h"
+#include <atomic>
 
 class miner : private no_instance
 {
@@ -38,19 +39,78 @@ private:
     static void SHA256Transform(void *pstate, void *pinput, const void *pinit);
 
     //
-    // Fill the inputs map with precalculated contexts and metadata
+    // Block position of a staked transaction: kept in memory across FillMap passes
+    // (ReadTxIndex and the block header read happen once per transaction)
+    //
+    struct stake_tx_pos {
+        uint256 hashBlock;
+        uint32_t nBlockTime;
+        uint32_t nTxOffset;
+    };
+    static std::map<uint256, stake_tx_pos> mapStakeTxPos;
+
+    //
+    // Wallet transactions changed since the last pass (NotifyTransactionChanged)
+    //
+    static CCriticalSection cs_StakeTxChanged;
+    static std::set<uint256> setStakeTxChanged;
+    static void NotifyStakeTxChanged(CWallet *wallet, const uint256 &hashTx, ChangeType status);
+
+    //
+    // Update the inputs map with precalculated contexts and metadata
+    // (new block: coin selection, new inputs added, unselected inputs dropped)
     //
     static bool FillMap(CWallet *pwallet, uint32_t nUpperTime, MidstateMap &inputsMap);
 
+    //
+    // Drop the inputs of changed wallet transactions that have been spent or removed
+    //
+    static void UpdateMap(CWallet *pwallet, MidstateMap &inputsMap);
+
     //
     // Scan inputs map in order to find a solution
     //
     static bool ScanMap(const MidstateMap &inputsMap, uint32_t nBits, MidstateMap::key_type &LuckyInput, std::pair<uint256, uint32_t> &solution);
 
+    //
+    // One kernel worker of ScanMap: inputs nWorker, nWorker + nThreads, ... of vInputs
+    //
+    struct kernel_shard {
+        bool fSolved;
+        MidstateMap::key_type LuckyInput;
+        std::pair<uint256, uint32_t> solution;
+        uint64_t nInputs;
+        uint64_t nHashes;
+        kernel_shard() : fSolved(false), nInputs(0), nHashes(0) {}
+    };
+    static void ScanShard(const std::vector<MidstateMap::const_iterator> &vInputs, size_t nWorker, size_t nThreads, uint32_t nBits, std::pair<uint32_t, uint32_t> interval, std::atomic<bool> &fFound, kernel_shard &shard);
+
+public:
+    //
+    // Kernel worker statistics of the last ScanMap pass
+    //
+    struct kernel_worker_stats {
+        uint64_t nInputs;           // inputs scanned
+        uint64_t nHashes;           // kernel hashes computed
+        double dKernelsPerSec;      // nHashes over the pass time
+        kernel_worker_stats() : nInputs(0), nHashes(0), dKernelsPerSec(0.0) {}
+    };
+
+private:
+    static CCriticalSection cs_KernelWorkerStats;
+    static std::vector<kernel_worker_stats> vKernelWorkerStats;
+
 public:
     static int64_t nReserveBalance;
     static uint64_t nStakeInputsMapSize;
 
+    //
+    // Kernel workers of the stake miner (-stakeminerthreads, default 1, 0 = all cores)
+    //
+    static int nStakeMinerThreads;
+    static std::vector<kernel_worker_stats> GetKernelWorkerStats();
+    static double GetKernelsPerSec();
+
     //
     // Generate a new block, without valid proof-of-work/with provided proof-of-stake
     //
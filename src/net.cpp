@@ -20,6 +20,9 @@
 #ifdef WIN32
 # include <string.h>
 #endif
+#if defined(__linux__)
+# include <sys/epoll.h>
+#endif
 #ifdef USE_UPNP
 # include <miniwget.h>
 # include <miniupnpc.h>
@@ -72,6 +75,12 @@ uint64_t bitsocket::nLocalHostNonce = 0;
 boost::array<int, THREAD_MAX> net_node::vnThreadsRunning;
 CAddrMan net_node::addrman;
 std::vector<CNode *> net_node::vNodes;
+CSocketPoller net_node::socketPoller;
+boost::mutex net_node::csMsgWake;
+boost::condition_variable net_node::condMsgWake;
+bool net_node::fMsgWake = false;
+CCriticalSection net_node::cs_msgStats;
+net_node::message_handler_stats net_node::msgStats = {};
 std::map<CInv, CDataStream> net_node::mapRelay;
 CCriticalSection net_node::cs_mapRelay;
 std::deque<std::pair<int64_t, CInv> > net_node::vRelayExpiration;
@@ -647,6 +656,11 @@ CNode *net_node::ConnectNode(CAddress addrConnect, const char *pszDest/*=nullptr
     SOCKET hSocket;
     if(pszDest ? netbase::manage::ConnectSocketByName(addrConnect, hSocket, pszDest, net_basis::GetDefaultPort(CONNECT_NODE, nullptr, pszDest)) : netbase::manage::ConnectSocket(addrConnect, hSocket)) {
         net_node::addrman.Attempt(addrConnect);
+        if(!net_node::socketPoller.IsEpoll() && !IsSelectableSocket(hSocket)) {
+            logging::LogPrintf("connection to %s dropped: non-selectable socket\n", pszDest ? pszDest : addrConnect.ToString().c_str());
+            netbase::manage::CloseSocket(hSocket);
+            return nullptr;
+        }
 
         /// debug print
         logging::LogPrintf("connected %s\n", pszDest ? pszDest : addrConnect.ToString().c_str());
@@ -679,6 +693,9 @@ CNode *net_node::ConnectNode(CAddress addrConnect, const char *pszDest/*=nullptr
             LOCK(net_node::cs_vNodes);
             net_node::vNodes.push_back(pnode);
         }
+        if(net_node::socketPoller.IsEpoll()) {
+            net_node::socketPoller.Add(hSocket, pnode);
+        }
 
         pnode->nTimeConnected = bitsystem::GetTime();
         return pnode;
@@ -692,6 +709,10 @@ void CNode::CloseSocketDisconnect()
     fDisconnect = true;
     if(hSocket != INVALID_SOCKET) {
         logging::LogPrintf("disconnecting node %s\n", addrName.c_str());
+        // unregister while the descriptor can't be reused by another socket
+        if(net_node::socketPoller.IsEpoll()) {
+            net_node::socketPoller.Remove(nPollId);
+        }
         netbase::manage::CloseSocket(hSocket);
         vRecv.clear();
     }
@@ -710,6 +731,214 @@ void CNode::CloseSocketDisconnect()
 
 void CNode::Cleanup() {}
 
+// vSend has data (cs_vSend held): ask the epoll poller for write readiness
+void CNode::PollSend()
+{
+    if(! fPollSend && hSocket != INVALID_SOCKET && net_node::socketPoller.IsEpoll()) {
+        fPollSend = true;
+        net_node::socketPoller.WantSend(nPollId, true);
+    }
+}
+
+// vRecv starts with a whole message, or with bytes ProcessMessages will skip (cs_vRecv held)
+bool CNode::HasCompleteMessage()
+{
+    const unsigned int nHeaderSize = CMessageHeader::GetChecksumOffset() + sizeof(uint32_t);
+    if(vRecv.size() < nHeaderSize) {
+        return false;
+    }
+    if(::memcmp(&vRecv[0], block_info::gpchMessageStart, sizeof(block_info::gpchMessageStart)) != 0) {
+        return true;
+    }
+    uint32_t nSize = 0;
+    std::memcpy(&nSize, &vRecv[CMessageHeader::GetMessageSizeOffset()], sizeof(nSize));
+    return vRecv.size() - nHeaderSize >= nSize;
+}
+
+void net_node::WakeMessageHandler(CNode *pnode)
+{
+    if(! pnode->fMsgReady.exchange(true)) {
+        boost::lock_guard<boost::mutex> lock(net_node::csMsgWake);
+        net_node::fMsgWake = true;
+        net_node::condMsgWake.notify_one();
+    }
+}
+
+net_node::message_handler_stats net_node::GetMessageHandlerStats()
+{
+    LOCK(net_node::cs_msgStats);
+    return net_node::msgStats;
+}
+
+CSocketPoller::CSocketPoller() : hEpoll(-1), nNextId(0) {}
+
+CSocketPoller::~CSocketPoller()
+{
+#if defined(__linux__)
+    if(hEpoll != -1) {
+        ::close(hEpoll);
+    }
+#endif
+}
+
+bool CSocketPoller::Init(bool fUseEpoll)
+{
+#if defined(__linux__)
+    if(fUseEpoll && hEpoll == -1) {
+        hEpoll = ::epoll_create1(EPOLL_CLOEXEC);
+        if(hEpoll == -1) {
+            logging::LogPrintf("CSocketPoller::Init() : epoll_create1 failed, error %d, using select\n", errno);
+        }
+    }
+#else
+    (void)fUseEpoll;
+#endif
+    return IsEpoll();
+}
+
+// 0: not registered
+uint64_t CSocketPoller::Add(SOCKET hSocket, CNode *pnode)
+{
+#if defined(__linux__)
+    LOCK(cs);
+    const uint64_t nId = ++nNextId;
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (pnode ? EPOLLOUT: 0);
+    ev.data.u64 = nId;
+    if(pnode) {
+        pnode->nPollId = nId;
+    }
+    if(::epoll_ctl(hEpoll, EPOLL_CTL_ADD, hSocket, &ev) == -1) {
+        logging::LogPrintf("CSocketPoller::Add() : epoll_ctl failed, error %d\n", errno);
+        return 0;
+    }
+    entry &e = mapSocket[nId];
+    e.hSocket = hSocket;
+    e.pnode = pnode;
+    return nId;
+#else
+    (void)hSocket;
+    (void)pnode;
+    return 0;
+#endif
+}
+
+// before the socket is closed
+void CSocketPoller::Remove(uint64_t nId)
+{
+#if defined(__linux__)
+    LOCK(cs);
+    std::map<uint64_t, entry>::iterator mi = mapSocket.find(nId);
+    if(mi != mapSocket.end()) {
+        (void)::epoll_ctl(hEpoll, EPOLL_CTL_DEL, mi->second.hSocket, nullptr);
+        mapSocket.erase(mi);
+    }
+    mapReady.erase(nId);
+#else
+    (void)nId;
+#endif
+}
+
+void CSocketPoller::WantSend(uint64_t nId, bool fSend)
+{
+#if defined(__linux__)
+    // under cs: a registration found here has not been removed, so its fd is still open
+    LOCK(cs);
+    std::map<uint64_t, entry>::const_iterator mi = mapSocket.find(nId);
+    if(mi == mapSocket.end()) {
+        return;
+    }
+    // the MOD re-arms the edge: an already writable socket is reported at once
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (fSend ? EPOLLOUT: 0);
+    ev.data.u64 = nId;
+    (void)::epoll_ctl(hEpoll, EPOLL_CTL_MOD, mi->second.hSocket, &ev);
+#else
+    (void)nId;
+    (void)fSend;
+#endif
+}
+
+void CSocketPoller::Wait(int nTimeout)
+{
+#if defined(__linux__)
+    struct epoll_event events[256];
+    const int nEvents = ::epoll_wait(hEpoll, events, sizeof(events) / sizeof(events[0]), nTimeout);
+    if(nEvents == -1) {
+        if(errno != EINTR) {
+            logging::LogPrintf("socket epoll_wait error %d\n", errno);
+            util::Sleep(nTimeout);
+        }
+        return;
+    }
+
+    LOCK(cs);
+    for(int i = 0; i < nEvents; ++i)
+    {
+        const uint64_t nId = events[i].data.u64;
+        if(! mapSocket.count(nId)) {
+            continue;
+        }
+        int nFlags = 0;
+        if(events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            nFlags |= POLL_RECV;
+        }
+        if(events[i].events & EPOLLOUT) {
+            nFlags |= POLL_SEND;
+        }
+        mapReady[nId] |= nFlags;
+    }
+#else
+    util::Sleep(nTimeout);
+#endif
+}
+
+bool CSocketPoller::HasReady() const
+{
+    LOCK(cs);
+    return !mapReady.empty();
+}
+
+void CSocketPoller::GetReady(std::vector<std::pair<uint64_t, SOCKET> > &vListenReady, std::vector<CNode *> &vNodesReady) const
+{
+    LOCK(cs);
+    vListenReady.clear();
+    vNodesReady.clear();
+    for(const std::pair<const uint64_t, int> &ready: mapReady)
+    {
+        std::map<uint64_t, entry>::const_iterator mi = mapSocket.find(ready.first);
+        if(mi == mapSocket.end()) {
+            continue;
+        }
+        if(mi->second.pnode) {
+            vNodesReady.push_back(mi->second.pnode);
+        } else {
+            vListenReady.push_back(std::make_pair(ready.first, mi->second.hSocket));
+        }
+    }
+}
+
+int CSocketPoller::GetReady(uint64_t nId) const
+{
+    LOCK(cs);
+    std::map<uint64_t, int>::const_iterator mi = mapReady.find(nId);
+    return (mi != mapReady.end()) ? mi->second: 0;
+}
+
+void CSocketPoller::ClearReady(uint64_t nId, int nFlags)
+{
+    LOCK(cs);
+    std::map<uint64_t, int>::iterator mi = mapReady.find(nId);
+    if(mi != mapReady.end()) {
+        mi->second &= ~nFlags;
+        if(mi->second == 0) {
+            mapReady.erase(mi);
+        }
+    }
+}
+
 void CNode::PushVersion()
 {
     int64_t nTime = bitsystem::GetAdjustedTime();
@@ -833,83 +1062,313 @@ void net_node::ThreadSocketHandler(void *parg)
 //
 // static std::list<CNode *> vNodesDisconnected;
 //
-void net_node::ThreadSocketHandler2(void *parg)
+void net_node::DisconnectNodes(size_t &nPrevNodeCount)
 {
-    auto Release = [](CNode *node) {
-        node->Release();
-    };
-
-    logging::LogPrintf("net_node::ThreadSocketHandler started\n");
-
-    size_t nPrevNodeCount = 0;
-    for( ; ; )
     {
-        //
-        // Disconnect nodes
-        //
+        LOCK(net_node::cs_vNodes);
+        // Disconnect unused nodes
+        std::vector<CNode *> vNodesCopy = net_node::vNodes;
+        for(CNode *pnode: vNodesCopy)
         {
-            LOCK(net_node::cs_vNodes);
-            // Disconnect unused nodes
-            std::vector<CNode *> vNodesCopy = net_node::vNodes;
-            for(CNode *pnode: vNodesCopy)
-            {
-                if(pnode->fDisconnect ||
-                    (pnode->GetRefCount() <= 0 && pnode->vRecv.empty() && pnode->vSend.empty())) {
+            if(pnode->fDisconnect ||
+                (pnode->GetRefCount() <= 0 && pnode->vRecv.empty() && pnode->vSend.empty())) {
 
-                    // remove from vNodes
-                    net_node::vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
+                // remove from vNodes
+                net_node::vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
 
-                    // release outbound grant (if any)
-                    pnode->grantOutbound.Release();
+                // release outbound grant (if any)
+                pnode->grantOutbound.Release();
 
-                    // close socket and cleanup
-                    pnode->CloseSocketDisconnect();
-                    pnode->Cleanup();
+                // close socket and cleanup
+                pnode->CloseSocketDisconnect();
+                pnode->Cleanup();
 
-                    // hold in disconnected pool until all refs are released
-                    pnode->nReleaseTime = std::max(pnode->nReleaseTime, bitsystem::GetTime() + 15 * 60);
-                    if(pnode->fNetworkNode || pnode->fInbound) {
-                        pnode->Release();
-                    }
-
-                    vNodesDisconnected.push_back(pnode);
+                // hold in disconnected pool until all refs are released
+                pnode->nReleaseTime = std::max(pnode->nReleaseTime, bitsystem::GetTime() + 15 * 60);
+                if(pnode->fNetworkNode || pnode->fInbound) {
+                    pnode->Release();
                 }
+
+                vNodesDisconnected.push_back(pnode);
             }
+        }
 
-            // Delete disconnected nodes
-            std::list<CNode *> vNodesDisconnectedCopy = vNodesDisconnected;
-            for(CNode *pnode: vNodesDisconnectedCopy)
-            {
-                // wait until threads are done using it
-                if(pnode->GetRefCount() <= 0) {
-                    bool fDelete = false;
-                    // check cs_vSend, cs_vRecv, cs_mapRequests, cs_inventory
-                    {
-                        TRY_LOCK(pnode->cs_vSend, lockSend);
-                        if(lockSend) {
-                            TRY_LOCK(pnode->cs_vRecv, lockRecv);
-                            if(lockRecv) {
-                                TRY_LOCK(pnode->cs_mapRequests, lockReq);
-                                if(lockReq) {
-                                    TRY_LOCK(pnode->cs_inventory, lockInv);
-                                    if(lockInv) {
-                                        fDelete = true;
-                                    }
+        // Delete disconnected nodes
+        std::list<CNode *> vNodesDisconnectedCopy = vNodesDisconnected;
+        for(CNode *pnode: vNodesDisconnectedCopy)
+        {
+            // wait until threads are done using it
+            if(pnode->GetRefCount() <= 0) {
+                bool fDelete = false;
+                // check cs_vSend, cs_vRecv, cs_mapRequests, cs_inventory
+                {
+                    TRY_LOCK(pnode->cs_vSend, lockSend);
+                    if(lockSend) {
+                        TRY_LOCK(pnode->cs_vRecv, lockRecv);
+                        if(lockRecv) {
+                            TRY_LOCK(pnode->cs_mapRequests, lockReq);
+                            if(lockReq) {
+                                TRY_LOCK(pnode->cs_inventory, lockInv);
+                                if(lockInv) {
+                                    fDelete = true;
                                 }
                             }
                         }
                     }
-                    if(fDelete) {
-                        vNodesDisconnected.remove(pnode);
-                        delete pnode;
-                    }
                 }
+                if(fDelete) {
+                    vNodesDisconnected.remove(pnode);
+                    delete pnode;
+                }
+            }
+        }
+    }
+    if(net_node::vNodes.size() != nPrevNodeCount) {
+        nPrevNodeCount = net_node::vNodes.size();
+        CClientUIInterface::uiInterface.NotifyNumConnectionsChanged(net_node::vNodes.size());
+    }
+}
+
+//
+// Accept one connection, false: nothing left to accept
+//
+bool net_node::AcceptConnection(SOCKET hListenSocket)
+{
+#ifdef USE_IPV6
+    struct sockaddr_storage sockaddr;
+#else
+    struct sockaddr sockaddr;
+#endif
+    socklen_t len = sizeof(sockaddr);
+    SOCKET hSocket = ::accept(hListenSocket, (struct sockaddr *)&sockaddr, &len);
+    CAddress addr;
+    int nInbound = 0;
+
+    if(hSocket != INVALID_SOCKET) {
+        if(!addr.SetSockAddr((const struct sockaddr *)&sockaddr)) {
+            logging::LogPrintf("Warning: Unknown socket family\n");
+        }
+    }
+
+    {
+        LOCK(net_node::cs_vNodes);
+        for(CNode *pnode: net_node::vNodes)
+        {
+            if(pnode->fInbound) {
+                ++nInbound;
+            }
+        }
+    }
+
+    if(hSocket == INVALID_SOCKET) {
+        int nErr = WSAGetLastError();
+        if(nErr != WSAEWOULDBLOCK) {
+            logging::LogPrintf("socket error accept failed: %d\n", nErr);
+        }
+        return false;
+    } else if(!net_node::socketPoller.IsEpoll() && !IsSelectableSocket(hSocket)) {
+        logging::LogPrintf("connection from %s dropped: non-selectable socket\n", addr.ToString().c_str());
+        netbase::manage::CloseSocket(hSocket);
+    } else if(nInbound >= map_arg::GetArgInt("-maxconnections", 125) - MAX_OUTBOUND_CONNECTIONS) {
+        {
+            LOCK(net_node::cs_setservAddNodeAddresses);
+            if(! net_node::setservAddNodeAddresses.count(addr)) {
+                netbase::manage::CloseSocket(hSocket);
+            }
+        }
+    } else if(CNode::IsBanned(addr)) {
+        logging::LogPrintf("connection from %s dropped (banned)\n", addr.ToString().c_str());
+        netbase::manage::CloseSocket(hSocket);
+    } else {
+        logging::LogPrintf("accepted connection %s\n", addr.ToString().c_str());
+        CNode *pnode = new(std::nothrow) CNode(hSocket, addr, "", true);
+        if(!pnode) {
+            logging::LogPrintf("CNode memory allocate failed.\n");
+            netbase::manage::CloseSocket(hSocket);
+        } else {
+            pnode->AddRef();
+            {
+                LOCK(net_node::cs_vNodes);
+                net_node::vNodes.push_back(pnode);
+            }
+            if(net_node::socketPoller.IsEpoll()) {
+                net_node::socketPoller.Add(hSocket, pnode);
+            }
+        }
+    }
+    return true;
+}
+
+//
+// Receive, false: more data may be waiting (not locked, or the buffer was filled)
+//
+bool net_node::SocketRecv(CNode *pnode)
+{
+    TRY_LOCK(pnode->cs_vRecv, lockRecv);
+    if(! lockRecv) {
+        return false;
+    }
+
+    CDataStream &vRecv = pnode->vRecv;
+    uint64_t nPos = vRecv.size();
+
+    if(nPos > net_node::ReceiveBufferSize()) {
+        if(! pnode->fDisconnect) {
+            logging::LogPrintf("socket recv flood control disconnect (%" PRIszu " bytes)\n", vRecv.size());
+        }
+        pnode->CloseSocketDisconnect();
+        return true;
+    }
+
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+
+    datastream_signed_vector vchMsg;
+    vchMsg.assign(coin_param::strEcho.c_str(), coin_param::strEcho.c_str() + coin_param::strEcho.length());
+    CDataStream sMsg(vchMsg);
+    datastream_signed_vector vchQuantum;
+    vchQuantum.assign(coin_param::strQuantum.c_str(), coin_param::strQuantum.c_str() + coin_param::strQuantum.length());
+    CDataStream sQuantum(vchQuantum);
+    if(nBytes > 0 && ::memcmp(&sMsg[0], pchBuf, sMsg.size()) == 0) {
+        //
+        // Echo SorachanCoin
+        //
+        if(! net_basis::IsNoneblockSend(pnode->hSocket)) {
+            pnode->CloseSocketDisconnect();
+        } else {
+            (void)send(pnode->hSocket, &sMsg[0], sMsg.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            pnode->CloseSocketDisconnect();
+        }
+    } else if(nBytes > 0 && ::memcmp(&sQuantum[0], pchBuf, sQuantum.size()) == 0) {
+        //
+        // Quantum SorachanCoin
+        //
+        logging::LogPrintf("socket of quantum is send, and closed socket\n");
+        if(! net_basis::IsNoneblockSend(pnode->hSocket)) {
+            pnode->CloseSocketDisconnect();
+        } else {
+            (void)send(pnode->hSocket, &sQuantum[0], sQuantum.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            pnode->CloseSocketDisconnect();
+        }
+    } else if(nBytes > 0) {
+        vRecv.resize(nPos + nBytes);
+        std::memcpy(&vRecv[nPos], pchBuf, nBytes);
+        pnode->nLastRecv = bitsystem::GetTime();
+        pnode->nRecvBytes += nBytes;
+        pnode->RecordBytesRecv(nBytes);
+        if(pnode->HasCompleteMessage()) {
+            if(pnode->nMsgReadyTime == 0) {
+                pnode->nMsgReadyTime = util::GetTimeMicros();
+            }
+            net_node::WakeMessageHandler(pnode);
+        }
+        return nBytes < (int)sizeof(pchBuf);
+    } else if(nBytes == 0) {
+        // socket closed gracefully
+        if(! pnode->fDisconnect) {
+            logging::LogPrintf("socket closed\n");
+        }
+        pnode->CloseSocketDisconnect();
+    } else if(nBytes < 0) {
+        // error
+        int nErr = WSAGetLastError();
+        if(nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
+            if(!pnode->fDisconnect) {
+                logging::LogPrintf("socket recv error %d\n", nErr);
+            }
+            pnode->CloseSocketDisconnect();
+        }
+    }
+    return true;
+}
+
+//
+// Send, false: not locked
+//
+bool net_node::SocketSend(CNode *pnode)
+{
+    TRY_LOCK(pnode->cs_vSend, lockSend);
+    if(! lockSend) {
+        return false;
+    }
+
+    CDataStream &vSend = pnode->vSend;
+    if(!vSend.empty()) {
+        int nBytes = send(pnode->hSocket, &vSend[0], vSend.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if(nBytes > 0) {
+            // ProcessMessages waits while vSend is full
+            const bool fWasFull = vSend.size() >= net_node::SendBufferSize();
+            vSend.erase(vSend.begin(), vSend.begin() + nBytes);
+            pnode->nLastSend = bitsystem::GetTime();
+            pnode->nSendBytes += nBytes;
+            pnode->RecordBytesSent(nBytes);
+            if(fWasFull && vSend.size() < net_node::SendBufferSize()) {
+                net_node::WakeMessageHandler(pnode);
+            }
+        } else if(nBytes < 0) {
+            // error
+            int nErr = WSAGetLastError();
+            if(nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
+                logging::LogPrintf("socket send error %d\n", nErr);
+                pnode->CloseSocketDisconnect();
             }
         }
-        if(net_node::vNodes.size() != nPrevNodeCount) {
-            nPrevNodeCount = net_node::vNodes.size();
-            CClientUIInterface::uiInterface.NotifyNumConnectionsChanged(net_node::vNodes.size());
+    }
+
+    // epoll: nothing left to send, stop asking for write readiness (CNode::PollSend asks again)
+    if(vSend.empty() && pnode->fPollSend && pnode->hSocket != INVALID_SOCKET && net_node::socketPoller.IsEpoll()) {
+        pnode->fPollSend = false;
+        net_node::socketPoller.WantSend(pnode->nPollId, false);
+    }
+    return true;
+}
+
+//
+// Inactivity checking
+//
+void net_node::InactivityCheck(CNode *pnode)
+{
+    if(pnode->vSend.empty()) {
+        pnode->nLastSendEmpty = bitsystem::GetTime();
+    }
+    if(bitsystem::GetTime() - pnode->nTimeConnected > 60) {
+        if(pnode->nLastRecv == 0 || pnode->nLastSend == 0) {
+            logging::LogPrintf("socket no message in first 60 seconds, %d %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0);
+            pnode->fDisconnect = true;
+        } else if(bitsystem::GetTime() - pnode->nLastSend > 90 * 60 && bitsystem::GetTime() - pnode->nLastSendEmpty > 90 * 60) {
+            logging::LogPrintf("socket not sending\n");
+            pnode->fDisconnect = true;
+        } else if(bitsystem::GetTime() - pnode->nLastRecv > 90 * 60) {
+            logging::LogPrintf("socket inactivity timeout\n");
+            pnode->fDisconnect = true;
         }
+    }
+}
+
+void net_node::ThreadSocketHandler2(void *parg)
+{
+    logging::LogPrintf("net_node::ThreadSocketHandler started (%s)\n", net_node::socketPoller.IsEpoll() ? "epoll": "select");
+    if(net_node::socketPoller.IsEpoll()) {
+        net_node::ThreadSocketHandlerEpoll();
+    } else {
+        net_node::ThreadSocketHandlerSelect();
+    }
+}
+
+void net_node::ThreadSocketHandlerSelect()
+{
+    auto Release = [](CNode *node) {
+        node->Release();
+    };
+
+    size_t nPrevNodeCount = 0;
+    for( ; ; )
+    {
+        //
+        // Disconnect nodes
+        //
+        net_node::DisconnectNodes(nPrevNodeCount);
 
         //
         // Find which sockets have data to receive
@@ -982,61 +1441,7 @@ void net_node::ThreadSocketHandler2(void *parg)
         for(SOCKET hListenSocket: bitsocket::vhListenSocket)
         {
             if(hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv)) {
-#ifdef USE_IPV6
-                struct sockaddr_storage sockaddr;
-#else
-                struct sockaddr sockaddr;
-#endif
-                socklen_t len = sizeof(sockaddr);
-                SOCKET hSocket = ::accept(hListenSocket, (struct sockaddr *)&sockaddr, &len);
-                CAddress addr;
-                int nInbound = 0;
-
-                if(hSocket != INVALID_SOCKET) {
-                    if(!addr.SetSockAddr((const struct sockaddr *)&sockaddr)) {
-                        logging::LogPrintf("Warning: Unknown socket family\n");
-                    }
-                }
-
-                {
-                    LOCK(net_node::cs_vNodes);
-                    for(CNode *pnode: net_node::vNodes)
-                    {
-                        if(pnode->fInbound) {
-                            ++nInbound;
-                        }
-                    }
-                }
-
-                if(hSocket == INVALID_SOCKET) {
-                    int nErr = WSAGetLastError();
-                    if(nErr != WSAEWOULDBLOCK) {
-                        logging::LogPrintf("socket error accept failed: %d\n", nErr);
-                    }
-                } else if(nInbound >= map_arg::GetArgInt("-maxconnections", 125) - MAX_OUTBOUND_CONNECTIONS) {
-                    {
-                        LOCK(net_node::cs_setservAddNodeAddresses);
-                        if(! net_node::setservAddNodeAddresses.count(addr)) {
-                            netbase::manage::CloseSocket(hSocket);
-                        }
-                    }
-                } else if(CNode::IsBanned(addr)) {
-                    logging::LogPrintf("connection from %s dropped (banned)\n", addr.ToString().c_str());
-                    netbase::manage::CloseSocket(hSocket);
-                } else {
-                    logging::LogPrintf("accepted connection %s\n", addr.ToString().c_str());
-                    CNode *pnode = new(std::nothrow) CNode(hSocket, addr, "", true);
-                    if(!pnode) {
-                        logging::LogPrintf("CNode memory allocate failed.\n");
-                        netbase::manage::CloseSocket(hSocket);
-                    } else {
-                        pnode->AddRef();
-                        {
-                            LOCK(net_node::cs_vNodes);
-                            net_node::vNodes.push_back(pnode);
-                        }
-                    }
-                }
+                net_node::AcceptConnection(hListenSocket);
             }
         }
 
@@ -1066,72 +1471,7 @@ void net_node::ThreadSocketHandler2(void *parg)
                 continue;
             }
             if(FD_ISSET(pnode->hSocket, &fdsetRecv) || FD_ISSET(pnode->hSocket, &fdsetError)) {
-                TRY_LOCK(pnode->cs_vRecv, lockRecv);
-                if(lockRecv) {
-                    CDataStream &vRecv = pnode->vRecv;
-                    uint64_t nPos = vRecv.size();
-
-                    if(nPos > net_node::ReceiveBufferSize()) {
-                        if(! pnode->fDisconnect) {
-                            logging::LogPrintf("socket recv flood control disconnect (%" PRIszu " bytes)\n", vRecv.size());
-                        }
-                        pnode->CloseSocketDisconnect();
-                    } else {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-
-                        datastream_signed_vector vchMsg;
-                        vchMsg.assign(coin_param::strEcho.c_str(), coin_param::strEcho.c_str() + coin_param::strEcho.length());
-                        CDataStream sMsg(vchMsg);
-                        datastream_signed_vector vchQuantum;
-                        vchQuantum.assign(coin_param::strQuantum.c_str(), coin_param::strQuantum.c_str() + coin_param::strQuantum.length());
-                        CDataStream sQuantum(vchQuantum);
-                        if(nBytes > 0 && ::memcmp(&sMsg[0], pchBuf, sMsg.size()) == 0) {
-                            //
-                            // Echo SorachanCoin
-                            //
-                            if(! net_basis::IsNoneblockSend(pnode->hSocket)) {
-                                pnode->CloseSocketDisconnect();
-                            } else {
-                                (void)send(pnode->hSocket, &sMsg[0], sMsg.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
-                                pnode->CloseSocketDisconnect();
-                            }
-                        } else if(nBytes > 0 && ::memcmp(&sQuantum[0], pchBuf, sQuantum.size()) == 0) {
-                            //
-                            // Quantum SorachanCoin
-                            //
-                            logging::LogPrintf("socket of quantum is send, and closed socket\n");
-                            if(! net_basis::IsNoneblockSend(pnode->hSocket)) {
-                                pnode->CloseSocketDisconnect();
-                            } else {
-                                (void)send(pnode->hSocket, &sQuantum[0], sQuantum.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
-                                pnode->CloseSocketDisconnect();
-                            }
-                        } else if(nBytes > 0) {
-                            vRecv.resize(nPos + nBytes);
-                            std::memcpy(&vRecv[nPos], pchBuf, nBytes);
-                            pnode->nLastRecv = bitsystem::GetTime();
-                            pnode->nRecvBytes += nBytes;
-                            pnode->RecordBytesRecv(nBytes);
-                        } else if(nBytes == 0) {
-                            // socket closed gracefully
-                            if(! pnode->fDisconnect) {
-                                logging::LogPrintf("socket closed\n");
-                            }
-                            pnode->CloseSocketDisconnect();
-                        } else if(nBytes < 0) {
-                            // error
-                            int nErr = WSAGetLastError();
-                            if(nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
-                                if(!pnode->fDisconnect) {
-                                    logging::LogPrintf("socket recv error %d\n", nErr);
-                                }
-                                pnode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
+                net_node::SocketRecv(pnode);
             }
 
             //
@@ -1141,46 +1481,10 @@ void net_node::ThreadSocketHandler2(void *parg)
                 continue;
             }
             if(FD_ISSET(pnode->hSocket, &fdsetSend)) {
-                TRY_LOCK(pnode->cs_vSend, lockSend);
-                if(lockSend) {
-                    CDataStream &vSend = pnode->vSend;
-                    if(!vSend.empty()) {
-                        int nBytes = send(pnode->hSocket, &vSend[0], vSend.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
-                        if(nBytes > 0) {
-                            vSend.erase(vSend.begin(), vSend.begin() + nBytes);
-                            pnode->nLastSend = bitsystem::GetTime();
-                            pnode->nSendBytes += nBytes;
-                            pnode->RecordBytesSent(nBytes);
-                        } else if(nBytes < 0) {
-                            // error
-                            int nErr = WSAGetLastError();
-                            if(nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
-                                logging::LogPrintf("socket send error %d\n", nErr);
-                                pnode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
+                net_node::SocketSend(pnode);
             }
 
-            //
-            // Inactivity checking
-            //
-            if(pnode->vSend.empty()) {
-                pnode->nLastSendEmpty = bitsystem::GetTime();
-            }
-            if(bitsystem::GetTime() - pnode->nTimeConnected > 60) {
-                if(pnode->nLastRecv == 0 || pnode->nLastSend == 0) {
-                    logging::LogPrintf("socket no message in first 60 seconds, %d %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0);
-                    pnode->fDisconnect = true;
-                } else if(bitsystem::GetTime() - pnode->nLastSend > 90 * 60 && bitsystem::GetTime() - pnode->nLastSendEmpty > 90 * 60) {
-                    logging::LogPrintf("socket not sending\n");
-                    pnode->fDisconnect = true;
-                } else if(bitsystem::GetTime() - pnode->nLastRecv > 90 * 60) {
-                    logging::LogPrintf("socket inactivity timeout\n");
-                    pnode->fDisconnect = true;
-                }
-            }
+            net_node::InactivityCheck(pnode);
         } // for(CNode *pnode: vNodesCopy)
 
         {
@@ -1192,6 +1496,138 @@ void net_node::ThreadSocketHandler2(void *parg)
     }
 }
 
+//
+// epoll: only the sockets reported ready are serviced; the disconnect and
+// inactivity pass over every node runs once per EPOLL_HOUSEKEEPING msec.
+//
+void net_node::ThreadSocketHandlerEpoll()
+{
+    auto Release = [](CNode *node) {
+        node->Release();
+    };
+    const int64_t EPOLL_HOUSEKEEPING = 250;
+
+    for(SOCKET hListenSocket: bitsocket::vhListenSocket)
+    {
+        if(hListenSocket != INVALID_SOCKET) {
+            net_node::socketPoller.Add(hListenSocket, nullptr);
+        }
+    }
+
+    size_t nPrevNodeCount = 0;
+    int64_t nNextHousekeeping = 0;
+    for( ; ; )
+    {
+        //
+        // Disconnect nodes, inactivity checking
+        //
+        if(util::GetTimeMillis() >= nNextHousekeeping) {
+            net_node::DisconnectNodes(nPrevNodeCount);
+
+            std::vector<CNode *> vNodesCopy;
+            {
+                LOCK(net_node::cs_vNodes);
+                vNodesCopy = net_node::vNodes;
+                for(CNode *pnode: vNodesCopy)
+                {
+                    pnode->AddRef();
+                }
+            }
+            for(CNode *pnode: vNodesCopy)
+            {
+                net_node::InactivityCheck(pnode);
+            }
+            {
+                LOCK(net_node::cs_vNodes);
+                std::for_each(vNodesCopy.begin(), vNodesCopy.end(), Release);
+            }
+            nNextHousekeeping = util::GetTimeMillis() + EPOLL_HOUSEKEEPING;
+        }
+
+        //
+        // Wait for socket events. A latched socket is serviced again after 1 msec,
+        // not 0, so the loop does not spin while its TRY_LOCK keeps failing.
+        //
+        const int nTimeout = net_node::socketPoller.HasReady() ? 1: (int)std::max<int64_t>(nNextHousekeeping - util::GetTimeMillis(), 0);
+        net_node::vnThreadsRunning[THREAD_SOCKETHANDLER]--;
+        net_node::socketPoller.Wait(nTimeout);
+        net_node::vnThreadsRunning[THREAD_SOCKETHANDLER]++;
+        if(args_bool::fShutdown) {
+            return;
+        }
+
+        std::vector<std::pair<uint64_t, SOCKET> > vListenReady;
+        std::vector<CNode *> vNodesReady;
+        net_node::socketPoller.GetReady(vListenReady, vNodesReady);
+
+        //
+        // Accept new connections (edge-triggered: until none is left, at most 64 per wake-up)
+        //
+        for(const std::pair<uint64_t, SOCKET> &listen: vListenReady)
+        {
+            bool fDry = false;
+            for(int i = 0; i < 64 && !fDry; ++i)
+            {
+                fDry = !net_node::AcceptConnection(listen.second);
+            }
+            if(fDry) {
+                net_node::socketPoller.ClearReady(listen.first, CSocketPoller::POLL_RECV | CSocketPoller::POLL_SEND);
+            }
+        }
+
+        //
+        // Service the ready sockets
+        // (a node is deleted only by this thread, after CloseSocketDisconnect has unregistered it)
+        //
+        {
+            LOCK(net_node::cs_vNodes);
+            for(CNode *pnode: vNodesReady)
+            {
+                pnode->AddRef();
+            }
+        }
+
+        for(CNode *pnode: vNodesReady)
+        {
+            if(args_bool::fShutdown) {
+                return;
+            }
+
+            // by registration, not by pnode->hSocket: the socket may be closed and its fd reused meanwhile
+            const uint64_t nPollId = pnode->nPollId;
+            if(pnode->hSocket == INVALID_SOCKET) {
+                continue;
+            }
+            const int nReady = net_node::socketPoller.GetReady(nPollId);
+            int nClear = 0;
+
+            //
+            // Receive
+            //
+            if((nReady & CSocketPoller::POLL_RECV) && net_node::SocketRecv(pnode)) {
+                nClear |= CSocketPoller::POLL_RECV;
+            }
+
+            //
+            // Send
+            //
+            if((nReady & CSocketPoller::POLL_SEND) && (pnode->hSocket == INVALID_SOCKET || net_node::SocketSend(pnode))) {
+                nClear |= CSocketPoller::POLL_SEND;
+            }
+
+            if(pnode->hSocket == INVALID_SOCKET) {
+                continue;
+            }
+            net_node::socketPoller.ClearReady(nPollId, nClear);
+        }
+
+        {
+            LOCK(net_node::cs_vNodes);
+            std::for_each(vNodesReady.begin(), vNodesReady.end(), Release);
+        }
+    }
+}
+
 #ifdef USE_UPNP
 void upnp::ThreadMapPort(void *parg)
 {
@@ -1859,34 +2295,59 @@ void net_node::ThreadMessageHandler2(void *parg)
     logging::LogPrintf("net_node::ThreadMessageHandler started\n");
     bitthread::SetThreadPriority(THREAD_PRIORITY_BELOW_NORMAL);
 
+    int64_t nNextPass = 0;
     while(! args_bool::fShutdown)
     {
+        //
+        // Nodes woken by the socket thread or by PushInventory (block invs), and every node
+        // once per MESSAGE_HANDLER_PASS msec (ping, addr, trickle and getdata timers).
+        //
+        const bool fPass = util::GetTimeMillis() >= nNextPass;
+        if(fPass) {
+            nNextPass = util::GetTimeMillis() + MESSAGE_HANDLER_PASS;
+        }
+
         bool fHaveSyncNode = false;
         std::vector<CNode *> vNodesCopy;
         {
             LOCK(net_node::cs_vNodes);
-            vNodesCopy = net_node::vNodes;
-            for(CNode *pnode: vNodesCopy)
+            for(CNode *pnode: net_node::vNodes)
             {
-                pnode->AddRef();
                 if(pnode == pnodeSync) {
                     fHaveSyncNode = true;
                 }
+                if(pnode->fMsgReady.exchange(false) || fPass) {
+                    pnode->AddRef();
+                    vNodesCopy.push_back(pnode);
+                }
             }
         }
 
-        if(! fHaveSyncNode) {
+        if(fPass && !fHaveSyncNode) {
             StartSync(vNodesCopy);
         }
 
-        // Poll the connected nodes for messages
+        // Visit the nodes (busy locks: again after a short wait)
+        bool fRetry = false;
         for(CNode *pnode: vNodesCopy)
         {
             // Receive messages
             {
                 TRY_LOCK(pnode->cs_vRecv, lockRecv);
                 if(lockRecv) {
+                    const int64_t nReadyTime = pnode->nMsgReadyTime;
+                    pnode->nMsgReadyTime = 0;
                     block_process::manage::ProcessMessages(pnode);
+                    if(nReadyTime != 0) {
+                        const int64_t nLatency = util::GetTimeMicros() - nReadyTime;
+                        LOCK(net_node::cs_msgStats);
+                        ++net_node::msgStats.nRecvCount;
+                        net_node::msgStats.nRecvTotal += nLatency;
+                        net_node::msgStats.nRecvMax = std::max(net_node::msgStats.nRecvMax, nLatency);
+                    }
+                } else {
+                    pnode->fMsgReady = true;
+                    fRetry = true;
                 }
             }
             if(args_bool::fShutdown) {
@@ -1898,25 +2359,66 @@ void net_node::ThreadMessageHandler2(void *parg)
                 TRY_LOCK(pnode->cs_vSend, lockSend);
                 if(lockSend) {
                     block_process::manage::SendMessages(pnode);
+                } else {
+                    pnode->fMsgReady = true;
+                    fRetry = true;
                 }
             }
             if(args_bool::fShutdown) {
                 return;
             }
+
+            // Block inv relayed: queued to the inv in vSend
+            {
+                LOCK(pnode->cs_inventory);
+                if(pnode->nInvBlockTime != 0) {
+                    bool fBlockInvWaiting = false;
+                    for(const CInv &inv: pnode->vInventoryToSend)
+                    {
+                        if(inv.get_type() == _CINV_MSG_TYPE::MSG_BLOCK) {
+                            fBlockInvWaiting = true;
+                            break;
+                        }
+                    }
+                    if(! fBlockInvWaiting) {
+                        const int64_t nLatency = util::GetTimeMicros() - pnode->nInvBlockTime;
+                        pnode->nInvBlockTime = 0;
+                        LOCK(net_node::cs_msgStats);
+                        ++net_node::msgStats.nRelayCount;
+                        net_node::msgStats.nRelayTotal += nLatency;
+                        net_node::msgStats.nRelayMax = std::max(net_node::msgStats.nRelayMax, nLatency);
+                    }
+                }
+            }
         }
 
         {
             LOCK(net_node::cs_vNodes);
             std::for_each(vNodesCopy.begin(), vNodesCopy.end(), Release);
         }
+        {
+            LOCK(net_node::cs_msgStats);
+            net_node::msgStats.nVisits += vNodesCopy.size();
+        }
 
         //
-        // Wait and allow messages to bunch up.
+        // Wait for a wake-up or the next pass.
         // Reduce net_node::vnThreadsRunning so StopNode has permission to exit while
-        // we're sleeping, but we must always check args_bool::fShutdown after doing this.
+        // we're waiting, but we must always check args_bool::fShutdown after doing this.
         //
         net_node::vnThreadsRunning[THREAD_MESSAGEHANDLER]--;
-        util::Sleep(100);
+        {
+            const int64_t nWait = fRetry ? 10: std::max<int64_t>(nNextPass - util::GetTimeMillis(), 0);
+            boost::unique_lock<boost::mutex> lock(net_node::csMsgWake);
+            if(! net_node::fMsgWake) {
+                net_node::condMsgWake.wait_for(lock, boost::chrono::milliseconds(nWait));
+            }
+            if(net_node::fMsgWake) {
+                net_node::fMsgWake = false;
+                LOCK(net_node::cs_msgStats);
+                ++net_node::msgStats.nWakeups;
+            }
+        }
         if(args_bool::fRequestShutdown) {
             boot::StartShutdown();
         }
@@ -2115,6 +2617,9 @@ void net_node::StartNode(void *parg)
 
     Discover();
 
+    // Socket events: epoll, select() fallback (before any node is connected)
+    net_node::socketPoller.Init(map_arg::GetArg("-netpoll", "epoll") != "select");
+
     //
     // Start threads
     //
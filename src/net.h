@@ -8,8 +8,11 @@
 
 #include <limits>
 #include <deque>
+#include <atomic>
 #ifndef Q_MOC_RUN
 # include <boost/array.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/condition_variable.hpp>
 #endif
 #include <random/random.h>
 #ifndef WIN32
@@ -21,6 +24,7 @@
 #include <hash.h>
 #include <block/block.h>
 #include <util/strencodings.h>
+#include <util/time.h>
 
 class CRequestTracker;
 class CNode;
@@ -196,6 +200,66 @@ enum threadId
     THREAD_MAX
 };
 
+//
+// Socket readiness for ThreadSocketHandler
+// epoll (Linux, edge-triggered): a socket is registered once when its node is
+// created, and write readiness is asked for only while vSend holds data
+// (CNode::PollSend). An edge is reported once, so readiness is latched here
+// until recv/send/accept has run dry (ClearReady).
+// Registrations, readiness and interest changes are keyed by a registration id
+// that is never reused, not by the fd: a node closed on another thread can't
+// pass its readiness or an EPOLL_CTL_MOD on to a new socket with the same fd.
+// select(): the portable fallback (-netpoll=select), fd_sets rebuilt per wait.
+//
+class CSocketPoller
+{
+public:
+    enum {
+        POLL_RECV = 1,
+        POLL_SEND = 2
+    };
+
+    CSocketPoller();
+    ~CSocketPoller();
+
+    // false: epoll is not available, use select()
+    bool Init(bool fUseEpoll);
+    bool IsEpoll() const {
+        return hEpoll != -1;
+    }
+
+    // pnode == nullptr: listening socket; a node gets its id in pnode->nPollId
+    uint64_t Add(SOCKET hSocket, CNode *pnode);
+    void Remove(uint64_t nId);
+    void WantSend(uint64_t nId, bool fSend);
+
+    // wait at most nTimeout msec; the socket handler passes 1 while a socket
+    // is still latched (HasReady), so a TRY_LOCK on cs_vRecv/cs_vSend that
+    // keeps failing is retried without spinning the loop
+    void Wait(int nTimeout);
+    bool HasReady() const;
+    void GetReady(std::vector<std::pair<uint64_t, SOCKET> > &vListenReady, std::vector<CNode *> &vNodesReady) const;
+    int GetReady(uint64_t nId) const;
+    void ClearReady(uint64_t nId, int nFlags);
+
+private:
+    CSocketPoller(const CSocketPoller &)=delete;
+    CSocketPoller(CSocketPoller &&)=delete;
+    CSocketPoller &operator=(const CSocketPoller &)=delete;
+    CSocketPoller &operator=(CSocketPoller &&)=delete;
+
+    struct entry {
+        SOCKET hSocket;
+        CNode *pnode;
+    };
+
+    int hEpoll;
+    mutable CCriticalSection cs;
+    uint64_t nNextId;
+    std::map<uint64_t, entry> mapSocket; // registered sockets by id (the epoll event data)
+    std::map<uint64_t, int> mapReady;    // latched readiness (POLL_RECV | POLL_SEND)
+};
+
 //
 // net_node (Thread)
 //
@@ -221,6 +285,15 @@ private:
 
     static void ThreadSocketHandler(void *parg);
     static void ThreadSocketHandler2(void *parg);
+    static void ThreadSocketHandlerSelect();
+    static void ThreadSocketHandlerEpoll();
+
+    // ThreadSocketHandler steps (select and epoll)
+    static void DisconnectNodes(size_t &nPrevNodeCount);
+    static bool AcceptConnection(SOCKET hListenSocket);
+    static bool SocketRecv(CNode *pnode);
+    static bool SocketSend(CNode *pnode);
+    static void InactivityCheck(CNode *pnode);
 
     static void ThreadOpenConnections(void *parg);
     static void ThreadOpenConnections2(void *parg);
@@ -231,6 +304,12 @@ private:
     static void ThreadMessageHandler(void *parg);
     static void ThreadMessageHandler2(void *parg);
 
+    // ThreadMessageHandler wake-up: a node has a complete message, send space or inventory
+    static constexpr int64_t MESSAGE_HANDLER_PASS = 100; // msec, every node (SendMessages timers)
+    static boost::mutex csMsgWake;
+    static boost::condition_variable condMsgWake;
+    static bool fMsgWake;
+
     static void DumpAddresses();
 
     static void StartSync(const std::vector<CNode *> &__vNodes);
@@ -251,6 +330,27 @@ public:
     static CAddrMan addrman;    // name solution, 1,addrman -> 2,dns_seed
 
     static std::vector<CNode *> vNodes;
+    static CSocketPoller socketPoller;
+
+    // ThreadMessageHandler: wake-ups, node visits and per-hop latency (usec)
+    // recv: complete message in vRecv -> ProcessMessages
+    // relay: block inv queued (PushInventory) -> inv in vSend (SendMessages)
+    struct message_handler_stats {
+        uint64_t nWakeups;
+        uint64_t nVisits;
+        uint64_t nRecvCount;
+        int64_t nRecvTotal;
+        int64_t nRecvMax;
+        uint64_t nRelayCount;
+        int64_t nRelayTotal;
+        int64_t nRelayMax;
+    };
+    static CCriticalSection cs_msgStats;
+    static message_handler_stats msgStats;
+    static message_handler_stats GetMessageHandlerStats();
+
+    // mark the node for ThreadMessageHandler and wake it
+    static void WakeMessageHandler(CNode *pnode);
     static std::map<CInv, CDataStream> mapRelay;
     static CCriticalSection cs_mapRelay;
 
@@ -481,6 +581,10 @@ public:
     bool fNetworkNode;
     bool fSuccessfullyConnected;
     bool fDisconnect;
+    bool fPollSend; // epoll: write readiness asked for (cs_vSend)
+    std::atomic<uint64_t> nPollId; // epoll: CSocketPoller registration, 0: none
+    std::atomic<bool> fMsgReady; // visit in ThreadMessageHandler (net_node::WakeMessageHandler)
+    int64_t nMsgReadyTime; // usec, a complete message is waiting in vRecv since (cs_vRecv)
     CSemaphoreGrant grantOutbound;
 
 protected:
@@ -522,6 +626,7 @@ public:
     //
     mruset<CInv> setInventoryKnown;
     std::vector<CInv> vInventoryToSend;
+    int64_t nInvBlockTime; // usec, a block inv is waiting in vInventoryToSend since (cs_inventory)
     CCriticalSection cs_inventory;
     std::multimap<int64_t, CInv> mapAskFor;
 
@@ -546,6 +651,11 @@ public:
         fNetworkNode = false;
         fSuccessfullyConnected = false;
         fDisconnect = false;
+        fPollSend = true; // registered for writing by CSocketPoller::Add
+        nPollId = 0;
+        fMsgReady = false;
+        nMsgReadyTime = 0;
+        nInvBlockTime = 0;
         nRefCount = 0;
         nReleaseTime = 0;
         hashContinue = 0;
@@ -640,10 +750,18 @@ public:
     void PushInventory(const CInv &inv) {
         {
             LOCK(cs_inventory);
-            if (!setInventoryKnown.count(inv)) {
-                vInventoryToSend.push_back(inv);
+            if (setInventoryKnown.count(inv)) {
+                return;
+            }
+            vInventoryToSend.push_back(inv);
+            if (inv.get_type() != _CINV_MSG_TYPE::MSG_BLOCK) {
+                return; // tx invs go out with the next MESSAGE_HANDLER_PASS visit
+            }
+            if (nInvBlockTime == 0) {
+                nInvBlockTime = util::GetTimeMicros();
             }
         }
+        net_node::WakeMessageHandler(this);
     }
 
     void AskFor(const CInv &inv) {
@@ -732,6 +850,7 @@ public:
 
         nHeaderStart = -1;
         nMessageStart = (std::numeric_limits<uint32_t>::max)();
+        PollSend();
         LEAVE_CRITICAL_SECTION(cs_vSend);
     }
 
@@ -802,6 +921,8 @@ public:
     void CancelSubscribe(unsigned int nChannel);
     void CloseSocketDisconnect();
     void Cleanup();
+    void PollSend();
+    bool HasCompleteMessage();
 
     //
     // Denial-of-service detection/prevention
@@ -734,11 +734,15 @@ constexpr int PREVECTOR_DATASTREAM_N = 256;
 constexpr int PREVECTOR_N = 256;
 constexpr int PREVECTOR_BUFFER_N = 2048;
 constexpr int PREVECTOR_BLOCK_N = 256;
+constexpr int PREVECTOR_STACKITEM_N = 520; // Script_const::MAX_SCRIPT_ELEMENT_SIZE
+constexpr int PREVECTOR_STACK_N = 16;
 #else
 constexpr int PREVECTOR_DATASTREAM_N = 32;
 constexpr int PREVECTOR_N = 32;
 constexpr int PREVECTOR_BUFFER_N = 2048;
 constexpr int PREVECTOR_BLOCK_N = 32;
+constexpr int PREVECTOR_STACKITEM_N = 128; // DER signature + hashtype (<= 73), pubkey (<= 65), P2SH 2-of-3 (105)
+constexpr int PREVECTOR_STACK_N = 16;
 #endif
 
 //
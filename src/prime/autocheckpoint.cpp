@@ -119,7 +119,7 @@ bool CAutocheckPoint_impl<T>::Check() const { // nCheckBlocks blocks, autocheckp
         if(block_info::mapBlockIndex.empty())
             return false;
 
-        const CBlockIndex_impl<T> *const bestBlock = block_info::mapBlockIndex[block_info::hashBestChain];
+        const CBlockIndex_impl<T> *const bestBlock = block_info::mapBlockIndex.get(block_info::hashBestChain);
         for (int i=0; i < nCheckBlocks; ++i) {
             const auto &autocpValue = mapAutocheck.find(bestBlock->get_nHeight()-i);
             if(autocpValue==mapAutocheck.end()) continue;
@@ -127,7 +127,7 @@ bool CAutocheckPoint_impl<T>::Check() const { // nCheckBlocks blocks, autocheckp
             const CBlockIndex_impl<T> *target = bestBlock;
             for(;;) {
                 if(bestBlock->get_nHeight()-i!=target->get_nHeight())
-                    target = block_info::mapBlockIndex[target->get_pprev()->GetBlockHash()];
+                    target = block_info::mapBlockIndex.get(target->get_pprev()->GetBlockHash());
                 else
                     break;
             }
@@ -161,7 +161,7 @@ bool CAutocheckPoint_impl<T>::Verify() const {
 template <typename T>
 bool CAutocheckPoint_impl<T>::BuildAutocheckPoints() {
     LLOCK(cs_autocp);
-    const CBlockIndex_impl<T> *block = block_info::mapBlockIndex[block_info::hashBestChain];
+    const CBlockIndex_impl<T> *block = block_info::mapBlockIndex.get(block_info::hashBestChain);
 
     /* checked mapBlockIndex
     for(const auto &ref: block_info::mapBlockIndex) {
@@ -192,7 +192,7 @@ bool CAutocheckPoint_impl<T>::BuildAutocheckPoints() {
         }
         if(block->get_hashPrevBlock()==0)
             break;
-        block = block_info::mapBlockIndex[block->get_hashPrevBlock()];
+        block = block_info::mapBlockIndex.get(block->get_hashPrevBlock());
     }
     if(fprime==false)
         return true;
@@ -205,7 +205,7 @@ bool CAutocheckPoint_impl<T>::BuildAutocheckPoints() {
     if(! fileout)
         return false;
 
-    block = block_info::mapBlockIndex[block_info::hashBestChain];
+    block = block_info::mapBlockIndex.get(block_info::hashBestChain);
     counter = nCheckBlocks;
     assert(0<counter);
     CDataStream whash; // output data (for checksum hash_65536)
@@ -226,7 +226,7 @@ bool CAutocheckPoint_impl<T>::BuildAutocheckPoints() {
         }
         if(block->get_hashPrevBlock()==0)
             break;
-        block = block_info::mapBlockIndex[block->get_hashPrevBlock()];
+        block = block_info::mapBlockIndex.get(block->get_hashPrevBlock());
     }
 
     // checksum hash_65536
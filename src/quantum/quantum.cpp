@@ -456,13 +456,14 @@ void CLamport::create_hashonly(const std::uint8_t *dataIn, size_t dataSize) noex
 #endif
 
 //
-// CHECK: prevector, aes, memory, hash, json
+// CHECK: prevector, aes, memory, hash, json, chain
 //
 #ifdef DEBUG_ALGO_CHECK
 # define PREVECTOR_CHECK
 # define AES_CHECK
 # define MEMORY_CHECK
 # define HASH_CHECK
+# define CHAIN_CHECK
 //# define JSON_CHECK // note: univalue is checking ... (still failure)
 #endif
 
@@ -564,8 +565,28 @@ private:
         debugcs::instance() << "[[[OK]]] SorachanCoin the checked JSON" << debugcs::endl();
     }
 
+    // merkle, sighash, checkqueue, secp256k1, script and kernel (run once, not in the threads below)
+    static void chain_check() noexcept {
+        debugcs::instance() << "[[[BEGIN]]] SorachanCoin the chain testing ..." << debugcs::endl();
+
+        _bench_func("[chain] merkle_check() Assertcheck", &check_merkle::MerkleAssertcheck, 1, 1);
+        _bench_func("[chain] sighash_check() Assertcheck", &check_sighash::SigHashAssertcheck, 1, 1);
+        _bench_func("[chain] checkqueue_check() Assertcheck", &check_checkqueue::CheckQueueAssertcheck, 1, 1);
+        _bench_func("[chain] ecmult_check() Assertcheck", &check_ecmult::EcmultAssertcheck, 1, 1);
+        _bench_func("[chain] evalscript_check() Assertcheck", &check_evalscript::EvalScriptAssertcheck, 1, 1);
+        _bench_func("[chain] kernel_check() Assertcheck", &check_kernel::KernelAssertcheck, 1, 1);
+        _bench_func("[chain] kernel_target_check() Assertcheck", &check_kernel::KernelTargetAssertcheck, 1, 1);
+        _bench_func("[chain] kernel_scaninput_check() Assertcheck", &check_kernel::KernelScanInputAssertcheck, 1, 1);
+        _bench_func("[chain] stake_modifier_cache_check() Assertcheck", &check_kernel::StakeModifierCacheAssertcheck, 1, 1);
+
+        debugcs::instance() << "[[[OK]]] SorachanCoin the checked chain" << debugcs::endl();
+    }
+
 #ifdef WIN32
     static unsigned int __stdcall benchmark(void *) noexcept {
+#else
+    static unsigned int benchmark(void *) noexcept {
+#endif
         for(int i = 0; i < _test_count; ++i)
         {
 #ifdef SANITY_TEST
@@ -589,7 +610,6 @@ private:
         }
         return 1;
     }
-#endif
 private:
     Quantum_startup() noexcept {
 #if defined(DEBUG)
@@ -600,6 +620,9 @@ private:
         std::thread th2(&Quantum_startup::benchmark, nullptr);
         th1.join();
         th2.join();
+#ifdef CHAIN_CHECK
+        chain_check();
+#endif
 
         //
         // tiny format test
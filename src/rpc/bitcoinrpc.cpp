@@ -179,7 +179,7 @@ json_spirit::Value CRPCTable::stop(const json_spirit::Array &params, CBitrpcData
 }
 
 // Call Table
-const CRPCTable::CRPCCommand CRPCTable::vRPCCommands[97] =
+const CRPCTable::CRPCCommand CRPCTable::vRPCCommands[100] =
 {   //  name                        function                      safemd  unlocked
     //  ------------------------    -----------------------       ------  --------
     { "help",                       &help,                        true,   true },
@@ -196,6 +196,7 @@ const CRPCTable::CRPCCommand CRPCTable::vRPCCommands[97] =
     { "getsubsidy",                 &getsubsidy,                  true,   false },
     { "getmininginfo",              &getmininginfo,               true,   false },
     { "scaninput",                  &scaninput,                   true,   true },
+    { "scaninputjob",               &scaninputjob,                true,   true },
     { "getnewaddress",              &getnewaddress,               true,   false },
     { "getnettotals",               &getnettotals,                true,   true },
     { "ntptime",                    &ntptime,                     true,   true },
@@ -258,6 +259,8 @@ const CRPCTable::CRPCCommand CRPCTable::vRPCCommands[97] =
     { "signrawtransaction",         &signrawtransaction,          false,  false },
     { "sendrawtransaction",         &sendrawtransaction,          false,  false },
     { "getcheckpoint",              &getcheckpoint,               true,   false },
+    { "getsigcacheinfo",            &getsigcacheinfo,             true,   true },
+    { "getcheckqueueinfo",          &getcheckqueueinfo,           true,   true },
     { "reservebalance",             &reservebalance,              false,  true },
     { "checkwallet",                &checkwallet,                 false,  true },
     { "repairwallet",               &repairwallet,                false,  true },
@@ -1314,6 +1317,8 @@ json_spirit::Array bitrpc::RPCConvertValues(CBitrpcData &data, const std::string
     if (strMethod == "getblocktemplate"       && n > 0) { ConvertTo<json_spirit::Object>(data, params[0]); }
     if (strMethod == "listsinceblock"         && n > 1) { ConvertTo<int64_t>(data, params[1]); }
     if (strMethod == "scaninput"              && n > 0) { ConvertTo<json_spirit::Object>(data, params[0]); }
+    if (strMethod == "scaninputjob"           && n > 0) { ConvertTo<int64_t>(data, params[0]); }
+    if (strMethod == "scaninputjob"           && n > 1) { ConvertTo<bool>(data, params[1]); }
     if (strMethod == "sendalert"              && n > 2) { ConvertTo<int64_t>(data, params[2]); }
     if (strMethod == "sendalert"              && n > 3) { ConvertTo<int64_t>(data, params[3]); }
     if (strMethod == "sendalert"              && n > 4) { ConvertTo<int64_t>(data, params[4]); }
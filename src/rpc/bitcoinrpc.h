@@ -377,7 +377,7 @@ private:
         bool okSafeMode;
         bool unlocked;
     };
-    static const CRPCCommand vRPCCommands[97]; // Bitcoin RPC Command
+    static const CRPCCommand vRPCCommands[100]; // Bitcoin RPC Command
     static std::map<std::string, const CRPCCommand *> mapCommands;
 
     struct tallyitem {
@@ -461,6 +461,7 @@ private:
     static json_spirit::Value getsubsidy(const json_spirit::Array &params, CBitrpcData &data); // in rpcmining.cpp
     static json_spirit::Value getmininginfo(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value scaninput(const json_spirit::Array &params, CBitrpcData &data);
+    static json_spirit::Value scaninputjob(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value getwork(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value getworkex(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value getblocktemplate(const json_spirit::Array &params, CBitrpcData &data);
@@ -541,6 +542,8 @@ private:
     static json_spirit::Value dumpblock(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value dumpblockbynumber(const json_spirit::Array &params, CBitrpcData &data);
     static json_spirit::Value getcheckpoint(const json_spirit::Array &params, CBitrpcData &data);
+    static json_spirit::Value getsigcacheinfo(const json_spirit::Array &params, CBitrpcData &data);
+    static json_spirit::Value getcheckqueueinfo(const json_spirit::Array &params, CBitrpcData &data);
 };
 
 // singleton class
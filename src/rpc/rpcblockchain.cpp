@@ -13,6 +13,8 @@
 #include <ostream>
 #include <thread> // CWaitforthread
 #include <miner/diff.h>
+#include <script/sigcache.h>
+#include <block/block_check.h>
 
 double CRPCTable::GetDifficulty(const CBlockIndex *blockindex/* = nullptr */) noexcept {
     // Floating point number that is a multiple of the minimum difficulty,
@@ -263,7 +265,7 @@ json_spirit::Value CRPCTable::getblock(const json_spirit::Array &params, CBitrpc
         return data.JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
     CBlock block;
-    CBlockIndex *pblockindex = block_info::mapBlockIndex[hash];
+    CBlockIndex *pblockindex = block_info::mapBlockIndex.get(hash);
     block.ReadFromDisk(pblockindex, true);
     bool fparam1 = params[1].get_bool(status);
     if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
@@ -285,11 +287,11 @@ json_spirit::Value CRPCTable::getblockbynumber(const json_spirit::Array &params,
         return data.runtime_error("Block number out of range.");
 
     CBlock block;
-    CBlockIndex *pblockindex = block_info::mapBlockIndex[block_info::hashBestChain];
+    CBlockIndex *pblockindex = block_info::mapBlockIndex.get(block_info::hashBestChain);
     while (pblockindex->get_nHeight() > nHeight)
         pblockindex = pblockindex->set_pprev();
 
-    pblockindex = block_info::mapBlockIndex[*pblockindex->get_phashBlock()];
+    pblockindex = block_info::mapBlockIndex.get(*pblockindex->get_phashBlock());
     block.ReadFromDisk(pblockindex, true);
     bool fparam1 = params[1].get_bool(status);
     if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
@@ -330,7 +332,7 @@ json_spirit::Value CRPCTable::dumpblock(const json_spirit::Array &params, CBitrp
         return data.JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
     CBlock block;
-    CBlockIndex *pblockindex = block_info::mapBlockIndex[hash];
+    CBlockIndex *pblockindex = block_info::mapBlockIndex.get(hash);
     block.ReadFromDisk(pblockindex, true);
     CDataStream ssBlock(SER_NETWORK, version::PROTOCOL_VERSION);
     ssBlock << block;
@@ -358,11 +360,11 @@ json_spirit::Value CRPCTable::dumpblockbynumber(const json_spirit::Array &params
         return data.runtime_error("Block number out of range.");
 
     CBlock block;
-    CBlockIndex *pblockindex = block_info::mapBlockIndex[block_info::hashBestChain];
+    CBlockIndex *pblockindex = block_info::mapBlockIndex.get(block_info::hashBestChain);
     while (pblockindex->get_nHeight() > nHeight)
         pblockindex = pblockindex->set_pprev();
 
-    pblockindex = block_info::mapBlockIndex[*pblockindex->get_phashBlock()];
+    pblockindex = block_info::mapBlockIndex.get(*pblockindex->get_phashBlock());
     block.ReadFromDisk(pblockindex, true);
     CDataStream ssBlock(SER_NETWORK, version::PROTOCOL_VERSION);
     ssBlock << block;
@@ -387,7 +389,7 @@ json_spirit::Value CRPCTable::getcheckpoint(const json_spirit::Array &params, CB
     json_spirit::Object result;
     result.push_back(json_spirit::Pair("synccheckpoint", Checkpoints::manage::getHashSyncCheckpoint().ToString().c_str()));
 
-    CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex[Checkpoints::manage::getHashSyncCheckpoint()];
+    CBlockIndex *pindexCheckpoint = block_info::mapBlockIndex.get(Checkpoints::manage::getHashSyncCheckpoint());
     result.push_back(json_spirit::Pair("height", pindexCheckpoint->get_nHeight()));
     result.push_back(json_spirit::Pair("timestamp", util::DateTimeStrFormat(pindexCheckpoint->GetBlockTime()).c_str()));
     if (Checkpoints::checkpointMessage.Get_vchSig().size() != 0) {
@@ -422,3 +424,72 @@ json_spirit::Value CRPCTable::getcheckpoint(const json_spirit::Array &params, CB
 
     return data.JSONRPCSuccess(result);
 }
+
+namespace {
+json_spirit::Object SaltedKeyCacheToJSON(const CSaltedKeyCache::stats &st) {
+    json_spirit::Object result;
+    result.push_back(json_spirit::Pair("maxsize", (uint64_t)st.nMaxBytes));
+    result.push_back(json_spirit::Pair("capacity", (uint64_t)st.nCapacity));
+    result.push_back(json_spirit::Pair("entries", (uint64_t)st.nEntries));
+    result.push_back(json_spirit::Pair("hits", st.nHits));
+    result.push_back(json_spirit::Pair("misses", st.nMisses));
+    result.push_back(json_spirit::Pair("inserts", st.nInserts));
+    result.push_back(json_spirit::Pair("evictions", st.nEvictions));
+    return result;
+}
+} // namespace
+
+json_spirit::Value CRPCTable::getsigcacheinfo(const json_spirit::Array &params, CBitrpcData &data) {
+    if (data.fHelp() || params.size() != 0) {
+        return data.JSONRPCSuccess(
+            "getsigcacheinfo\n"
+            "Returns the size (maxsize in bytes) and hit, miss and eviction counters of the signature cache\n"
+            "and of the script execution cache (\"scriptexecution\").");
+    }
+
+    json_spirit::Object result = SaltedKeyCacheToJSON(CSignatureCache::signatureCache.GetStats());
+    result.push_back(json_spirit::Pair("scriptexecution", SaltedKeyCacheToJSON(CScriptExecutionCache::cache.GetStats())));
+    return data.JSONRPCSuccess(result);
+}
+
+namespace {
+template <typename T>
+json_spirit::Object CheckQueueToJSON(const CCheckQueue<T> &queue) {
+    const typename CCheckQueue<T>::stats st = queue.GetStats();
+    json_spirit::Object result;
+    result.push_back(json_spirit::Pair("batchsize", (int)st.nBatchSize));
+    result.push_back(json_spirit::Pair("waits", st.nWaits));
+    result.push_back(json_spirit::Pair("waittime_us", st.nWaitMicros));
+    json_spirit::Array workers;
+    for (const typename CCheckQueue<T>::worker_stats &w: st.vWorker) {
+        json_spirit::Object obj;
+        const uint64_t nTotal = w.nBusyMicros + w.nIdleMicros;
+        obj.push_back(json_spirit::Pair("checks", w.nChecks));
+        obj.push_back(json_spirit::Pair("skipped", w.nSkipped));
+        obj.push_back(json_spirit::Pair("batches", w.nBatches));
+        obj.push_back(json_spirit::Pair("steals", w.nSteals));
+        obj.push_back(json_spirit::Pair("busy_us", w.nBusyMicros));
+        obj.push_back(json_spirit::Pair("idle_us", w.nIdleMicros));
+        obj.push_back(json_spirit::Pair("utilization", nTotal ? (double)w.nBusyMicros / nTotal : 0.0));
+        workers.push_back(obj);
+    }
+    result.push_back(json_spirit::Pair("workers", workers));
+    return result;
+}
+} // namespace
+
+json_spirit::Value CRPCTable::getcheckqueueinfo(const json_spirit::Array &params, CBitrpcData &data) {
+    if (data.fHelp() || params.size() != 0) {
+        return data.JSONRPCSuccess(
+            "getcheckqueueinfo\n"
+            "Returns the work-stealing statistics of the script check and prevout fetch queues.\n"
+            "workers[0] is the thread connecting the block; utilization is busy / (busy + idle),\n"
+            "where idle is time spent looking for work and waittime_us the time waiting for the other workers.\n"
+            "skipped counts checks released without running after a check in the same block failed.");
+    }
+
+    json_spirit::Object result;
+    result.push_back(json_spirit::Pair("scriptcheck", CheckQueueToJSON(block_check::thread::scriptcheckqueue)));
+    result.push_back(json_spirit::Pair("prevoutfetch", CheckQueueToJSON(block_check::thread::prevoutfetchqueue)));
+    return data.JSONRPCSuccess(result);
+}
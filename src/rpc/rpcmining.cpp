@@ -9,6 +9,7 @@
 #include <init.h>
 #include <miner.h>
 #include <kernel.h>
+#include <kernel_worker.h>
 #include <rpc/bitcoinrpc.h>
 #include <block/block_process.h>
 #include <miner/diff.h>
@@ -60,20 +61,84 @@ json_spirit::Value CRPCTable::getmininginfo(const json_spirit::Array &params, CB
     obj.push_back(json_spirit::Pair("pooledtx", (uint64_t)CTxMemPool::mempool.size()));
 
     obj.push_back(json_spirit::Pair("stakeinputs", (uint64_t)miner::nStakeInputsMapSize));
+
+    json_spirit::Object stakeminer;
+    json_spirit::Array workers;
+    for(const miner::kernel_worker_stats &stats: miner::GetKernelWorkerStats()) {
+        json_spirit::Object worker;
+        worker.push_back(json_spirit::Pair("inputs", stats.nInputs));
+        worker.push_back(json_spirit::Pair("kernels", stats.nHashes));
+        worker.push_back(json_spirit::Pair("kernelps", stats.dKernelsPerSec));
+        workers.push_back(worker);
+    }
+    stakeminer.push_back(json_spirit::Pair("threads", miner::nStakeMinerThreads));
+    stakeminer.push_back(json_spirit::Pair("kernelps", miner::GetKernelsPerSec()));
+    stakeminer.push_back(json_spirit::Pair("workers", workers));
+    obj.push_back(json_spirit::Pair("stakeminer", stakeminer));
+
+    json_spirit::Object modifiercache;
+    uint64_t nModifierHits, nModifierMisses;
+    CStakeModifierCache::cache.GetStats(nModifierHits, nModifierMisses);
+    modifiercache.push_back(json_spirit::Pair("entries", (uint64_t)CStakeModifierCache::cache.size()));
+    modifiercache.push_back(json_spirit::Pair("hits", nModifierHits));
+    modifiercache.push_back(json_spirit::Pair("misses", nModifierMisses));
+    modifiercache.push_back(json_spirit::Pair("hitrate", (nModifierHits + nModifierMisses) ? (double)nModifierHits / (nModifierHits + nModifierMisses) : 0.0));
+    obj.push_back(json_spirit::Pair("stakemodifiercache", modifiercache));
     obj.push_back(json_spirit::Pair("stakeinterest", diff::reward::GetProofOfStakeReward(0, diff::spacing::GetLastBlockIndex(block_info::pindexBest, true)->get_nBits(), diff::spacing::GetLastBlockIndex(block_info::pindexBest, true)->get_nTime(), true)));
 
     obj.push_back(json_spirit::Pair("testnet", (bool)args_bool::fTestNet));
     return data.JSONRPCSuccess(obj);
 }
 
+namespace {
+
+// scaninput jobs started with "async", polled and cancelled by scaninputjob
+struct scaninput_job {
+    std::shared_ptr<CKernelScanJob> job;
+    std::vector<int> vOut; // nOut of each job input
+};
+constexpr size_t MAX_SCANINPUT_JOBS = 8;
+CCriticalSection cs_ScanInputJobs;
+std::map<int, scaninput_job> mapScanInputJobs;
+int nScanInputJobNext = 1;
+
+json_spirit::Array ScanInputResults(const scaninput_job &sj) {
+    json_spirit::Array results;
+    for(const CKernelScanJob::solution &sol: sj.job->GetSolutions()) {
+        json_spirit::Object item;
+        item.push_back(json_spirit::Pair("nout", sj.vOut[sol.nInput]));
+        item.push_back(json_spirit::Pair("hash", sol.hash.GetHex()));
+        item.push_back(json_spirit::Pair("time", util::DateTimeStrFormat(sol.nTime)));
+        results.push_back(item);
+    }
+    return results;
+}
+
+json_spirit::Object ScanInputStatus(int nJob, const scaninput_job &sj) {
+    const CKernelScanJob &job = *sj.job;
+    json_spirit::Object obj;
+    obj.push_back(json_spirit::Pair("job", nJob));
+    obj.push_back(json_spirit::Pair("status", job.IsCancelled() ? "cancelled": (job.IsDone() ? "done": "running")));
+    obj.push_back(json_spirit::Pair("threads", job.GetThreads()));
+    obj.push_back(json_spirit::Pair("chunks", job.GetChunks()));
+    obj.push_back(json_spirit::Pair("chunksdone", job.GetChunksDone()));
+    obj.push_back(json_spirit::Pair("kernels", job.GetHashes()));
+    obj.push_back(json_spirit::Pair("results", ScanInputResults(sj)));
+    return obj;
+}
+
+} // namespace
+
 // scaninput '{"txid":"95d640426fe66de866a8cf2d0601d2c8cf3ec598109b4d4ffa7fd03dad6d35ce","difficulty":0.01, "days":10}'
 json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrpcData &data) {
     if (data.fHelp() || params.size() != 1) {
         return data.JSONRPCSuccess(
-            "scaninput '{\"txid\":\"txid\", \"vout\":[vout1, vout2, ..., voutN], \"difficulty\":difficulty, \"days\":days}'\n"
+            "scaninput '{\"txid\":\"txid\", \"vout\":[vout1, vout2, ..., voutN], \"difficulty\":difficulty, \"days\":days, \"threads\":threads, \"async\":async}'\n"
             "Scan specified transaction or input for suitable kernel solutions.\n"
             "    difficulty - upper limit for difficulty, current difficulty by default;\n"
-            "    days - time window, 90 days by default.\n"
+            "    days - time window, 90 days by default;\n"
+            "    threads - worker threads, all cores by default and at most;\n"
+            "    async - return a job id at once and poll the results with scaninputjob.\n"
         );
     }
 
@@ -116,6 +181,22 @@ json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrp
             return data.JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, interval length must be greater than zero");
     }
 
+    int nThreads = 0;
+    const json_spirit::Value &threads_v = find_value(scanParams, "threads");
+    if (threads_v.type() == json_spirit::int_type) {
+        nThreads = threads_v.get_int(status);
+        if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
+        if (nThreads < 0)
+            return data.JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, threads must not be negative");
+    }
+
+    bool fAsync = false;
+    const json_spirit::Value &async_v = find_value(scanParams, "async");
+    if (async_v.type() == json_spirit::bool_type) {
+        fAsync = async_v.get_bool(status);
+        if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
+    }
+
     CTransaction tx;
     uint256 hashBlock = 0;
     if (block_transaction::manage::GetTransaction(hash, tx, hashBlock)) {
@@ -163,8 +244,14 @@ json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrp
         if (! block.ReadFromDisk(txindex.get_pos().get_nFile(), txindex.get_pos().get_nBlockPos(), false))
             return data.JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "CBlock::ReadFromDisk() failed");
 
+        // scaninput is unlocked: walk pnext under cs_main so a concurrent Reorganize cannot cut it
         uint64_t nStakeModifier = 0;
-        if (! bitkernel<uint256>::GetKernelStakeModifier(block.GetHash(), nStakeModifier))
+        bool fStakeModifier = false;
+        {
+            LOCK(block_process::cs_main);
+            fStakeModifier = bitkernel<uint256>::GetKernelStakeModifier(block.GetHash(), nStakeModifier);
+        }
+        if (! fStakeModifier)
             return data.JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No kernel stake modifier generated yet");
 
         std::pair<uint32_t, uint32_t> interval;
@@ -175,7 +262,9 @@ json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrp
             interval.first += (block_check::nStakeMinAge + block.get_nTime() - interval.first);
         interval.second = interval.first + nDays * util::nOneDay;
 
-        json_spirit::Array results;
+        // (output x time window) chunks on a worker pool
+        scaninput_job sj;
+        std::vector<CKernelScanJob::input> vJobInputs;
         for(const int &nOut: vInputs) {
             // Check for spent flag
             // It doesn't make sense to scan spent inputs.
@@ -190,18 +279,35 @@ json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrp
             CDataStream ssKernel;
             ssKernel << nStakeModifier;
             ssKernel << block.get_nTime() << (txindex.get_pos().get_nTxPos() - txindex.get_pos().get_nBlockPos()) << tx.get_nTime() << nOut;
-            CDataStream::const_iterator itK = ssKernel.begin();
-            std::vector<std::pair<uint256, uint32_t> > result;
-            if (bitkernel<uint256>::ScanKernelForward((unsigned char *)&itK[0], nBits, tx.get_nTime(), tx.get_vout(nOut).get_nValue(), interval, result)) {
-                for(const std::pair<uint256, uint32_t> solution: result) {
-                    json_spirit::Object item;
-                    item.push_back(json_spirit::Pair("nout", nOut));
-                    item.push_back(json_spirit::Pair("hash", solution.first.GetHex()));
-                    item.push_back(json_spirit::Pair("time", util::DateTimeStrFormat(solution.second)));
-                    results.push_back(item);
-                }
+            CKernelScanJob::input in;
+            assert(ssKernel.size() == sizeof(in.kernel));
+            std::memcpy(in.kernel, &ssKernel.begin()[0], sizeof(in.kernel));
+            in.nInputTxTime = tx.get_nTime();
+            in.nValueIn = tx.get_vout(nOut).get_nValue();
+            vJobInputs.push_back(in);
+            sj.vOut.push_back(nOut);
+        }
+
+        if (fAsync) {
+            LOCK(cs_ScanInputJobs);
+            for(std::map<int, scaninput_job>::iterator mi = mapScanInputJobs.begin(); mi != mapScanInputJobs.end() && mapScanInputJobs.size() >= MAX_SCANINPUT_JOBS;) {
+                if (mi->second.job->IsDone())
+                    mi = mapScanInputJobs.erase(mi);
+                else
+                    ++mi;
             }
+            if (mapScanInputJobs.size() >= MAX_SCANINPUT_JOBS)
+                return data.JSONRPCError(RPC_MISC_ERROR, "Too many scaninput jobs running");
+
+            const int nJob = nScanInputJobNext++;
+            sj.job = std::make_shared<CKernelScanJob>(vJobInputs, nBits, interval.first, interval.second, nThreads);
+            mapScanInputJobs[nJob] = sj;
+            return data.JSONRPCSuccess(ScanInputStatus(nJob, sj));
         }
+
+        sj.job = std::make_shared<CKernelScanJob>(vJobInputs, nBits, interval.first, interval.second, nThreads);
+        sj.job->Wait();
+        json_spirit::Array results = ScanInputResults(sj);
         if (results.size() == 0)
             return data.JSONRPCSuccess(false);
 
@@ -210,6 +316,40 @@ json_spirit::Value CRPCTable::scaninput(const json_spirit::Array &params, CBitrp
         return data.JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available about transaction");
 }
 
+// scaninputjob 1 [cancel]
+json_spirit::Value CRPCTable::scaninputjob(const json_spirit::Array &params, CBitrpcData &data) {
+    if (data.fHelp() || params.size() < 1 || params.size() > 2) {
+        return data.JSONRPCSuccess(
+            "scaninputjob <job> [cancel]\n"
+            "Returns the progress and the kernel solutions found so far by a scaninput job started with \"async\".\n"
+            "    cancel - stop the job (false by default).\n"
+            "A job is removed once it has been returned with status done or cancelled.\n"
+        );
+    }
+
+    json_spirit::json_flags status;
+    const int nJob = params[0].get_int(status);
+    if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
+    bool fCancel = false;
+    if (params.size() > 1) {
+        fCancel = params[1].get_bool(status);
+        if(! status.fSuccess()) return data.JSONRPCError(RPC_JSON_ERROR, status.e);
+    }
+
+    LOCK(cs_ScanInputJobs);
+    std::map<int, scaninput_job>::iterator mi = mapScanInputJobs.find(nJob);
+    if (mi == mapScanInputJobs.end())
+        return data.JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, unknown scaninput job");
+
+    if (fCancel)
+        mi->second.job->Cancel();
+    const bool fDone = mi->second.job->IsDone() || mi->second.job->IsCancelled();
+    json_spirit::Object obj = ScanInputStatus(nJob, mi->second);
+    if (fDone)
+        mapScanInputJobs.erase(mi); // a cancelled job joins its workers here
+    return data.JSONRPCSuccess(obj);
+}
+
 json_spirit::Value CRPCTable::getworkex(const json_spirit::Array &params, CBitrpcData &data) {
     using mapNewBlock_t = std::map<uint256, std::pair<CBlock *, CScript> >;
     static mapNewBlock_t mapNewBlock;
@@ -325,13 +325,30 @@ json_spirit::Value CRPCTable::getnettotals(const json_spirit::Array &params, CBi
         return data.JSONRPCSuccess(
             "getnettotals\n"
             "Returns information about network traffic, including bytes in, bytes out,\n"
-            "and current time.");
+            "current time and message handler latency (complete message received to processed,\n"
+            "block inv queued to sent).");
     }
 
+    auto latency = [](int64_t nCount, int64_t nTotal, int64_t nMax) {
+        json_spirit::Object lat;
+        lat.push_back(json_spirit::Pair("count", nCount));
+        lat.push_back(json_spirit::Pair("avgms", nCount > 0 ? (double)nTotal / nCount / 1000.0: 0.0));
+        lat.push_back(json_spirit::Pair("maxms", (double)nMax / 1000.0));
+        return lat;
+    };
+
+    const net_node::message_handler_stats st = net_node::GetMessageHandlerStats();
+    json_spirit::Object handler;
+    handler.push_back(json_spirit::Pair("wakeups", st.nWakeups));
+    handler.push_back(json_spirit::Pair("visits", st.nVisits));
+    handler.push_back(json_spirit::Pair("recvlatency", latency(st.nRecvCount, st.nRecvTotal, st.nRecvMax)));
+    handler.push_back(json_spirit::Pair("relaylatency", latency(st.nRelayCount, st.nRelayTotal, st.nRelayMax)));
+
     json_spirit::Object obj;
     obj.push_back(json_spirit::Pair("totalbytesrecv", static_cast<uint64_t>(CNode::GetTotalBytesRecv())));
     obj.push_back(json_spirit::Pair("totalbytessent", static_cast<uint64_t>(CNode::GetTotalBytesSent())));
     obj.push_back(json_spirit::Pair("timemillis", static_cast<int64_t>(util::GetTimeMillis())));
+    obj.push_back(json_spirit::Pair("messagehandler", handler));
     return data.JSONRPCSuccess(obj);
 }
 
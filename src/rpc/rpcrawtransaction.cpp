@@ -13,6 +13,7 @@
 #include <net.h>
 #include <wallet.h>
 #include <util/strencodings.h>
+#include <script/sighash.h>
 
 void CRPCTable::ScriptPubKeyToJSON(const CScript &scriptPubKey, json_spirit::Object &out, bool fIncludeHex) {
     TxnOutputType::txnouttype type;
@@ -93,7 +94,7 @@ void CRPCTable::TxToJSON(const CTransaction &tx, const uint256 &hashBlock, json_
 
     if (hashBlock != 0) {
         entry.push_back(json_spirit::Pair("blockhash", hashBlock.GetHex()));
-        std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(hashBlock);
+        BlockMap::iterator mi = block_info::mapBlockIndex.find(hashBlock);
         if (mi != block_info::mapBlockIndex.end() && (*mi).second) {
             CBlockIndex *pindex = (*mi).second;
             if (pindex->IsInMainChain()) {
@@ -552,6 +553,7 @@ json_spirit::Value CRPCTable::signrawtransaction(const json_spirit::Array &param
     bool fHashSingle = ((nHashType & ~Script_param::SIGHASH_ANYONECANPAY) == Script_param::SIGHASH_SINGLE);
 
     // Sign what we can:
+    const CSignatureHashData sighash(mergedTx);
     for (unsigned int i = 0; i < mergedTx.get_vin().size(); ++i) {
         CTxIn &txin = mergedTx.set_vin(i);
         if (mapPrevOut.count(txin.get_prevout()) == 0) {
@@ -563,13 +565,13 @@ json_spirit::Value CRPCTable::signrawtransaction(const json_spirit::Array &param
         txin.set_scriptSig().clear();
         // Only sign Script_param::SIGHASH_SINGLE if there's a corresponding output:
         if (!fHashSingle || (i < mergedTx.get_vout().size()))
-            Script_util::SignSignature(keystore, prevPubKey, mergedTx, i, nHashType);
+            Script_util::SignSignature(keystore, prevPubKey, mergedTx, i, nHashType, &sighash);
 
         // ... and merge in other signatures:
         for(const CTransaction &txv: txVariants)
             txin.set_scriptSig(Script_util::CombineSignatures(prevPubKey, mergedTx, i, txin.get_scriptSig(), txv.get_vin(i).get_scriptSig()));
 
-        if (! Script_util::VerifyScript(txin.get_scriptSig(), prevPubKey, mergedTx, i, Script_param::STRICT_FLAGS, 0))
+        if (! Script_util::VerifyScript(txin.get_scriptSig(), prevPubKey, mergedTx, i, Script_param::STRICT_FLAGS, 0, &sighash))
             fComplete = false;
     }
 
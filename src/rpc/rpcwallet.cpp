@@ -43,7 +43,7 @@ void CRPCTable::WalletTxToJSON(const CWalletTx &wtx, json_spirit::Object &entry)
     if (confirms) {
         entry.push_back(json_spirit::Pair("blockhash", wtx.hashBlock.GetHex()));
         entry.push_back(json_spirit::Pair("blockindex", wtx.nIndex));
-        entry.push_back(json_spirit::Pair("blocktime", (int64_t)(block_info::mapBlockIndex[wtx.hashBlock]->get_nTime())));
+        entry.push_back(json_spirit::Pair("blocktime", (int64_t)(block_info::mapBlockIndex.get(wtx.hashBlock)->get_nTime())));
     }
     entry.push_back(json_spirit::Pair("txid", wtx.GetHash().GetHex()));
     entry.push_back(json_spirit::Pair("time", (int64_t)wtx.GetTxTime()));
@@ -148,6 +148,13 @@ json_spirit::Value CRPCTable::getkernelps(const json_spirit::Array &params, CBit
     std::ostringstream stream;
     stream << (double)GetPoSKernelPS();
     obj.push_back(json_spirit::Pair("getkernelps", stream.str().c_str()));
+
+    // local stake miner: kernels/s of each worker in the last pass
+    json_spirit::Array workers;
+    for(const miner::kernel_worker_stats &stats: miner::GetKernelWorkerStats())
+        workers.push_back(stats.dKernelsPerSec);
+    obj.push_back(json_spirit::Pair("minerkernelps", miner::GetKernelsPerSec()));
+    obj.push_back(json_spirit::Pair("minerworkers", workers));
     return data.JSONRPCSuccess(obj);
 }
 
@@ -169,7 +176,7 @@ json_spirit::Value CRPCTable::getblockchaininfo(const json_spirit::Array &params
     diff.push_back(json_spirit::Pair("search-interval", (int)block_info::nLastCoinStakeSearchInterval));
     obj.push_back(json_spirit::Pair("difficulty", diff));
 
-    const CBlockIndex *block = block_info::mapBlockIndex[block_info::hashBestChain];
+    const CBlockIndex *block = block_info::mapBlockIndex.get(block_info::hashBestChain);
     obj.push_back(json_spirit::Pair("mediantime", block->GetMedianTimePast()));
     obj.push_back(json_spirit::Pair("verificationprogress", (double)1.0)); // under development
     obj.push_back(json_spirit::Pair("initialblockdownload", block_notify<uint256>::IsInitialBlockDownload()));
@@ -1509,7 +1516,7 @@ json_spirit::Value CRPCTable::gettransaction(const json_spirit::Array &params, C
                 entry.push_back(json_spirit::Pair("confirmations", 0));
             else {
                 entry.push_back(json_spirit::Pair("blockhash", hashBlock.GetHex()));
-                std::map<uint256, CBlockIndex *>::iterator mi = block_info::mapBlockIndex.find(hashBlock);
+                BlockMap::iterator mi = block_info::mapBlockIndex.find(hashBlock);
                 if (mi != block_info::mapBlockIndex.end() && (*mi).second) {
                     CBlockIndex* pindex = (*mi).second;
                     if (pindex->IsInMainChain())
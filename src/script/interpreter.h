@@ -20,6 +20,7 @@
 
 class CPubKey;
 class CScript;
+class CSignatureHashData;
 //template <typename T> class CTransaction_impl;
 //using CTransaction = CTransaction_impl<uint256>;
 class uint256;
@@ -31,20 +32,30 @@ public:
 #ifdef CSCRIPT_PREVECTOR_ENABLE
     using valtype = prevector<PREVECTOR_N, uint8_t>;
     using statype = prevector<PREVECTOR_N, prevector<PREVECTOR_N, uint8_t> >;
+    // VerifyScript evaluation stack: standard inputs stay in the inline buffers (no heap allocation)
+    using stackval = prevector<PREVECTOR_STACKITEM_N, uint8_t>;
+    using evalstack = prevector<PREVECTOR_STACK_N, prevector<PREVECTOR_STACKITEM_N, uint8_t> >;
 #else
     using valtype = std::vector<uint8_t>;
     using statype = std::vector<std::vector<uint8_t> >;
+    using stackval = std::vector<uint8_t>;
+    using evalstack = std::vector<std::vector<uint8_t> >;
 #endif
 private:
-    static bool CastToBool(const valtype &vch);
-    static void popstack(statype &stack);
-
-    static uint256 SignatureHash(CScript scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType);
-    static bool CheckSig(script_vector vchSig, const script_vector &vchPubKey, const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, int flags);
+    template <typename V>
+    static bool CastToBool(const V &vch);
+    template <typename S>
+    static void popstack(S &stack);
+
+    static uint256 SignatureHash(CScript scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, const CSignatureHashData *psighash=nullptr);
+    template <typename V>
+    static bool CheckSig(const V &vchSig, const V &vchPubKey, const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, int flags, const CSignatureHashData *psighash=nullptr);
     static unsigned int HaveKeys(const std::vector<valtype> &pubkeys, const CKeyStore &keystore);
 
-    static bool IsCanonicalSignature(const valtype &vchSig, unsigned int flags);
-    static bool IsCanonicalPubKey(const valtype &vchPubKey, unsigned int flags);
+    template <typename V>
+    static bool IsCanonicalSignature(const V &vchSig, unsigned int flags);
+    template <typename V>
+    static bool IsCanonicalPubKey(const V &vchPubKey, unsigned int flags);
     static bool Solver(const CKeyStore &keystore, const CScript &scriptPubKey, const uint256& hash, int nHashType, CScript &scriptSigRet, TxnOutputType::txnouttype &whichTypeRet);
 
     static bool Sign1(const CKeyID &address, const CKeyStore &keystore, const uint256 &hash, int nHashType, CScript &scriptSigRet);
@@ -53,10 +64,14 @@ private:
 
     static CScript CombineSignatures(const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, const TxnOutputType::txnouttype txType, const statype &vSolutions, statype &sigs1, statype &sigs2);
 
-    static bool CheckMinimalPush(const valtype &data, ScriptOpcodes::opcodetype opcode);
+    template <typename V>
+    static bool CheckMinimalPush(const V &data, ScriptOpcodes::opcodetype opcode);
 public:
-    static bool IsDERSignature(const valtype &vchSig, bool fWithHashType=false, bool fCheckLow=false);
-    static bool EvalScript(statype &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType);
+    template <typename V>
+    static bool IsDERSignature(const V &vchSig, bool fWithHashType=false, bool fCheckLow=false);
+    // S: statype or evalstack
+    template <typename S>
+    static bool EvalScript(S &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash=nullptr);
     static bool Solver(const CScript &scriptPubKey, TxnOutputType::txnouttype &typeRet, statype &vSolutionsRet);
     static int ScriptSigArgsExpected(TxnOutputType::txnouttype t, const statype &vSolutions);
     static bool IsStandard(const CScript &scriptPubKey, TxnOutputType::txnouttype &whichType);
@@ -69,9 +84,10 @@ public:
     static bool ExtractDestinations(const CScript &scriptPubKey, TxnOutputType::txnouttype &typeRet, std::vector<CTxDestination> &addressRet, int &nRequiredRet);
     static bool ExtractAddress(const CKeyStore &keystore, const CScript &scriptPubKey, CBitcoinAddress &addressRet);
 
-    static bool SignSignature(const CKeyStore &keystore, const CScript &fromPubKey, CTransaction &txTo, unsigned int nIn, int nHashType=Script_param::SIGHASH_ALL);
-    static bool SignSignature(const CKeyStore &keystore, const CTransaction &txFrom, CTransaction &txTo, unsigned int nIn, int nHashType=Script_param::SIGHASH_ALL);
-    static bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType);
+    // psighash: shared pieces of txTo's signature hashes (CSignatureHashData), or nullptr
+    static bool SignSignature(const CKeyStore &keystore, const CScript &fromPubKey, CTransaction &txTo, unsigned int nIn, int nHashType=Script_param::SIGHASH_ALL, const CSignatureHashData *psighash=nullptr);
+    static bool SignSignature(const CKeyStore &keystore, const CTransaction &txFrom, CTransaction &txTo, unsigned int nIn, int nHashType=Script_param::SIGHASH_ALL, const CSignatureHashData *psighash=nullptr);
+    static bool VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash=nullptr);
 
     // Given two sets of signatures for scriptPubKey, possibly with OP_0 placeholders,
     // combine them intelligently and return the result.
@@ -14,15 +14,30 @@
 #include <sync/sync.h>
 #include <util.h>
 #include <address/key_io.h>
+#include <script/sigcache.h>
+#include <script/sighash.h>
 
 namespace {
-const Script_util::valtype vchFalse((uint32_t)0);
-const Script_util::valtype vchZero((uint32_t)0);
-const Script_util::valtype vchTrue((uint32_t)1, (uint8_t)1);
+template <typename V>
+struct script_bool {
+    static const V vchFalse;
+    static const V vchTrue;
+};
+template <typename V> const V script_bool<V>::vchFalse((uint32_t)0);
+template <typename V> const V script_bool<V>::vchTrue((uint32_t)1, (uint8_t)1);
 const CScriptNum bnZero(0);
 const CScriptNum bnOne(1);
 const CScriptNum bnFalse(0);
 const CScriptNum bnTrue(1);
+
+// scriptCode.FindAndDelete(CScript(vchSig)): the push of vchSig can only be in scriptCode
+// if its bytes are, so the CScript is built only in that (non-standard) case
+template <typename V>
+void FindAndDeleteSig(CScript &scriptCode, const V &vchSig) {
+    if (std::search(scriptCode.begin(), scriptCode.end(), vchSig.begin(), vchSig.end()) == scriptCode.end())
+        return;
+    scriptCode.FindAndDelete(CScript(script_vector(vchSig.begin(), vchSig.end())));
+}
 } // namespace
 
 const char *TxnOutputType::GetTxnOutputType(TxnOutputType::txnouttype t) noexcept {
@@ -336,7 +351,7 @@ bool CScript::GetOp(iterator &pc, ScriptOpcodes::opcodetype &opcodeRet, script_v
 
 bool CScript::GetOp(iterator &pc, ScriptOpcodes::opcodetype &opcodeRet) {
      const_iterator pc2 = pc;
-     bool fRet = GetScriptOp(pc2, end(), opcodeRet, nullptr);
+     bool fRet = GetScriptOp(pc2, end(), opcodeRet, (script_vector *)nullptr);
      pc = begin() + (pc2 - begin());
      return fRet;
 }
@@ -346,10 +361,17 @@ bool CScript::GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet, sc
 }
 
 bool CScript::GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet) const {
-    return GetScriptOp(pc, end(), opcodeRet, nullptr);
+    return GetScriptOp(pc, end(), opcodeRet, (script_vector *)nullptr);
+}
+
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+bool CScript::GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet, stackitem_vector &vchRet) const {
+    return GetScriptOp(pc, end(), opcodeRet, &vchRet);
 }
+#endif
 
-bool CScript::GetScriptOp(const_iterator &pc, const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, script_vector *pvchRet) {
+template <typename V>
+bool CScript::GetScriptOp(const_iterator &pc, const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, V *pvchRet) {
     using namespace ScriptOpcodes;
     opcodeRet = OP_INVALIDOPCODE;
     if (pvchRet)
@@ -417,7 +439,8 @@ std::string CScript::ToString(bool fShort/*=false*/) const {
     return str;
 }
 
-bool Script_util::CastToBool(const valtype &vch) {
+template <typename V>
+bool Script_util::CastToBool(const V &vch) {
     for (unsigned int i = 0; i < vch.size(); ++i) {
         if (vch[i] != 0) {
             // Can be negative zero
@@ -434,14 +457,16 @@ bool Script_util::CastToBool(const valtype &vch) {
 // returning a bool indicating valid or not.  There are no loops.
 #define stacktop(i) (stack.at(stack.size()+(i)))
 #define altstacktop(i) (altstack.at(altstack.size()+(i)))
-void Script_util::popstack(statype &stack) {
+template <typename S>
+void Script_util::popstack(S &stack) {
     if (stack.empty()) {
         throw std::runtime_error("popstack() : stack empty");
     }
     stack.pop_back();
 }
 
-bool Script_util::IsCanonicalPubKey(const valtype &vchPubKey, unsigned int flags) {
+template <typename V>
+bool Script_util::IsCanonicalPubKey(const V &vchPubKey, unsigned int flags) {
     if (!(flags & Script_param::SCRIPT_VERIFY_STRICTENC)) {
         return true;
     }
@@ -463,7 +488,8 @@ bool Script_util::IsCanonicalPubKey(const valtype &vchPubKey, unsigned int flags
     return true;
 }
 
-bool Script_util::IsDERSignature(const valtype &vchSig, bool fWithHashType/*= false*/, bool fCheckLow/*= false*/) {
+template <typename V>
+bool Script_util::IsDERSignature(const V &vchSig, bool fWithHashType/*= false*/, bool fCheckLow/*= false*/) {
     // See https://bitcointalk.org/index.php?topic=8392.msg127623#msg127623
     // A canonical signature exists of: <30> <total len> <02> <len R> <R> <02> <len S> <S> <hashtype>
     // Where R and S are not negative (their first byte has its highest bit not set), and not
@@ -542,14 +568,16 @@ bool Script_util::IsDERSignature(const valtype &vchSig, bool fWithHashType/*= fa
     return true;
 }
 
-bool Script_util::IsCanonicalSignature(const valtype &vchSig, unsigned int flags) {
+template <typename V>
+bool Script_util::IsCanonicalSignature(const V &vchSig, unsigned int flags) {
     if (!(flags & Script_param::SCRIPT_VERIFY_STRICTENC)) {
         return true;
     }
     return Script_util::IsDERSignature(vchSig, true, (flags & Script_param::SCRIPT_VERIFY_LOW_S) != 0);
 }
 
-bool Script_util::CheckMinimalPush(const valtype &data, ScriptOpcodes::opcodetype opcode) {
+template <typename V>
+bool Script_util::CheckMinimalPush(const V &data, ScriptOpcodes::opcodetype opcode) {
     using namespace ScriptOpcodes;
     // Excludes OP_1NEGATE, OP_1-16 since they are by definition minimal
     assert(0 <= opcode && opcode <= OP_PUSHDATA4);
@@ -575,8 +603,12 @@ bool Script_util::CheckMinimalPush(const valtype &data, ScriptOpcodes::opcodetyp
     return true;
 }
 
-bool Script_util::EvalScript(statype &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType) {
+template <typename S>
+bool Script_util::EvalScript(S &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash/* =nullptr */) {
     using namespace ScriptOpcodes;
+    using valtype = typename S::value_type;
+    const valtype &vchFalse = script_bool<valtype>::vchFalse;
+    const valtype &vchTrue = script_bool<valtype>::vchTrue;
     auto CheckLockTime = [](const int64_t &nLockTime, const CTransaction &txTo, unsigned int nIn) {
         // There are two kinds of nLockTime: lock-by-blockheight
         // and lock-by-blocktime, distinguished by whether
@@ -666,7 +698,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
     ScriptOpcodes::opcodetype opcode;
     valtype vchPushValue;
     std::vector<bool> vfExec;
-    statype altstack;
+    S altstack;
     if (script.size() > Script_const::MAX_SCRIPT_SIZE) {
         //debugcs::instance() << "EvalScript Failure A." << debugcs::endl();
         return false;
@@ -747,7 +779,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         // ( -- value)
                         //CBigNum bn((int)opcode - (int)(OP_1 - 1));
                         CScriptNum bn((int)opcode - (int)(OP_1 - 1));
-                        stack.push_back(bn.getvch());
+                        stack.push_back(bn.getvch<valtype>());
                     }
                     break;
 
@@ -1032,7 +1064,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         // -- stacksize
                         //CBigNum bn((uint16_t) stack.size());
                         CScriptNum bn((uint16_t)stack.size());
-                        stack.push_back(bn.getvch());
+                        stack.push_back(bn.getvch<valtype>());
                     }
                     break;
 
@@ -1155,7 +1187,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         }
                         //CBigNum bn((uint16_t) stacktop(-1).size());
                         CScriptNum bn((uint16_t)stacktop(-1).size());
-                        stack.push_back(bn.getvch());
+                        stack.push_back(bn.getvch<valtype>());
                     }
                     break;
 
@@ -1225,7 +1257,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         default:            assert(!"invalid opcode"); break;
                         }
                         popstack(stack);
-                        stack.push_back(bn.getvch());
+                        stack.push_back(bn.getvch<valtype>());
                     }
                     break;
 
@@ -1280,7 +1312,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         }
                         popstack(stack);
                         popstack(stack);
-                        stack.push_back(bn.getvch());
+                        stack.push_back(bn.getvch<valtype>());
 
                         if (opcode == OP_NUMEQUALVERIFY) {
                             if (CastToBool(stacktop(-1))) {
@@ -1336,7 +1368,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         } else if (opcode == OP_SHA256) {
                             SHA256(&vch[0], vch.size(), &vchHash[0]);
                         } else if (opcode == OP_HASH160) {
-                            uint160 hash160 = hash_basis::Hash160(vch);
+                            uint160 hash160 = hash_basis::Hash160(vch.begin(), vch.end());
                             std::memcpy(&vchHash[0], &hash160, sizeof(hash160));
                         } else if (opcode == OP_HASH256) {
                             uint256 hash = hash_basis::Hash(vch.begin(), vch.end());
@@ -1376,9 +1408,9 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         CScript scriptCode(pbegincodehash, pend);
 
                         // Drop the signature, since there's no way for a signature to sign itself
-                        scriptCode.FindAndDelete(CScript(vchSig));
+                        FindAndDeleteSig(scriptCode, vchSig);
 
-                        bool fSuccess = IsCanonicalSignature(vchSig, flags) && IsCanonicalPubKey(vchPubKey, flags) && CheckSig(vchSig, vchPubKey, scriptCode, txTo, nIn, nHashType, flags);
+                        bool fSuccess = IsCanonicalSignature(vchSig, flags) && IsCanonicalPubKey(vchPubKey, flags) && CheckSig(vchSig, vchPubKey, scriptCode, txTo, nIn, nHashType, flags, psighash);
 
                         popstack(stack);
                         popstack(stack);
@@ -1446,7 +1478,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                         for (int k = 0; k < nSigsCount; ++k)
                         {
                             valtype &vchSig = stacktop(-isig-k);
-                            scriptCode.FindAndDelete(CScript(vchSig));
+                            FindAndDeleteSig(scriptCode, vchSig);
                         }
 
                         bool fSuccess = true;
@@ -1456,7 +1488,7 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
                             valtype &vchPubKey = stacktop(-ikey);
 
                             // Check signature
-                            bool fOk = IsCanonicalSignature(vchSig, flags) && IsCanonicalPubKey(vchPubKey, flags) && CheckSig(vchSig, vchPubKey, scriptCode, txTo, nIn, nHashType, flags);
+                            bool fOk = IsCanonicalSignature(vchSig, flags) && IsCanonicalPubKey(vchPubKey, flags) && CheckSig(vchSig, vchPubKey, scriptCode, txTo, nIn, nHashType, flags, psighash);
 
                             if (fOk) {
                                 isig++;
@@ -1533,138 +1565,23 @@ bool Script_util::EvalScript(statype &stack, const CScript &script, const CTrans
     return true;
 }
 
-uint256 Script_util::SignatureHash(CScript scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType) {
-    if (nIn >= txTo.get_vin().size()) {
-        printf("ERROR: SignatureHash() : nIn=%d out of range\n", nIn);
-        return 1;
-    }
-    CTransaction txTmp(txTo);
-
+uint256 Script_util::SignatureHash(CScript scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, const CSignatureHashData *psighash/* =nullptr */) {
     // In case concatenating two scripts ends up with two codeseparators,
     // or an extra one at the end, this prevents all those possible incompatibilities.
     scriptCode.FindAndDelete(CScript(ScriptOpcodes::OP_CODESEPARATOR));
 
-    // Blank out other inputs' signatures
-    for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i) {
-        txTmp.set_vin(i).set_scriptSig(CScript());
-    }
-    txTmp.set_vin(nIn).set_scriptSig(scriptCode);
-
-    // Blank out some of the outputs
-    if ((nHashType & 0x1f) == Script_param::SIGHASH_NONE) {
-        // Wildcard payee
-        txTmp.set_vout().clear();
-
-        // Let the others update at will
-        for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i) {
-            if (i != nIn) {
-                txTmp.set_vin(i).set_nSequence(0);
-            }
-        }
-    } else if ((nHashType & 0x1f) == Script_param::SIGHASH_SINGLE) {
-        //
-        // Only lock-in the txout payee at same index as txin
-        //
-        unsigned int nOut = nIn;
-        if (nOut >= txTmp.get_vout().size()) {
-            printf("ERROR: SignatureHash() : nOut=%d out of range\n", nOut);
-            return 1;
-        }
-
-        txTmp.set_vout().resize(nOut+1);
-        for (unsigned int i = 0; i < nOut; ++i) {
-            txTmp.set_vout(i).SetNull();
-        }
-
-        // Let the others update at will
-        for (unsigned int i = 0; i < txTmp.get_vin().size(); ++i) {
-            if (i != nIn) {
-                txTmp.set_vin(i).set_nSequence(0);
-            }
-        }
-    }
-
-    // Blank out other inputs completely, not recommended for open transactions
-    if (nHashType & Script_param::SIGHASH_ANYONECANPAY) {
-        txTmp.set_vin(0) = txTmp.get_vin(nIn);
-        txTmp.set_vin().resize(1);
-    }
-
-    // Serialize and hash
-    CDataStream ss(SER_GETHASH, 0);
-    ss.reserve(10000);
-    ss << txTmp << nHashType;
-    return hash_basis::Hash(ss.begin(), ss.end());
+    // Serialize the modified view of txTo and hash
+    if (psighash)
+        return psighash->SignatureHash(scriptCode, txTo, nIn, nHashType);
+    return CSignatureHashData::Stream(scriptCode, txTo, nIn, nHashType);
 }
 
-// Valid signature cache, to avoid doing expensive ECDSA signature checking
-// twice for every transaction (once when accepted into memory pool, and
-// again when accepted into the block chain)
-// Singleton Class
-class CSignatureCache {
-private:
-    CSignatureCache() {}
-    CSignatureCache(const CSignatureCache &)=delete;
-    CSignatureCache(CSignatureCache &&)=delete;
-    CSignatureCache &operator=(const CSignatureCache &)=delete;
-    CSignatureCache &operator=(CSignatureCache &&)=delete;
-
-    // sigdata_type is (signature hash, signature, public key):
-    using sigdata_type = std::tuple<uint256, script_vector, CPubKey>;
-
-    std::set<sigdata_type> setValid;
-    boost::shared_mutex cs_sigcache; // std, After C++17
-public:
-    static CSignatureCache signatureCache;
-    bool Get(const uint256 &hash, const script_vector &vchSig, const CPubKey &pubKey) {
-        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
-
-        sigdata_type k(hash, vchSig, pubKey);
-        std::set<sigdata_type>::iterator mi = setValid.find(k);
-        if (mi != setValid.end()) {
-            return true;
-        }
-        return false;
-    }
-
-    void Set(const uint256 &hash, const script_vector &vchSig, const CPubKey &pubKey) {
-        // DoS prevention: limit cache size to less than 10MB
-        // (~200 bytes per cache entry times 50,000 entries)
-        // Since there are a maximum of 20,000 signature operations per block
-        // 50,000 is a reasonable default.
-        int64_t nMaxCacheSize = map_arg::GetArg("-maxsigcachesize", 50000);
-        if (nMaxCacheSize <= 0) {
-            return;
-        }
-
-        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
-
-        while (static_cast<int64_t>(setValid.size()) > nMaxCacheSize) {
-            // Evict a random entry. Random because that helps
-            // foil would-be DoS attackers who might try to pre-generate
-            // and re-use a set of valid signatures just-slightly-greater
-            // than our cache size.
-            uint256 randomHash = bitsystem::GetRandHash();
-            script_vector unused;
-            CPubKey unusedpubkey;
-            std::set<sigdata_type>::iterator it = setValid.lower_bound(sigdata_type(randomHash, unused, unusedpubkey));
-            if (it == setValid.end()) {
-                it = setValid.begin();
-            }
-            setValid.erase(*it);
-        }
-
-        sigdata_type k(hash, vchSig, pubKey);
-        setValid.insert(k);
-    }
-};
-CSignatureCache CSignatureCache::signatureCache;
-
-bool Script_util::CheckSig(script_vector vchSig, const script_vector &vchPubKey, const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, int flags) {
+template <typename V>
+bool Script_util::CheckSig(const V &vchSig, const V &vchPubKey, const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType, int flags, const CSignatureHashData *psighash/* =nullptr */) {
     //
     // static CSignatureCache signatureCache;
     //
-    CPubKey pubkey(vchPubKey);
+    CPubKey pubkey(vchPubKey.data(), vchPubKey.data() + vchPubKey.size());
     if (! pubkey.IsValid()) {
         return false;
     }
@@ -1678,18 +1595,21 @@ bool Script_util::CheckSig(script_vector vchSig, const script_vector &vchPubKey,
     } else if (nHashType != vchSig.back()) {
         return false;
     }
-    vchSig.pop_back();
 
-    uint256 sighash = SignatureHash(scriptCode, txTo, nIn, nHashType);
+    // the DER signature is verified in place (without the hash type), not copied
+    const unsigned char *pchSig = vchSig.data();
+    const size_t nSigLen = vchSig.size() - 1;
+
+    uint256 sighash = SignatureHash(scriptCode, txTo, nIn, nHashType, psighash);
 
-    if (CSignatureCache::signatureCache.Get(sighash, vchSig, pubkey)) {
+    if (CSignatureCache::signatureCache.Get(sighash, pchSig, nSigLen, pubkey)) {
         return true;
     }
-    if (! pubkey.Verify(sighash, vchSig)) {
+    if (! pubkey.Verify(sighash, pchSig, nSigLen)) {
         return false;
     }
     if (!(flags & Script_param::SCRIPT_VERIFY_NOCACHE)) {
-        CSignatureCache::signatureCache.Set(sighash, vchSig, pubkey);
+        CSignatureCache::signatureCache.Set(sighash, pchSig, nSigLen, pubkey);
     }
 
     return true;
@@ -2235,15 +2155,15 @@ bool Script_util::ExtractDestinations(const CScript &scriptPubKey, TxnOutputType
     return true;
 }
 
-bool Script_util::VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType) {
-    statype stack, stackCopy;
-    if (! Script_util::EvalScript(stack, scriptSig, txTo, nIn, flags, nHashType)) {
+bool Script_util::VerifyScript(const CScript &scriptSig, const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash/* =nullptr */) {
+    evalstack stack, stackCopy;
+    if (! Script_util::EvalScript(stack, scriptSig, txTo, nIn, flags, nHashType, psighash)) {
         return false;
     }
     if (flags & Script_param::SCRIPT_VERIFY_P2SH) {
         stackCopy = stack;
     }
-    if (! Script_util::EvalScript(stack, scriptPubKey, txTo, nIn, flags, nHashType)) {
+    if (! Script_util::EvalScript(stack, scriptPubKey, txTo, nIn, flags, nHashType, psighash)) {
         return false;
     }
     if (stack.empty()) {
@@ -2265,11 +2185,11 @@ bool Script_util::VerifyScript(const CScript &scriptSig, const CScript &scriptPu
         // an empty stack and the EvalScript above would return false.
         assert(!stackCopy.empty());
 
-        const valtype &pubKeySerialized = stackCopy.back();
-        CScript pubKey2(pubKeySerialized.begin(), pubKeySerialized.end());
+        const stackval &pubKeySerialized = stackCopy.back();
+        CScript pubKey2(pubKeySerialized.data(), pubKeySerialized.data() + pubKeySerialized.size());
         popstack(stackCopy);
 
-        if (! Script_util::EvalScript(stackCopy, pubKey2, txTo, nIn, flags, nHashType)) {
+        if (! Script_util::EvalScript(stackCopy, pubKey2, txTo, nIn, flags, nHashType, psighash)) {
             return false;
         }
         if (stackCopy.empty()) {
@@ -2280,13 +2200,13 @@ bool Script_util::VerifyScript(const CScript &scriptSig, const CScript &scriptPu
     return true;
 }
 
-bool Script_util::SignSignature(const CKeyStore &keystore, const CScript &fromPubKey, CTransaction &txTo, unsigned int nIn, int nHashType/* =Script_param::SIGHASH_ALL */) {
+bool Script_util::SignSignature(const CKeyStore &keystore, const CScript &fromPubKey, CTransaction &txTo, unsigned int nIn, int nHashType/* =Script_param::SIGHASH_ALL */, const CSignatureHashData *psighash/* =nullptr */) {
     assert(nIn < txTo.get_vin().size());
     CTxIn &txin = txTo.set_vin(nIn);
 
     // Leave out the signature from the hash, since a signature can't sign itself.
     // The checksig op will also drop the signatures from its hash.
-    uint256 hash = SignatureHash(fromPubKey, txTo, nIn, nHashType);
+    uint256 hash = SignatureHash(fromPubKey, txTo, nIn, nHashType, psighash);
 
     TxnOutputType::txnouttype whichType;
     if (! Script_util::Solver(keystore, fromPubKey, hash, nHashType, txin.set_scriptSig(), whichType)) {
@@ -2302,7 +2222,7 @@ bool Script_util::SignSignature(const CKeyStore &keystore, const CScript &fromPu
         CScript subscript = txin.get_scriptSig();
 
         // Recompute txn hash using subscript in place of scriptPubKey:
-        uint256 hash2 = SignatureHash(subscript, txTo, nIn, nHashType);
+        uint256 hash2 = SignatureHash(subscript, txTo, nIn, nHashType, psighash);
 
         TxnOutputType::txnouttype subType;
         bool fSolved = Script_util::Solver(keystore, subscript, hash2, nHashType, txin.set_scriptSig(), subType) && subType != TxnOutputType::TX_SCRIPTHASH;
@@ -2318,10 +2238,10 @@ bool Script_util::SignSignature(const CKeyStore &keystore, const CScript &fromPu
     }
 
     // Test solution
-    return VerifyScript(txin.get_scriptSig(), fromPubKey, txTo, nIn, Script_param::STRICT_FLAGS, 0);
+    return VerifyScript(txin.get_scriptSig(), fromPubKey, txTo, nIn, Script_param::STRICT_FLAGS, 0, psighash);
 }
 
-bool Script_util::SignSignature(const CKeyStore &keystore, const CTransaction &txFrom, CTransaction &txTo, unsigned int nIn, int nHashType) {
+bool Script_util::SignSignature(const CKeyStore &keystore, const CTransaction &txFrom, CTransaction &txTo, unsigned int nIn, int nHashType, const CSignatureHashData *psighash) {
     assert(nIn < txTo.get_vin().size());
 
     CTxIn &txin = txTo.set_vin(nIn);
@@ -2329,7 +2249,7 @@ bool Script_util::SignSignature(const CKeyStore &keystore, const CTransaction &t
     assert(txin.get_prevout().get_hash() == txFrom.GetHash());
     const CTxOut &txout = txFrom.get_vout(txin.get_prevout().get_n());
 
-    return SignSignature(keystore, txout.get_scriptPubKey(), txTo, nIn, nHashType);
+    return SignSignature(keystore, txout.get_scriptPubKey(), txTo, nIn, nHashType, psighash);
 }
 
 CScript Script_util::CombineSignatures(const CScript &scriptPubKey, const CTransaction &txTo, unsigned int nIn, const TxnOutputType::txnouttype txType, const statype &vSolutions, statype &sigs1, statype &sigs2) {
@@ -2553,3 +2473,11 @@ void CScript::SetMultisig(int nRequired, const std::vector<CPubKey> &keys) {
 
     *this << EncodeOP_N((int)(keys.size())) << ScriptOpcodes::OP_CHECKMULTISIG;
 }
+
+template bool Script_util::IsDERSignature<Script_util::valtype>(const Script_util::valtype &vchSig, bool fWithHashType, bool fCheckLow);
+template bool Script_util::EvalScript<Script_util::statype>(Script_util::statype &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash);
+template bool CScript::GetScriptOp<script_vector>(const_iterator &pc, const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, script_vector *pvchRet);
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+template bool Script_util::EvalScript<Script_util::evalstack>(Script_util::evalstack &stack, const CScript &script, const CTransaction &txTo, unsigned int nIn, unsigned int flags, int nHashType, const CSignatureHashData *psighash);
+template bool CScript::GetScriptOp<stackitem_vector>(const_iterator &pc, const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, stackitem_vector *pvchRet);
+#endif
@@ -304,9 +304,11 @@ namespace ScriptOpcodes
 #ifdef CSCRIPT_PREVECTOR_ENABLE
 using script_vector = prevector<PREVECTOR_N, uint8_t>;
 using stack_vector = prevector<PREVECTOR_N, prevector<PREVECTOR_N, uint8_t> >;
+using stackitem_vector = prevector<PREVECTOR_STACKITEM_N, uint8_t>;
 #else
 using script_vector = std::vector<uint8_t>;
 using stack_vector = std::vector<std::vector<uint8_t> >;
+using stackitem_vector = std::vector<uint8_t>;
 #endif
 class CScript final : public script_vector
 {
@@ -483,7 +485,11 @@ public:
     bool GetOp(iterator &pc, ScriptOpcodes::opcodetype &opcodeRet);
     bool GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet, script_vector &vchRet) const;
     bool GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet) const;
-    static bool GetScriptOp(const_iterator &pc, script_vector::const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, script_vector *pvchRet);
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+    bool GetOp(const_iterator &pc, ScriptOpcodes::opcodetype &opcodeRet, stackitem_vector &vchRet) const;
+#endif
+    template <typename V>
+    static bool GetScriptOp(const_iterator &pc, script_vector::const_iterator end, ScriptOpcodes::opcodetype &opcodeRet, V *pvchRet);
 
     //
     // Encode/decode small integers
@@ -30,6 +30,7 @@ class CScriptNum
 public:
 #ifdef CSCRIPT_PREVECTOR_ENABLE
 using script_vector = prevector<PREVECTOR_N, unsigned char>;
+using stackitem_vector = prevector<PREVECTOR_STACKITEM_N, unsigned char>;
 #else
 using script_vector = std::vector<unsigned char>;
 #endif
@@ -43,6 +44,22 @@ using script_vector = std::vector<unsigned char>;
 
     explicit CScriptNum(const script_vector &vch, bool fRequireMinimal,
                         const size_t nMaxNumSize = nDefaultMaxNumSize)
+    {
+        m_value = check_vch(vch, fRequireMinimal, nMaxNumSize);
+    }
+
+#ifdef CSCRIPT_PREVECTOR_ENABLE
+    // an operand on the Script_util::evalstack
+    explicit CScriptNum(const stackitem_vector &vch, bool fRequireMinimal,
+                        const size_t nMaxNumSize = nDefaultMaxNumSize)
+    {
+        m_value = check_vch(vch, fRequireMinimal, nMaxNumSize);
+    }
+#endif
+
+private:
+    template <typename V>
+    static int64_t check_vch(const V &vch, bool fRequireMinimal, const size_t nMaxNumSize)
     {
         if (vch.size() > nMaxNumSize) {
             throw scriptnum_error("script number overflow");
@@ -65,9 +82,11 @@ using script_vector = std::vector<unsigned char>;
                 }
             }
         }
-        m_value = set_vch(vch);
+        return set_vch(vch);
     }
 
+public:
+
     inline bool operator==(const int64_t& rhs) const    { return m_value == rhs; }
     inline bool operator!=(const int64_t& rhs) const    { return m_value != rhs; }
     inline bool operator<=(const int64_t& rhs) const    { return m_value <= rhs; }
@@ -142,17 +161,19 @@ using script_vector = std::vector<unsigned char>;
         return m_value;
     }
 
-    script_vector getvch() const
+    template <typename V = script_vector>
+    V getvch() const
     {
-        return serialize(m_value);
+        return serialize<V>(m_value);
     }
 
-    static script_vector serialize(const int64_t& value)
+    template <typename V = script_vector>
+    static V serialize(const int64_t& value)
     {
         if(value == 0)
-            return script_vector();
+            return V();
 
-        script_vector result;
+        V result;
         const bool neg = value < 0;
         uint64_t absvalue = neg ? -value : value;
 
@@ -181,7 +202,8 @@ using script_vector = std::vector<unsigned char>;
     }
 
 private:
-    static int64_t set_vch(const script_vector &vch)
+    template <typename V>
+    static int64_t set_vch(const V &vch)
     {
       if (vch.empty())
           return 0;
@@ -0,0 +1,157 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <script/sigcache.h>
+#include <key/pubkey.h>
+#include <random/random.h>
+#include <util/logging.h>
+#include <algorithm>
+#include <mutex>
+
+CSignatureCache CSignatureCache::signatureCache;
+CScriptExecutionCache CScriptExecutionCache::cache;
+
+void CSaltedKeyCache::Setup(size_t nBytes) {
+    fEnabled = false;
+    nMaxBytes = nBytes;
+
+    unsigned char salt[32];
+    latest_crypto::random::GetRandBytes(salt, sizeof(salt));
+    hasherSalted.Reset().Write(salt, sizeof(salt));
+
+    const size_t nBuckets = std::max<size_t>(1, nMaxBytes / (SHARDS * WAYS * sizeof(uint256)));
+    for (shard &s: shards) {
+        std::unique_lock<boost::shared_mutex> lock(s.cs);
+        std::vector<uint256>().swap(s.vKey);
+        s.nBuckets = 0;
+        s.nEntries = 0;
+        if (nMaxBytes > 0) {
+            s.vKey.assign(nBuckets * WAYS, uint256(0));
+            s.nBuckets = nBuckets;
+        }
+    }
+    fEnabled = (nMaxBytes > 0);
+}
+
+bool CSaltedKeyCache::Contains(const uint256 &key) {
+    shard &s = Shard(key);
+    {
+        boost::shared_lock<boost::shared_mutex> lock(s.cs);
+        const uint256 *pbucket = s.vKey.data() + Bucket(s, key);
+        for (unsigned int i = 0; i < WAYS; ++i) {
+            if (pbucket[i] == key) {
+                s.nHits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    s.nMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CSaltedKeyCache::Insert(const uint256 &key) {
+    if (key == 0) // reserved for empty slots
+        return;
+
+    shard &s = Shard(key);
+    std::unique_lock<boost::shared_mutex> lock(s.cs);
+    uint256 *pbucket = s.vKey.data() + Bucket(s, key);
+    for (unsigned int i = 0; i < WAYS; ++i) {
+        if (pbucket[i] == key)
+            return;
+    }
+    for (unsigned int i = 0; i < WAYS; ++i) {
+        if (pbucket[i] == 0) {
+            pbucket[i] = key;
+            ++s.nEntries;
+            s.nInserts.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Bucket is full: evict a way picked by other bits of the salted key. Random because
+    // that helps foil would-be DoS attackers who might try to pre-generate and re-use a set
+    // of valid signatures just-slightly-greater than our cache size.
+    pbucket[key.Get64(1) % WAYS] = key;
+    s.nInserts.fetch_add(1, std::memory_order_relaxed);
+    s.nEvictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+CSaltedKeyCache::stats CSaltedKeyCache::GetStats() const {
+    stats st = {nMaxBytes, 0, 0, 0, 0, 0, 0};
+    for (const shard &s: shards) {
+        {
+            boost::shared_lock<boost::shared_mutex> lock(s.cs);
+            st.nCapacity += s.vKey.size();
+            st.nEntries += s.nEntries;
+        }
+        st.nHits += s.nHits.load(std::memory_order_relaxed);
+        st.nMisses += s.nMisses.load(std::memory_order_relaxed);
+        st.nInserts += s.nInserts.load(std::memory_order_relaxed);
+        st.nEvictions += s.nEvictions.load(std::memory_order_relaxed);
+    }
+    return st;
+}
+
+void sigcache::Setup(int nMiB) {
+    const size_t nBytes = (nMiB > 0) ? ((size_t)nMiB << 20) : 0;
+    CSignatureCache::signatureCache.Setup(nBytes / 2);
+    CScriptExecutionCache::cache.Setup(nBytes / 2);
+    if (nBytes > 0) {
+        logging::LogPrintf("Using %uMiB for the signature cache (%u entries) and the script execution cache (%u entries)\n",
+            nMiB, CSignatureCache::signatureCache.GetStats().nCapacity, CScriptExecutionCache::cache.GetStats().nCapacity);
+    }
+}
+
+uint256 CSignatureCache::ComputeKey(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey) const {
+    uint256 key;
+    keys.GetHasher().Write(hash.begin(), hash.size()).Write(pchSig, nSigLen).Write(pubKey.begin(), pubKey.size()).Finalize(key.begin());
+    return key;
+}
+
+bool CSignatureCache::Get(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey) {
+    if (! keys.IsEnabled())
+        return false;
+    return keys.Contains(ComputeKey(hash, pchSig, nSigLen, pubKey));
+}
+
+void CSignatureCache::Set(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey) {
+    if (! keys.IsEnabled())
+        return;
+    keys.Insert(ComputeKey(hash, pchSig, nSigLen, pubKey));
+}
+
+std::string CSignatureCache::ToString() const {
+    const CSaltedKeyCache::stats st = GetStats();
+    return tfm::format("CSignatureCache(size=%uKiB, entries=%u/%u, hits=%u, misses=%u, evictions=%u)",
+        st.nMaxBytes >> 10, st.nEntries, st.nCapacity, st.nHits, st.nMisses, st.nEvictions);
+}
+
+uint256 CScriptExecutionCache::ComputeKey(const uint256 &hashTx, unsigned int flags) const {
+    unsigned char vchFlags[4];
+    const uint32_t nFlags = flags & ~(uint32_t)Script_param::SCRIPT_VERIFY_NOCACHE;
+    for (int i = 0; i < 4; ++i)
+        vchFlags[i] = (unsigned char)(nFlags >> (8 * i));
+    uint256 key;
+    keys.GetHasher().Write(hashTx.begin(), hashTx.size()).Write(vchFlags, sizeof(vchFlags)).Finalize(key.begin());
+    return key;
+}
+
+bool CScriptExecutionCache::Get(const uint256 &hashTx, unsigned int flags) {
+    if (! keys.IsEnabled())
+        return false;
+    return keys.Contains(ComputeKey(hashTx, flags));
+}
+
+void CScriptExecutionCache::Set(const uint256 &hashTx, unsigned int flags) {
+    if (! keys.IsEnabled())
+        return;
+    keys.Insert(ComputeKey(hashTx, flags));
+}
+
+std::string CScriptExecutionCache::ToString() const {
+    const CSaltedKeyCache::stats st = GetStats();
+    return tfm::format("CScriptExecutionCache(size=%uKiB, entries=%u/%u, hits=%u, misses=%u, evictions=%u)",
+        st.nMaxBytes >> 10, st.nEntries, st.nCapacity, st.nHits, st.nMisses, st.nEvictions);
+}
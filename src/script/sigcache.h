@@ -0,0 +1,141 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_SIGCACHE_H
+#define SORACHANCOIN_SIGCACHE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <uint256.h>
+#include <crypto/sha256.h>
+#include <script/script.h>
+#include <boost/thread/shared_mutex.hpp>
+
+class CPubKey;
+
+// Set of salted 32-byte keys, bounded by a memory budget
+// A key is SHA256(salt || data); the salt is random per process, so the slot an entry
+// lands in and the entry it evicts cannot be chosen by a peer. Keys live in SHARDS
+// independent tables of 4-way buckets, each behind its own shared_mutex: lookups only
+// share-lock one shard and never wait for each other, and an insert blocks one shard
+// for a few compares.
+class CSaltedKeyCache
+{
+    CSaltedKeyCache(const CSaltedKeyCache &)=delete;
+    CSaltedKeyCache &operator=(const CSaltedKeyCache &)=delete;
+private:
+    static constexpr unsigned int SHARDS = 16;
+    static constexpr unsigned int WAYS = 4;
+
+    struct alignas(64) shard {
+        mutable boost::shared_mutex cs;
+        std::vector<uint256> vKey; // nBuckets * WAYS, null: empty slot
+        size_t nBuckets;
+        size_t nEntries;
+        std::atomic<uint64_t> nHits;
+        std::atomic<uint64_t> nMisses;
+        std::atomic<uint64_t> nInserts;
+        std::atomic<uint64_t> nEvictions;
+        shard() : nBuckets(0), nEntries(0), nHits(0), nMisses(0), nInserts(0), nEvictions(0) {}
+    };
+
+    shard shards[SHARDS];
+    latest_crypto::CSHA256 hasherSalted; // written once by Setup, then only copied
+    std::atomic<bool> fEnabled;
+    size_t nMaxBytes;
+
+    shard &Shard(const uint256 &key) {return shards[key.Get64(0) % SHARDS];}
+    static size_t Bucket(const shard &s, const uint256 &key) {return (size_t)((key.Get64(0) / SHARDS) % s.nBuckets) * WAYS;}
+public:
+    CSaltedKeyCache() : fEnabled(false), nMaxBytes(0) {}
+
+    // init, before any lookup: draws the salt and sizes the shards (0: disabled)
+    void Setup(size_t nBytes);
+    bool IsEnabled() const {return fEnabled;}
+
+    // a copy of the salted hasher; write the data and Finalize into the key
+    latest_crypto::CSHA256 GetHasher() const {return hasherSalted;}
+    bool Contains(const uint256 &key);
+    void Insert(const uint256 &key);
+
+    struct stats {
+        size_t nMaxBytes;
+        size_t nCapacity;
+        size_t nEntries;
+        uint64_t nHits;
+        uint64_t nMisses;
+        uint64_t nInserts;
+        uint64_t nEvictions;
+    };
+    stats GetStats() const;
+};
+
+// -maxsigcachesize (MiB) is shared by the signature cache and the script execution cache
+namespace sigcache
+{
+    const int DEFAULT_MAX_SIZE = 32; // MiB
+
+    // init: sizes both caches, half of the budget each
+    void Setup(int nMiB);
+}
+
+// Valid signature cache, to avoid doing expensive ECDSA signature checking
+// twice for every transaction (once when accepted into memory pool, and
+// again when accepted into the block chain)
+// An entry is SHA256(salt || sighash || signature || pubkey).
+// Singleton Class
+class CSignatureCache
+{
+private:
+    CSignatureCache() {}
+    CSignatureCache(const CSignatureCache &)=delete;
+    CSignatureCache(CSignatureCache &&)=delete;
+    CSignatureCache &operator=(const CSignatureCache &)=delete;
+    CSignatureCache &operator=(CSignatureCache &&)=delete;
+
+    CSaltedKeyCache keys;
+    uint256 ComputeKey(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey) const;
+public:
+    static CSignatureCache signatureCache;
+
+    void Setup(size_t nBytes) {keys.Setup(nBytes);}
+    // pchSig, nSigLen: DER signature (without the hash type byte)
+    bool Get(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey);
+    void Set(const uint256 &hash, const unsigned char *pchSig, size_t nSigLen, const CPubKey &pubKey);
+
+    CSaltedKeyCache::stats GetStats() const {return keys.GetStats();}
+    std::string ToString() const;
+};
+
+// Script execution cache
+// Transactions whose scripts passed with the flags ConnectBlock will use
+// (block_check::manage::GetBlockScriptFlags) are remembered by CTxMemPool::accept, so
+// ConnectInputs does not queue their CScriptChecks again when they arrive in a block.
+// An entry is SHA256(salt || tx hash || flags); SCRIPT_VERIFY_NOCACHE is not part of the
+// flags, any other flag change misses.
+// Singleton Class
+class CScriptExecutionCache
+{
+private:
+    CScriptExecutionCache() {}
+    CScriptExecutionCache(const CScriptExecutionCache &)=delete;
+    CScriptExecutionCache(CScriptExecutionCache &&)=delete;
+    CScriptExecutionCache &operator=(const CScriptExecutionCache &)=delete;
+    CScriptExecutionCache &operator=(CScriptExecutionCache &&)=delete;
+
+    CSaltedKeyCache keys;
+    uint256 ComputeKey(const uint256 &hashTx, unsigned int flags) const;
+public:
+    static CScriptExecutionCache cache;
+
+    void Setup(size_t nBytes) {keys.Setup(nBytes);}
+    bool Get(const uint256 &hashTx, unsigned int flags);
+    void Set(const uint256 &hashTx, unsigned int flags);
+
+    CSaltedKeyCache::stats GetStats() const {return keys.GetStats();}
+    std::string ToString() const;
+};
+
+#endif // SORACHANCOIN_SIGCACHE_H
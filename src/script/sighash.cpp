@@ -0,0 +1,154 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <script/sighash.h>
+#include <script/script.h>
+#include <hash.h>
+#include <serialize.h>
+
+namespace {
+
+bool HasTime(const CTransaction &txTo) {
+    return txTo.get_nVersion() == 1 || txTo.get_nVersion() == 2;
+}
+
+// CHashWriter that resumes from a saved SHA256 state
+class CMidstateWriter
+{
+private:
+    latest_crypto::CSHA256 ctx;
+public:
+    explicit CMidstateWriter(const latest_crypto::CSHA256 &midstate) : ctx(midstate) {}
+    int GetType() const noexcept {return SER_GETHASH;}
+    int GetVersion() const noexcept {return 0;}
+
+    CMidstateWriter &write(const char *pch, size_t size) {
+        ctx.Write((const unsigned char *)pch, size);
+        return *this;
+    }
+    template<typename T>
+    CMidstateWriter &operator<<(const T &obj) {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+
+    uint256 GetHash() {
+        uint256 hash1;
+        ctx.Finalize((unsigned char *)&hash1);
+        uint256 hash2;
+        ctx.Reset().Write((const unsigned char *)&hash1, sizeof(hash1)).Finalize((unsigned char *)&hash2);
+        return hash2;
+    }
+};
+
+} // namespace
+
+CSignatureHashData::CSignatureHashData(const CTransaction &txTo) {
+    const std::vector<CTxIn> &vin = txTo.get_vin();
+    const std::vector<CTxOut> &vout = txTo.get_vout();
+
+    CDataStream ss(SER_GETHASH, 0);
+    ss << txTo.get_nVersion();
+    if (HasTime(txTo))
+        ss << txTo.get_nTime();
+    compact_size::manage::WriteCompactSize(ss, vin.size());
+    latest_crypto::CSHA256 ctx;
+    ctx.Write((const unsigned char *)&ss.begin()[0], ss.size());
+
+    ss.clear();
+    ss.reserve(vin.size() * INPUT_SIZE);
+    const CScript scriptEmpty;
+    for (const CTxIn &txin: vin)
+        ss << txin.get_prevout() << scriptEmpty << txin.get_nSequence();
+    vchInputs.assign(ss.begin(), ss.end());
+    assert(vchInputs.size() == vin.size() * INPUT_SIZE);
+
+    vMidstate.reserve(vin.size());
+    for (size_t i = 0; i < vin.size(); ++i) {
+        vMidstate.push_back(ctx);
+        ctx.Write(vchInputs.data() + i * INPUT_SIZE, INPUT_SIZE);
+    }
+
+    ss.clear();
+    compact_size::manage::WriteCompactSize(ss, vout.size());
+    for (const CTxOut &txout: vout)
+        ss << txout;
+    ss << txTo.get_nLockTime();
+    vchTail.assign(ss.begin(), ss.end());
+}
+
+uint256 CSignatureHashData::SignatureHash(const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType) const {
+    // SIGHASH_NONE, SIGHASH_SINGLE and ANYONECANPAY change other inputs or outputs
+    if ((nHashType & Script_param::SIGHASH_ANYONECANPAY) ||
+        (nHashType & 0x1f) == Script_param::SIGHASH_NONE ||
+        (nHashType & 0x1f) == Script_param::SIGHASH_SINGLE ||
+        nIn >= GetInputCount())
+        return Stream(scriptCode, txTo, nIn, nHashType);
+
+    const unsigned char *pin = vchInputs.data() + nIn * INPUT_SIZE;
+    CMidstateWriter ss(vMidstate[nIn]);
+    ss.write((const char *)pin, 36);                            // prevout
+    ss << scriptCode;
+    ss.write((const char *)pin + INPUT_SIZE - 4, 4);            // nSequence
+    ss.write((const char *)pin + INPUT_SIZE, vchInputs.data() + vchInputs.size() - (pin + INPUT_SIZE));
+    ss.write((const char *)vchTail.data(), vchTail.size());
+    ss << nHashType;
+    return ss.GetHash();
+}
+
+// The serialization of txTo after the edits of the original SignatureHash:
+// other scriptSigs empty, SIGHASH_NONE: no outputs and other nSequence 0,
+// SIGHASH_SINGLE: outputs up to nIn with the others null and other nSequence 0,
+// ANYONECANPAY: only input nIn.
+uint256 CSignatureHashData::Stream(const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType) {
+    const std::vector<CTxIn> &vin = txTo.get_vin();
+    const std::vector<CTxOut> &vout = txTo.get_vout();
+    if (nIn >= vin.size()) {
+        printf("ERROR: SignatureHash() : nIn=%d out of range\n", nIn);
+        return 1;
+    }
+
+    const bool fAnyoneCanPay = (nHashType & Script_param::SIGHASH_ANYONECANPAY) != 0;
+    const bool fHashNone = (nHashType & 0x1f) == Script_param::SIGHASH_NONE;
+    const bool fHashSingle = (nHashType & 0x1f) == Script_param::SIGHASH_SINGLE;
+    if (fHashSingle && nIn >= vout.size()) {
+        printf("ERROR: SignatureHash() : nOut=%d out of range\n", nIn);
+        return 1;
+    }
+
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << txTo.get_nVersion();
+    if (HasTime(txTo))
+        ss << txTo.get_nTime();
+
+    const unsigned int nInputs = fAnyoneCanPay ? 1 : vin.size();
+    compact_size::manage::WriteCompactSize(ss, nInputs);
+    const unsigned char chEmpty = 0; // empty scriptSig
+    for (unsigned int n = 0; n < nInputs; ++n) {
+        const unsigned int i = fAnyoneCanPay ? nIn : n;
+        ss << vin[i].get_prevout();
+        if (i == nIn)
+            ss << scriptCode;
+        else
+            ss.write((const char *)&chEmpty, 1);
+        if (i != nIn && (fHashNone || fHashSingle))
+            ss << (uint32_t)0;
+        else
+            ss << vin[i].get_nSequence();
+    }
+
+    const unsigned int nOutputs = fHashNone ? 0 : (fHashSingle ? nIn + 1 : vout.size());
+    compact_size::manage::WriteCompactSize(ss, nOutputs);
+    for (unsigned int i = 0; i < nOutputs; ++i) {
+        if (fHashSingle && i != nIn) {
+            ss << (int64_t)-1;     // CTxOut::SetNull()
+            ss.write((const char *)&chEmpty, 1);
+        } else
+            ss << vout[i];
+    }
+
+    ss << txTo.get_nLockTime();
+    ss << nHashType;
+    return ss.GetHash();
+}
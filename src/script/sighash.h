@@ -0,0 +1,45 @@
+// Copyright (c) 2018-2021 The SorachanCoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SORACHANCOIN_SIGHASH_H
+#define SORACHANCOIN_SIGHASH_H
+
+#include <vector>
+#include <uint256.h>
+#include <crypto/sha256.h>
+#include <block/transaction.h>
+
+class CScript;
+
+// Legacy signature hash without a temporary transaction
+// Script_util::SignatureHash used to copy txTo, blank every other scriptSig and serialize
+// the copy for each input. Stream() writes the same bytes (the modified view of txTo)
+// straight into a CHashWriter.
+//
+// For transactions with many inputs, CSignatureHashData serializes the parts shared by
+// every SIGHASH_ALL hash once: each input with an empty scriptSig and the outputs with
+// nLockTime, plus the SHA256 state after the header and inputs 0..i-1 for every i.
+// A hash of input i then resumes from that state and only writes input i, the inputs
+// after it and the outputs, which halves the bytes hashed for the whole transaction.
+// The data must be built after vin and vout are final; scriptSigs may change.
+class CSignatureHashData
+{
+private:
+    std::vector<unsigned char> vchInputs;   // every input with an empty scriptSig, INPUT_SIZE bytes each
+    std::vector<unsigned char> vchTail;     // vout and nLockTime
+    std::vector<latest_crypto::CSHA256> vMidstate; // [i]: after nVersion (nTime), the number of inputs and inputs 0..i-1
+public:
+    static constexpr size_t INPUT_SIZE = 32 + 4 + 1 + 4; // prevout, empty scriptSig, nSequence
+    static constexpr size_t MIN_INPUTS = 2;              // below this, Stream() is as fast
+
+    explicit CSignatureHashData(const CTransaction &txTo);
+
+    size_t GetInputCount() const noexcept {return vchInputs.size() / INPUT_SIZE;}
+
+    // scriptCode: OP_CODESEPARATORs already removed
+    uint256 SignatureHash(const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType) const;
+    static uint256 Stream(const CScript &scriptCode, const CTransaction &txTo, unsigned int nIn, int nHashType);
+};
+
+#endif // SORACHANCOIN_SIGHASH_H
@@ -5,9 +5,12 @@
 // file license.txt or http://www.opensource.org/licenses/mit-license.php.
 
 #include <map>
+#include <atomic>
 #include <boost/version.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <leveldb/env.h>
 #include <leveldb/cache.h>
 #include <leveldb/filter_policy.h>
@@ -18,13 +21,20 @@
 #include <util.h>
 #include <main.h>
 #include <util/logging.h>
+#include <util/system.h>
 #include <file_operate/iofs.h>
 #include <sync/sync.h>
 #include <debugcs/debugcs.h>
+#include <block/prevout_cache.h>
+#include <file_operate/block_mmap.h>
+#include <file_operate/block_store.h>
+#include <block/block_index_snapshot.h>
 
 static void oldblockindex_remove(bool fRemoveOld) {
     fs::path directory = iofs::GetDataDir() / "txleveldb";
     if (fRemoveOld) {
+        block_store::Flush();
+        block_mmap::CloseAll();
         fs::remove_all(directory); // remove directory
         unsigned int nFile = 1;
         for (;;) {
@@ -71,27 +81,93 @@ void CTxDB_impl<HASH>::init_blockindex(const char *pszMode, bool fRemoveOld /*=
 
 // CLevelDB subclasses are created and destroyed VERY OFTEN. That's why we shouldn't treat this as a free operations.
 template <typename HASH>
-CTxDB_impl<HASH>::CTxDB_impl(const char *pszMode/* ="r+" */) : CLevelDB(CLevelDBEnv::getname_mainchain(), pszMode) {
+CTxDB_impl<HASH>::CTxDB_impl(const char *pszMode/* ="r+" */) : CLevelDB(CLevelDBEnv::getname_mainchain(), pszMode), fTxnActive(false) {
     assert(pszMode);
 }
 
 template <typename HASH>
 CTxDB_impl<HASH>::~CTxDB_impl() {}
 
+template <typename HASH>
+bool CTxDB_impl<HASH>::TxnBegin()
+{
+    if (! CLevelDB::TxnBegin())
+        return false;
+
+    mapTxIndexPending.clear();
+    fTxnActive = true;
+    return true;
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::TxnCommit()
+{
+    assert(fTxnActive);
+    fTxnActive = false;
+    for (typename std::map<HASH, CTxIndex>::const_iterator mi = mapTxIndexPending.begin(); mi != mapTxIndexPending.end(); ++mi) {
+        bool fRet = mi->second.IsNull() ? Erase(std::make_pair(std::string("tx"), mi->first)): Write(std::make_pair(std::string("tx"), mi->first), mi->second);
+        if (! fRet) {
+            mapTxIndexPending.clear();
+            CLevelDB::TxnAbort();
+            return logging::error("CTxDB::TxnCommit() : failed to batch tx index %s", mi->first.ToString().substr(0,10).c_str());
+        }
+    }
+
+    if (! CLevelDB::TxnCommit()) {
+        mapTxIndexPending.clear();
+        return false;
+    }
+
+    CPrevoutCache_impl<HASH>::cache.Apply(mapTxIndexPending);
+    mapTxIndexPending.clear();
+    return true;
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::TxnAbort()
+{
+    mapTxIndexPending.clear();
+    fTxnActive = false;
+    return CLevelDB::TxnAbort();
+}
+
 template <typename HASH>
 bool CTxDB_impl<HASH>::ReadTxIndex(HASH hash, CTxIndex &txindex)
 {
     assert(!args_bool::fClient);
 
+    if (fTxnActive) {
+        typename std::map<HASH, CTxIndex>::const_iterator mi = mapTxIndexPending.find(hash);
+        if (mi != mapTxIndexPending.end()) {
+            txindex = mi->second;
+            return !txindex.IsNull();
+        }
+    }
+    if (CPrevoutCache_impl<HASH>::cache.GetTxIndex(hash, txindex))
+        return true;
+
     txindex.SetNull();
-    return Read(std::make_pair(std::string("tx"), hash), txindex);
+    if (! Read(std::make_pair(std::string("tx"), hash), txindex))
+        return false;
+
+    CPrevoutCache_impl<HASH>::cache.SetTxIndex(hash, txindex);
+    return true;
 }
 
 template <typename HASH>
 bool CTxDB_impl<HASH>::UpdateTxIndex(HASH hash, const CTxIndex &txindex)
 {
     assert(!args_bool::fClient);
-    return Write(std::make_pair(std::string("tx"), hash), txindex);
+
+    if (fTxnActive) {
+        mapTxIndexPending[hash] = txindex;
+        return true;
+    }
+    if (! Write(std::make_pair(std::string("tx"), hash), txindex))
+        return false;
+
+    CPrevoutCache_impl<HASH>::cache.SetTxIndex(hash, txindex);
+    return true;
 }
 
 template <typename HASH>
@@ -102,7 +178,7 @@ bool CTxDB_impl<HASH>::AddTxIndex(const CTransaction_impl<HASH> &tx, const CDisk
     // Add to tx index
     HASH hash = tx.GetHash();
     CTxIndex txindex(pos, tx.get_vout().size());
-    return Write(std::make_pair(std::string("tx"), hash), txindex);
+    return UpdateTxIndex(hash, txindex);
 }
 
 template <typename HASH>
@@ -111,13 +187,31 @@ bool CTxDB_impl<HASH>::EraseTxIndex(const CTransaction_impl<HASH> &tx)
     assert(!args_bool::fClient);
     HASH hash = tx.GetHash();
 
-    return Erase(std::make_pair(std::string("tx"), hash));
+    if (fTxnActive) {
+        mapTxIndexPending[hash].SetNull();
+        return true;
+    }
+    if (! Erase(std::make_pair(std::string("tx"), hash)))
+        return false;
+
+    CPrevoutCache_impl<HASH>::cache.Erase(hash);
+    return true;
 }
 
 template <typename HASH>
 bool CTxDB_impl<HASH>::ContainsTx(HASH hash)
 {
     assert(!args_bool::fClient);
+
+    if (fTxnActive) {
+        typename std::map<HASH, CTxIndex>::const_iterator mi = mapTxIndexPending.find(hash);
+        if (mi != mapTxIndexPending.end())
+            return !mi->second.IsNull();
+    }
+    CTxIndex txindex;
+    if (CPrevoutCache_impl<HASH>::cache.GetTxIndex(hash, txindex))
+        return true;
+
     return Exists(std::make_pair(std::string("tx"), hash));
 }
 
@@ -156,7 +250,61 @@ bool CTxDB_impl<HASH>::ReadDiskTx(COutPoint_impl<HASH> outpoint, CTransaction_im
 template <typename HASH>
 bool CTxDB_impl<HASH>::WriteBlockIndex(const CDiskBlockIndex &blockindex)
 {
-    return Write(std::make_pair(std::string("blockindex"), blockindex.GetBlockHash()), blockindex);
+    const HASH hash = blockindex.GetBlockHash();
+    if (block_index_snapshot::IsJournal() && !Write(std::make_pair(std::string("blockindexdirty"), hash), '\0'))
+        return false;
+    return Write(std::make_pair(std::string("blockindex"), hash), blockindex);
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::ReadBlockIndexSnapshot(std::pair<uint64_t, HASH> &marker)
+{
+    return Read(std::string("blockindexsnapshot"), marker);
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::WriteBlockIndexSnapshot(const std::pair<uint64_t, HASH> &marker)
+{
+    return Write(std::string("blockindexsnapshot"), marker);
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::EraseBlockIndexSnapshot()
+{
+    return Erase(std::string("blockindexsnapshot"));
+}
+
+// block hashes written by WriteBlockIndex since the snapshot
+template <typename HASH>
+bool CTxDB_impl<HASH>::ReadBlockIndexJournal(std::vector<HASH> &vHash) const
+{
+    std::unique_ptr<leveldb::Iterator> it(this->NewIterator(std::string("blockindexdirty"), HASH(0)));
+    if (! it)
+        return false;
+    for (; it->Valid(); it->Next()) {
+        CDBStream ssKey(const_cast<char *>(it->key().data()), it->key().size());
+        std::string strType;
+        ::Unserialize(ssKey, strType);
+        if (strType != "blockindexdirty")
+            break;
+        HASH hash;
+        ::Unserialize(ssKey, hash);
+        vHash.push_back(hash);
+    }
+    return it->status().ok();
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::EraseBlockIndexJournal()
+{
+    std::vector<HASH> vHash;
+    if (! ReadBlockIndexJournal(vHash))
+        return false;
+    for (const HASH &hash: vHash) {
+        if (! Erase(std::make_pair(std::string("blockindexdirty"), hash)))
+            return false;
+    }
+    return true;
 }
 
 template <typename HASH>
@@ -220,19 +368,17 @@ bool CTxDB_impl<HASH>::WriteModifierUpgradeTime(const unsigned int &nUpgradeTime
 }
 
 template <typename HASH>
-static CBlockIndex_impl<HASH> *InsertBlockIndex(const HASH &hash, std::map<HASH, CBlockIndex_impl<HASH> *> &mapBlockIndex) {
+static CBlockIndex_impl<HASH> *InsertBlockIndex(const HASH &hash, CBlockIndexMap_impl<HASH> &mapBlockIndex) {
     if (hash == 0)
         return nullptr;
 
     // Return existing
-    typename std::map<HASH, CBlockIndex_impl<HASH> *>::iterator mi = mapBlockIndex.find(hash);
+    typename CBlockIndexMap_impl<HASH>::iterator mi = mapBlockIndex.find(hash);
     if (mi != mapBlockIndex.end())
         return (*mi).second;
 
     // Create new
-    CBlockIndex_impl<HASH> *pindexNew = new(std::nothrow) CBlockIndex_impl<HASH>;
-    if (! pindexNew)
-        throw std::runtime_error("LoadBlockIndex() : CBlockIndex failed to allocate memory");
+    CBlockIndex_impl<HASH> *pindexNew = mapBlockIndex.NewIndex();
 
     mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     pindexNew->set_phashBlock(&((*mi).first));
@@ -240,93 +386,315 @@ static CBlockIndex_impl<HASH> *InsertBlockIndex(const HASH &hash, std::map<HASH,
     return pindexNew;
 }
 
+//
+// LoadBlockIndex shard: decodes the "blockindex" keys whose first hash byte is in [nBegin, nEnd).
+// Deserializing and hashing (scrypt, unless the hash is stored) run on worker threads;
+// the entries are linked into mapBlockIndex afterwards on the calling thread.
+//
 template <typename HASH>
-bool CTxDB_impl<HASH>::LoadBlockIndex(
-        std::map<HASH, CBlockIndex_impl<HASH> *> &mapBlockIndex,
-        std::set<std::pair<COutPoint_impl<HASH>, unsigned int>> &setStakeSeen,
-        CBlockIndex_impl<HASH> *&pindexGenesisBlock,
-        HASH &hashBestChain,
-        int &nBestHeight,
-        CBlockIndex_impl<HASH> *&pindexBest,
-        HASH &nBestInvalidTrust,
-        HASH &nBestChainTrust)
+class CBlockIndexLoadShard
 {
-    if (mapBlockIndex.size() > 0) {
-        // Already loaded once in this session. It can happen during migration from BDB.
-        return true;
+    CBlockIndexLoadShard(const CBlockIndexLoadShard &)=delete;
+    CBlockIndexLoadShard &operator=(const CBlockIndexLoadShard &)=delete;
+public:
+    struct entry {
+        HASH hash;
+        HASH hashPrev;
+        HASH hashNext;
+        CBlockIndex_impl<HASH> index;
+        explicit entry(const CDiskBlockIndex_impl<HASH> &diskindex) :
+            hash(diskindex.GetBlockHash()), hashPrev(diskindex.get_hashPrev()), hashNext(diskindex.get_hashNext()), index(diskindex) {
+            index.set_phashBlock(nullptr);
+            index.set_hashPrevBlock(hashPrev); // fixed: prevHash
+        }
+    };
+
+    // itIn is positioned at the first key of the shard
+    CBlockIndexLoadShard(leveldb::Iterator *itIn, unsigned int nEndIn) : it(itIn), nEnd(nEndIn) {}
+
+    void Do() {
+        try {
+            for (; it->Valid(); it->Next()) {
+                CDBStream ssKey(const_cast<char *>(it->key().data()), it->key().size());
+                std::string strType;
+                HASH hashKey;
+                ::Unserialize(ssKey, strType);
+                if (args_bool::fRequestShutdown || strType != "blockindex")
+                    break;
+                ::Unserialize(ssKey, hashKey);
+                if (*hashKey.begin() >= nEnd)
+                    break;
+
+                CDBStream ssValue(const_cast<char *>(it->value().data()), it->value().size());
+                CDiskBlockIndex_impl<HASH> diskindex;
+                ::Unserialize(ssValue, diskindex);
+
+                vEntry.emplace_back(diskindex);
+            }
+        } catch (const std::exception &ex) {
+            strError = ex.what();
+        }
+        it.reset();
     }
 
-    // The block index is an in-memory structure that maps hashes to on-disk
-    // locations where the contents of the block can be found. Here, we scan it
-    // out of the DB and into mapBlockIndex.
+    std::vector<entry> &get_vEntry() {return vEntry;}
+    const std::string &get_strError() const {return strError;}
+private:
+    std::unique_ptr<leveldb::Iterator> it;
+    unsigned int nEnd;
+    std::vector<entry> vEntry;
+    std::string strError;
+};
+
+//
+// -checkblocks / -checklevel: the blocks of the best chain are read and checked on worker threads.
+// Each block stops at its first failure (the block itself, or the lowest failing tx) and keeps
+// that one message. The results are reduced in height order afterwards, so the log and the fork
+// point do not depend on thread timing.
+//
+template <typename HASH>
+class CBlockVerifyJob
+{
+    CBlockVerifyJob(const CBlockVerifyJob &)=delete;
+    CBlockVerifyJob &operator=(const CBlockVerifyJob &)=delete;
+public:
+    struct result {
+        bool fReadFailed;
+        bool fBad;
+        int nBadTx;             // index of the first failing tx, -1: CheckBlock failed
+        std::string strBad;
+        result() : fReadFailed(false), fBad(false), nBadTx(-1) {}
+    };
+
+    CBlockVerifyJob(CTxDB_impl<HASH> &txdbIn, const std::vector<CBlockIndex_impl<HASH> *> &vIndexIn,
+                    const std::map<std::pair<unsigned int, unsigned int>, CBlockIndex_impl<HASH> *> &mapBlockPosIn, int nCheckLevelIn) :
+        txdb(txdbIn), vIndex(vIndexIn), mapBlockPos(mapBlockPosIn), nCheckLevel(nCheckLevelIn), nNext(0), vResult(vIndexIn.size()) {}
+
+    // thread entry: takes the next unchecked block until none is left
+    void Do() {
+        for (;;) {
+            const size_t i = nNext++;
+            if (i >= vIndex.size() || args_bool::fRequestShutdown)
+                break;
+            Verify(vIndex[i], vResult[i]);
+        }
+    }
 
-    // Seek to start key.
-    if(! this->seek(std::string("blockindex"), HASH(0))) {
-        return logging::error("LoadBlockIndex() Error: memory allocate failure.");
+    const std::vector<result> &get_vResult() const {return vResult;}
+private:
+    // only the first failure of a block is kept
+    void Bad(result &res, int nTx, const std::string &str) {
+        if (res.fBad)
+            return;
+        res.fBad = true;
+        res.nBadTx = nTx;
+        res.strBad = str;
     }
+    void Verify(const CBlockIndex_impl<HASH> *pindex, result &res);
 
-    // Now read each entry.
-    for(const_iterator iterator=this->begin(); iterator!=this->end(); ++iterator)
-    {
-        // Unpack keys and values.
-        CDBStream ssKey(const_cast<char *>(iterator->key().data()), iterator->key().size());
-        CDBStream ssValue(const_cast<char *>(iterator->value().data()), iterator->value().size());
-        std::string strType;
-        ::Unserialize(ssKey, strType);
+    CTxDB_impl<HASH> &txdb;
+    const std::vector<CBlockIndex_impl<HASH> *> &vIndex;
+    const std::map<std::pair<unsigned int, unsigned int>, CBlockIndex_impl<HASH> *> &mapBlockPos;
+    const int nCheckLevel;
+    std::atomic<size_t> nNext;
+    std::vector<result> vResult;
+};
 
-        // Did we reach the end of the data to read?
-        if (args_bool::fRequestShutdown || strType != "blockindex") {
-            break;
-        }
+template <typename HASH>
+void CBlockVerifyJob<HASH>::Verify(const CBlockIndex_impl<HASH> *pindex, result &res)
+{
+    CBlock_impl<HASH> block;
+    if (! block.ReadFromDisk(pindex)) {
+        res.fReadFailed = true;
+        return;
+    }
 
-        CDiskBlockIndex_impl<HASH> diskindex;
-        ::Unserialize(ssValue, diskindex);
-
-        HASH blockHash = diskindex.GetBlockHash();
-
-        // Construct block index object
-        CBlockIndex_impl<HASH> *pindexNew = InsertBlockIndex(blockHash, mapBlockIndex);
-        pindexNew->set_pprev(InsertBlockIndex(diskindex.get_hashPrev(), mapBlockIndex));
-        pindexNew->set_pnext(InsertBlockIndex(diskindex.get_hashNext(), mapBlockIndex));
-        pindexNew->set_nFile(diskindex.get_nFile());
-        pindexNew->set_nBlockPos(diskindex.get_nBlockPos());
-        pindexNew->set_nHeight(diskindex.get_nHeight());
-        pindexNew->set_nMint(diskindex.get_nMint());
-        pindexNew->set_nMoneySupply(diskindex.get_nMoneySupply());
-        pindexNew->set_nFlags(diskindex.get_nFlags());
-        pindexNew->set_nStakeModifier(diskindex.get_nStakeModifier());
-        pindexNew->set_prevoutStake(diskindex.get_prevoutStake());
-        pindexNew->set_nStakeTime(diskindex.get_nStakeTime());
-        pindexNew->set_hashProofOfStake(diskindex.get_hashProofOfStake());
-        pindexNew->set_nVersion(diskindex.get_nVersion());
-        pindexNew->set_hashMerkleRoot(diskindex.get_hashMerkleRoot());
-        pindexNew->set_nTime(diskindex.get_nTime());
-        pindexNew->set_nBits(diskindex.get_nBits());
-        pindexNew->set_nNonce(diskindex.get_nNonce());
-        pindexNew->set_hashPrevBlock(diskindex.get_hashPrev()); // fixed: prevHash
-
-        // Watch for genesis block
-        if (pindexGenesisBlock == nullptr && blockHash == (!args_bool::fTestNet ? block_params::hashGenesisBlock : block_params::hashGenesisBlockTestNet)) {
-            pindexGenesisBlock = pindexNew;
-        }
+    //
+    // check level 1: verify block validity
+    // check level 7: verify block signature too
+    //
+    if (nCheckLevel > 0 && !block.CheckBlock(true, true, (nCheckLevel > 6))) {
+        Bad(res, -1, tfm::format("LoadBlockIndex() : *** found bad block at %d, hash=%s\n", pindex->get_nHeight(), pindex->GetBlockHash().ToString().c_str()));
+        return;
+    }
+
+    //
+    // check level 2: verify transaction index validity
+    //
+    if (nCheckLevel > 1) {
+        for(int nTx = 0; nTx < (int)block.get_vtx().size(); ++nTx)
+        {
+            const CTransaction_impl<HASH> &tx = block.get_vtx()[nTx];
+            HASH hashTx = tx.GetHash();
+            CTxIndex txindex;
+            if (txdb.ReadTxIndex(hashTx, txindex)) {
+                //
+                // check level 3: checker transaction hashes
+                //
+                if (nCheckLevel>2 || pindex->get_nFile() != txindex.get_pos().get_nFile() || pindex->get_nBlockPos() != txindex.get_pos().get_nBlockPos()) {
+                    //
+                    // either an error or a duplicate transaction
+                    //
+                    CTransaction_impl<HASH> txFound;
+                    if (! txFound.ReadFromDisk(txindex.get_pos())) {
+                        Bad(res, nTx, tfm::format("LoadBlockIndex() : *** cannot read mislocated transaction %s\n", hashTx.ToString().c_str()));
+                    } else {
+                        if (txFound.GetHash() != hashTx) { // not a duplicate tx
+                            Bad(res, nTx, tfm::format("LoadBlockIndex(): *** invalid tx position for %s\n", hashTx.ToString().c_str()));
+                        }
+                    }
+                }
+
+                //
+                // check level 4: check whether spent txouts were spent within the main chain
+                // (by this block or one above it in the checked range)
+                //
+                unsigned int nOutput = 0;
+                if (nCheckLevel > 3) {
+                    for(const CDiskTxPos &txpos: txindex.get_vSpent())
+                    {
+                        if (! txpos.IsNull()) {
+                            typename std::map<std::pair<unsigned int, unsigned int>, CBlockIndex_impl<HASH> *>::const_iterator mi = mapBlockPos.find(std::make_pair(txpos.get_nFile(), txpos.get_nBlockPos()));
+                            if (mi == mapBlockPos.end() || mi->second->get_nHeight() < pindex->get_nHeight()) {
+                                Bad(res, nTx, tfm::format("LoadBlockIndex(): *** found bad spend at %d, hashBlock=%s, hashTx=%s\n", pindex->get_nHeight(), pindex->GetBlockHash().ToString().c_str(), hashTx.ToString().c_str()));
+                            }
+
+                            //
+                            // check level 6: check whether spent txouts were spent by a valid transaction that consume them
+                            //
+                            if (nCheckLevel > 5) {
+                                CTransaction_impl<HASH> txSpend;
+                                if (! txSpend.ReadFromDisk(txpos)) {
+                                    Bad(res, nTx, tfm::format("LoadBlockIndex(): *** cannot read spending transaction of %s:%i from disk\n", hashTx.ToString().c_str(), nOutput));
+                                } else if (!txSpend.CheckTransaction()) {
+                                    Bad(res, nTx, tfm::format("LoadBlockIndex(): *** spending transaction of %s:%i is invalid\n", hashTx.ToString().c_str(), nOutput));
+                                } else {
+                                    bool fFound = false;
+                                    for(const CTxIn_impl<HASH> &txin: txSpend.get_vin())
+                                    {
+                                        if (txin.get_prevout().get_hash() == hashTx && txin.get_prevout().get_n() == nOutput) {
+                                            fFound = true;
+                                        }
+                                    }
+                                    if (! fFound) {
+                                        Bad(res, nTx, tfm::format("LoadBlockIndex(): *** spending transaction of %s:%i does not spend it\n", hashTx.ToString().c_str(), nOutput));
+                                    }
+                                }
+                            }
+                        }
+                        ++nOutput;
+                    }
+                }
+            }
 
-        if (! pindexNew->CheckIndex()) {
-            return logging::error("LoadBlockIndex() : CheckIndex failed at %d", pindexNew->get_nHeight());
+            //
+            // check level 5: check whether all prevouts are marked spent
+            //
+            if (nCheckLevel > 4) {
+                for(const CTxIn_impl<HASH> &txin: tx.get_vin())
+                {
+                    CTxIndex txindex;
+                    if (txdb.ReadTxIndex(txin.get_prevout().get_hash(), txindex)) {
+                        if (txindex.get_vSpent().size() - 1 < txin.get_prevout().get_n() || txindex.get_vSpent(txin.get_prevout().get_n()).IsNull()) {
+                            Bad(res, nTx, tfm::format("LoadBlockIndex(): *** found unspent prevout %s:%i in %s\n", txin.get_prevout().get_hash().ToString().c_str(), txin.get_prevout().get_n(), hashTx.ToString().c_str()));
+                        }
+                    }
+                }
+            }
+
+            if (res.fBad)
+                return;
         }
+    }
+}
 
-        // ppcoin: build setStakeSeen
-        if (pindexNew->IsProofOfStake()) {
-            setStakeSeen.insert(std::make_pair(pindexNew->get_prevoutStake(), pindexNew->get_nStakeTime()));
+template <typename HASH>
+bool CTxDB_impl<HASH>::LoadBlockIndexEntries(
+        CBlockIndexMap_impl<HASH> &mapBlockIndex,
+        std::set<std::pair<COutPoint_impl<HASH>, unsigned int>> &setStakeSeen,
+        CBlockIndex_impl<HASH> *&pindexGenesisBlock)
+{
+    // The block index is an in-memory structure that maps hashes to on-disk
+    // locations where the contents of the block can be found. Here, we scan it
+    // out of the DB and into mapBlockIndex.
+    //
+    // 1, decode: the key range is split by the first byte of the block hash
+    //    and each shard is read and deserialized on its own thread.
+    int64_t nStart = util::GetTimeMillis();
+    const unsigned int nShards = std::min(std::max(lutil::GetNumCores(), 1), MAX_LOAD_SHARDS);
+    std::vector<std::unique_ptr<CBlockIndexLoadShard<HASH> > > vShards;
+    for (unsigned int i = 0; i < nShards; ++i) {
+        const unsigned int nBegin = 256 * i / nShards;
+        const unsigned int nEnd = 256 * (i + 1) / nShards;
+        HASH hashStart(0);
+        *hashStart.begin() = (unsigned char)nBegin;
+        leveldb::Iterator *it = this->NewIterator(std::string("blockindex"), hashStart);
+        if (! it) {
+            return logging::error("LoadBlockIndex() Error: memory allocate failure.");
+        }
+        vShards.emplace_back(new CBlockIndexLoadShard<HASH>(it, nEnd));
+    }
+    if (nShards == 1) {
+        vShards[0]->Do();
+    } else {
+        boost::thread_group group;
+        for (unsigned int i = 0; i < nShards; ++i) {
+            group.create_thread(boost::bind(&CBlockIndexLoadShard<HASH>::Do, vShards[i].get()));
         }
+        group.join_all();
     }
     if (args_bool::fRequestShutdown) {
         return true;
     }
+    size_t nEntries = 0;
+    for (const std::unique_ptr<CBlockIndexLoadShard<HASH> > &shard: vShards) {
+        if (! shard->get_strError().empty()) {
+            return logging::error("LoadBlockIndex() : %s", shard->get_strError().c_str());
+        }
+        nEntries += shard->get_vEntry().size();
+    }
+    const int64_t nDecodeTime = util::GetTimeMillis() - nStart;
+
+    // 2, link: copy the entries into the arena, then resolve pprev / pnext.
+    nStart = util::GetTimeMillis();
+    mapBlockIndex.reserve(nEntries);
+    for (const std::unique_ptr<CBlockIndexLoadShard<HASH> > &shard: vShards) {
+        for (const typename CBlockIndexLoadShard<HASH>::entry &e: shard->get_vEntry()) {
+            CBlockIndex_impl<HASH> *pindexNew = mapBlockIndex.NewIndex(e.index);
+            typename CBlockIndexMap_impl<HASH>::iterator mi = mapBlockIndex.insert(std::make_pair(e.hash, pindexNew)).first;
+            pindexNew->set_phashBlock(&((*mi).first));
+        }
+    }
+    for (const std::unique_ptr<CBlockIndexLoadShard<HASH> > &shard: vShards) {
+        for (const typename CBlockIndexLoadShard<HASH>::entry &e: shard->get_vEntry()) {
+            CBlockIndex_impl<HASH> *pindexNew = mapBlockIndex.find(e.hash)->second;
+            pindexNew->set_pprev(InsertBlockIndex(e.hashPrev, mapBlockIndex));
+            pindexNew->set_pnext(InsertBlockIndex(e.hashNext, mapBlockIndex));
+
+            // Watch for genesis block
+            if (pindexGenesisBlock == nullptr && e.hash == (!args_bool::fTestNet ? block_params::hashGenesisBlock : block_params::hashGenesisBlockTestNet)) {
+                pindexGenesisBlock = pindexNew;
+            }
+
+            if (! pindexNew->CheckIndex()) {
+                return logging::error("LoadBlockIndex() : CheckIndex failed at %d", pindexNew->get_nHeight());
+            }
+
+            // ppcoin: build setStakeSeen
+            if (pindexNew->IsProofOfStake()) {
+                setStakeSeen.insert(std::make_pair(pindexNew->get_prevoutStake(), pindexNew->get_nStakeTime()));
+            }
+        }
+    }
+    vShards.clear();
+    const int64_t nLinkTime = util::GetTimeMillis() - nStart;
+    logging::LogPrintf("LoadBlockIndex(): %s\n", mapBlockIndex.ToString().c_str());
 
-    // Calculate nChainTrust
+    // 3, Calculate nChainTrust
+    nStart = util::GetTimeMillis();
     std::vector<std::pair<int, CBlockIndex *> > vSortedByHeight;
     vSortedByHeight.reserve(mapBlockIndex.size());
-    for(const std::pair<HASH, CBlockIndex *>&item: mapBlockIndex) {
+    for(const typename CBlockIndexMap_impl<HASH>::value_type &item: mapBlockIndex) {
         CBlockIndex *pindex = item.second;
         vSortedByHeight.push_back(std::make_pair(pindex->get_nHeight(), pindex));
     }
@@ -342,6 +710,140 @@ bool CTxDB_impl<HASH>::LoadBlockIndex(
             return logging::error("CTxDB::LoadBlockIndex() : Failed stake modifier checkpoint height=%d, modifier=0x%016" PRIx64, pindex->get_nHeight(), pindex->get_nStakeModifier());
         }
     }
+    const int64_t nTrustTime = util::GetTimeMillis() - nStart;
+    logging::LogPrintf("LoadBlockIndex(): %" PRIszu " entries, %u shards: decode %" PRId64 "ms, link %" PRId64 "ms, chain trust %" PRId64 "ms\n",
+        nEntries, nShards, nDecodeTime, nLinkTime, nTrustTime);
+
+    return true;
+}
+
+template <typename HASH>
+static void SetBlockIndexFromDisk(CBlockIndex_impl<HASH> *pindex, const CDiskBlockIndex_impl<HASH> &diskindex) {
+    pindex->set_nFile(diskindex.get_nFile());
+    pindex->set_nBlockPos(diskindex.get_nBlockPos());
+    pindex->set_nHeight(diskindex.get_nHeight());
+    pindex->set_nMint(diskindex.get_nMint());
+    pindex->set_nMoneySupply(diskindex.get_nMoneySupply());
+    pindex->set_nFlags(diskindex.get_nFlags());
+    pindex->set_nStakeModifier(diskindex.get_nStakeModifier());
+    pindex->set_prevoutStake(diskindex.get_prevoutStake());
+    pindex->set_nStakeTime(diskindex.get_nStakeTime());
+    pindex->set_hashProofOfStake(diskindex.get_hashProofOfStake());
+    pindex->set_nVersion(diskindex.get_nVersion());
+    pindex->set_hashMerkleRoot(diskindex.get_hashMerkleRoot());
+    pindex->set_nTime(diskindex.get_nTime());
+    pindex->set_nBits(diskindex.get_nBits());
+    pindex->set_nNonce(diskindex.get_nNonce());
+    pindex->set_hashPrevBlock(diskindex.get_hashPrev()); // fixed: prevHash
+}
+
+// Snapshot (-indexsnapshot) followed by the journaled entries. false: load from LevelDB instead.
+template <typename HASH>
+bool CTxDB_impl<HASH>::LoadBlockIndexSnapshot(
+        CBlockIndexMap_impl<HASH> &mapBlockIndex,
+        std::set<std::pair<COutPoint_impl<HASH>, unsigned int>> &setStakeSeen,
+        CBlockIndex_impl<HASH> *&pindexGenesisBlock)
+{
+    std::pair<uint64_t, HASH> marker;
+    if (! ReadBlockIndexSnapshot(marker)) {
+        return false;
+    }
+    block_index_snapshot::SetJournal(true);
+
+    const int64_t nStart = util::GetTimeMillis();
+    HASH hashSnapshotBest;
+    if (! block_index_snapshot::Load(marker, mapBlockIndex, setStakeSeen, pindexGenesisBlock, hashSnapshotBest)) {
+        return false;
+    }
+
+    auto fail = [&](const char *reason) {
+        mapBlockIndex.clear();
+        setStakeSeen.clear();
+        pindexGenesisBlock = nullptr;
+        return logging::error("LoadBlockIndexSnapshot() : %s, loading from the database", reason);
+    };
+
+    std::vector<HASH> vJournal;
+    HASH hashBestChain;
+    if (! ReadBlockIndexJournal(vJournal) || !ReadHashBestChain(hashBestChain)) {
+        return fail("journal not readable");
+    }
+    if (vJournal.empty() && hashBestChain != hashSnapshotBest) {
+        return fail("best chain moved without a journal");
+    }
+
+    // replay the block index entries written after the snapshot
+    std::vector<std::pair<int, CBlockIndex *> > vReplayed;
+    vReplayed.reserve(vJournal.size());
+    for (const HASH &hash: vJournal) {
+        CDiskBlockIndex_impl<HASH> diskindex;
+        if (! Read(std::make_pair(std::string("blockindex"), hash), diskindex)) {
+            return fail("journaled entry missing");
+        }
+        CBlockIndex_impl<HASH> *pindex = InsertBlockIndex(hash, mapBlockIndex);
+        SetBlockIndexFromDisk(pindex, diskindex);
+        pindex->set_pprev(InsertBlockIndex(diskindex.get_hashPrev(), mapBlockIndex));
+        pindex->set_pnext(InsertBlockIndex(diskindex.get_hashNext(), mapBlockIndex));
+        if (pindexGenesisBlock == nullptr && hash == (!args_bool::fTestNet ? block_params::hashGenesisBlock : block_params::hashGenesisBlockTestNet)) {
+            pindexGenesisBlock = pindex;
+        }
+        if (pindex->IsProofOfStake()) {
+            setStakeSeen.insert(std::make_pair(pindex->get_prevoutStake(), pindex->get_nStakeTime()));
+        }
+        vReplayed.push_back(std::make_pair(pindex->get_nHeight(), pindex));
+    }
+
+    // parents come first: the snapshot already carries the trust of everything below
+    std::sort(vReplayed.begin(), vReplayed.end());
+    for (const std::pair<int, CBlockIndex *> &item: vReplayed) {
+        CBlockIndex *pindex = item.second;
+        pindex->set_nChainTrust((pindex->get_pprev() ? pindex->get_pprev()->get_nChainTrust() : 0) + pindex->GetBlockTrust());
+        pindex->set_nStakeModifierChecksum(bitkernel<HASH>::GetStakeModifierChecksum(pindex));
+        if (! bitkernel<HASH>::CheckStakeModifierCheckpoints(pindex->get_nHeight(), pindex->get_nStakeModifierChecksum())) {
+            return fail("failed stake modifier checkpoint");
+        }
+    }
+    if (hashBestChain != 0 && !mapBlockIndex.count(hashBestChain)) {
+        return fail("hashBestChain not found");
+    }
+
+    logging::LogPrintf("LoadBlockIndex(): snapshot %" PRIszu " entries, %" PRIszu " journaled, %" PRId64 "ms\n",
+        mapBlockIndex.size(), vJournal.size(), util::GetTimeMillis() - nStart);
+    return true;
+}
+
+template <typename HASH>
+bool CTxDB_impl<HASH>::LoadBlockIndex(
+        CBlockIndexMap_impl<HASH> &mapBlockIndex,
+        std::set<std::pair<COutPoint_impl<HASH>, unsigned int>> &setStakeSeen,
+        CBlockIndex_impl<HASH> *&pindexGenesisBlock,
+        HASH &hashBestChain,
+        int &nBestHeight,
+        CBlockIndex_impl<HASH> *&pindexBest,
+        HASH &nBestInvalidTrust,
+        HASH &nBestChainTrust)
+{
+    if (mapBlockIndex.size() > 0) {
+        // Already loaded once in this session. It can happen during migration from BDB.
+        return true;
+    }
+
+    bool fSnapshot = false;
+    if (block_index_snapshot::IsEnabled()) {
+        fSnapshot = LoadBlockIndexSnapshot(mapBlockIndex, setStakeSeen, pindexGenesisBlock);
+    } else if (! this->IsReadOnly()) {
+        // nothing is journaled while the snapshot is off: a later start must not trust it
+        std::pair<uint64_t, HASH> marker;
+        if (ReadBlockIndexSnapshot(marker) && (!EraseBlockIndexSnapshot() || !EraseBlockIndexJournal())) {
+            return logging::error("CTxDB::LoadBlockIndex() : failed to drop the block index snapshot marker");
+        }
+    }
+    if (! fSnapshot && !LoadBlockIndexEntries(mapBlockIndex, setStakeSeen, pindexGenesisBlock)) {
+        return false;
+    }
+    if (args_bool::fRequestShutdown) {
+        return true;
+    }
 
     //
     // Load hashBestChain pointer to end of best chain
@@ -357,7 +859,7 @@ bool CTxDB_impl<HASH>::LoadBlockIndex(
     if (! mapBlockIndex.count(hashBestChain)) {
         return logging::error("CTxDB::LoadBlockIndex() : hashBestChain not found in the block index");
     }
-    pindexBest = mapBlockIndex[hashBestChain];
+    pindexBest = mapBlockIndex.get(hashBestChain);
     nBestHeight = pindexBest->get_nHeight();
     nBestChainTrust = pindexBest->get_nChainTrust();
 
@@ -385,121 +887,51 @@ bool CTxDB_impl<HASH>::LoadBlockIndex(
     }
 
     logging::LogPrintf("Verifying last %i blocks at level %i\n", nCheckDepth, nCheckLevel);
-    CBlockIndex *pindexFork = nullptr;
-    std::map<std::pair<unsigned int, unsigned int>, CBlockIndex *> mapBlockPos;
+    const int64_t nVerifyStart = util::GetTimeMillis();
+    std::vector<CBlockIndex *> vVerify;
     for (CBlockIndex *pindex = pindexBest; pindex && pindex->get_pprev(); pindex = pindex->set_pprev())
     {
-        if (args_bool::fRequestShutdown || pindex->get_nHeight() < nBestHeight - nCheckDepth) {
+        if (pindex->get_nHeight() < nBestHeight - nCheckDepth) {
             break;
         }
+        vVerify.push_back(pindex);
+    }
 
-        CBlock block;
-        if (! block.ReadFromDisk(pindex)) {
-            return logging::error("LoadBlockIndex() : block.ReadFromDisk failed");
+    // blocks in the checked range by disk position (check level 4)
+    std::map<std::pair<unsigned int, unsigned int>, CBlockIndex *> mapBlockPos;
+    if (nCheckLevel > 1) {
+        for (CBlockIndex *pindex: vVerify) {
+            mapBlockPos[std::make_pair(pindex->get_nFile(), pindex->get_nBlockPos())] = pindex;
         }
+    }
 
-        //
-        // check level 1: verify block validity
-        // check level 7: verify block signature too
-        //
-        if (nCheckLevel > 0 && !block.CheckBlock(true, true, (nCheckLevel > 6))) {
-            logging::LogPrintf("LoadBlockIndex() : *** found bad block at %d, hash=%s\n", pindex->get_nHeight(), pindex->GetBlockHash().ToString().c_str());
-            pindexFork = pindex->set_pprev();
+    const unsigned int nThreads = std::min(std::max(lutil::GetNumCores(), 1), MAX_LOAD_SHARDS);
+    CBlockVerifyJob<HASH> job(*this, vVerify, mapBlockPos, nCheckLevel);
+    if (nThreads == 1 || vVerify.size() < 2) {
+        job.Do();
+    } else {
+        boost::thread_group group;
+        for (unsigned int i = 0; i < nThreads; ++i) {
+            group.create_thread(boost::bind(&CBlockVerifyJob<HASH>::Do, &job));
         }
+        group.join_all();
+    }
 
-        //
-        // check level 2: verify transaction index validity
-        //
-        if (nCheckLevel > 1) {
-            std::pair<unsigned int, unsigned int> pos = std::make_pair(pindex->get_nFile(), pindex->get_nBlockPos());
-            mapBlockPos[pos] = pindex;
-            for(const CTransaction &tx: block.get_vtx())
-            {
-                HASH hashTx = tx.GetHash();
-                CTxIndex txindex;
-                if (ReadTxIndex(hashTx, txindex)) {
-                    //
-                    // check level 3: checker transaction hashes
-                    //
-                    if (nCheckLevel>2 || pindex->get_nFile() != txindex.get_pos().get_nFile() || pindex->get_nBlockPos() != txindex.get_pos().get_nBlockPos()) {
-                        //
-                        // either an error or a duplicate transaction
-                        //
-                        CTransaction txFound;
-                        if (! txFound.ReadFromDisk(txindex.get_pos())) {
-                            logging::LogPrintf("LoadBlockIndex() : *** cannot read mislocated transaction %s\n", hashTx.ToString().c_str());
-                            pindexFork = pindex->set_pprev();
-                        } else {
-                            if (txFound.GetHash() != hashTx) { // not a duplicate tx
-                                logging::LogPrintf("LoadBlockIndex(): *** invalid tx position for %s\n", hashTx.ToString().c_str());
-                                pindexFork = pindex->set_pprev();
-                            }
-                        }
-                    }
-
-                    //
-                    // check level 4: check whether spent txouts were spent within the main chain
-                    //
-                    unsigned int nOutput = 0;
-                    if (nCheckLevel > 3) {
-                        for(const CDiskTxPos &txpos: txindex.get_vSpent())
-                        {
-                            if (! txpos.IsNull()) {
-                                std::pair<unsigned int, unsigned int> posFind = std::make_pair(txpos.get_nFile(), txpos.get_nBlockPos());
-                                if (! mapBlockPos.count(posFind)) {
-                                    logging::LogPrintf("LoadBlockIndex(): *** found bad spend at %d, hashBlock=%s, hashTx=%s\n", pindex->get_nHeight(), pindex->GetBlockHash().ToString().c_str(), hashTx.ToString().c_str());
-                                    pindexFork = pindex->set_pprev();
-                                }
-
-                                //
-                                // check level 6: check whether spent txouts were spent by a valid transaction that consume them
-                                //
-                                if (nCheckLevel > 5) {
-                                    CTransaction txSpend;
-                                    if (! txSpend.ReadFromDisk(txpos)) {
-                                        logging::LogPrintf("LoadBlockIndex(): *** cannot read spending transaction of %s:%i from disk\n", hashTx.ToString().c_str(), nOutput);
-                                        pindexFork = pindex->set_pprev();
-                                    } else if (!txSpend.CheckTransaction()) {
-                                        logging::LogPrintf("LoadBlockIndex(): *** spending transaction of %s:%i is invalid\n", hashTx.ToString().c_str(), nOutput);
-                                        pindexFork = pindex->set_pprev();
-                                    } else {
-                                        bool fFound = false;
-                                        for(const CTxIn &txin: txSpend.get_vin())
-                                        {
-                                            if (txin.get_prevout().get_hash() == hashTx && txin.get_prevout().get_n() == nOutput) {
-                                                fFound = true;
-                                            }
-                                        }
-                                        if (! fFound) {
-                                            logging::LogPrintf("LoadBlockIndex(): *** spending transaction of %s:%i does not spend it\n", hashTx.ToString().c_str(), nOutput);
-                                            pindexFork = pindex->set_pprev();
-                                        }
-                                    }
-                                }
-                            }
-                            ++nOutput;
-                        }
-                    }
-                }
-
-                //
-                // check level 5: check whether all prevouts are marked spent
-                //
-                if (nCheckLevel > 4) {
-                    for(const CTxIn &txin: tx.get_vin())
-                    {
-                        CTxIndex txindex;
-                        if (ReadTxIndex(txin.get_prevout().get_hash(), txindex)) {
-                            if (txindex.get_vSpent().size() - 1 < txin.get_prevout().get_n() || txindex.get_vSpent(txin.get_prevout().get_n()).IsNull()) {
-                                logging::LogPrintf("LoadBlockIndex(): *** found unspent prevout %s:%i in %s\n", txin.get_prevout().get_hash().ToString().c_str(), txin.get_prevout().get_n(), hashTx.ToString().c_str());
-                                pindexFork = pindex->set_pprev();
-                            }
-                        }
-                    }
-                }
-            }
+    // reduce from the best block down, as the serial walk did
+    CBlockIndex *pindexFork = nullptr;
+    for (size_t i = 0; i < vVerify.size() && !args_bool::fRequestShutdown; ++i) {
+        const typename CBlockVerifyJob<HASH>::result &res = job.get_vResult()[i];
+        if (res.fReadFailed) {
+            return logging::error("LoadBlockIndex() : block.ReadFromDisk failed at %d", vVerify[i]->get_nHeight());
+        }
+        if (res.fBad) {
+            if (res.nBadTx >= 0)
+                logging::LogPrintf("LoadBlockIndex() : *** first bad tx of block %d is #%d\n", vVerify[i]->get_nHeight(), res.nBadTx);
+            logging::LogPrintf("%s", res.strBad.c_str());
+            pindexFork = vVerify[i]->set_pprev();
         }
     }
+    logging::LogPrintf("Verified %" PRIszu " blocks on %u threads in %" PRId64 "ms\n", vVerify.size(), nThreads, util::GetTimeMillis() - nVerifyStart);
 
     if (pindexFork && !args_bool::fRequestShutdown) {
         //
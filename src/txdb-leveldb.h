@@ -27,12 +27,30 @@ class CTxDB_impl : public CLevelDB // Note: no necessary virtual.
     CTxDB_impl(CTxDB_impl &&)=delete;
     CTxDB_impl &operator=(const CTxDB_impl &)=delete;
     CTxDB_impl &operator=(CTxDB_impl &&)=delete;
+
+    // write-back overlay of tx index changes between TxnBegin and TxnCommit (null: erased)
+    // They reach LevelDB in one batch at TxnCommit and the prevout cache only after that.
+    std::map<HASH, CTxIndex> mapTxIndexPending;
+    bool fTxnActive;
+
+    bool LoadBlockIndexEntries(CBlockIndexMap_impl<HASH> &mapBlockIndex,
+                               std::set<std::pair<COutPoint_impl<HASH>, unsigned int> > &setStakeSeen,
+                               CBlockIndex_impl<HASH> *&pindexGenesisBlock);
+    bool LoadBlockIndexSnapshot(CBlockIndexMap_impl<HASH> &mapBlockIndex,
+                                std::set<std::pair<COutPoint_impl<HASH>, unsigned int> > &setStakeSeen,
+                                CBlockIndex_impl<HASH> *&pindexGenesisBlock);
 public:
+    static constexpr int MAX_LOAD_SHARDS = 16; // LoadBlockIndex worker threads (decode, -checkblocks)
+
     CTxDB_impl(const char *pszMode = "r+");
     ~CTxDB_impl();
 
     void init_blockindex(const char *pszMode, bool fRemoveOld = false);
 
+    bool TxnBegin();
+    bool TxnCommit();
+    bool TxnAbort();
+
     bool ReadTxIndex(HASH hash, CTxIndex &txindex);
     bool UpdateTxIndex(HASH hash, const CTxIndex &txindex);
     bool AddTxIndex(const CTransaction_impl<HASH> &tx, const CDiskTxPos &pos, int nHeight);
@@ -45,6 +63,11 @@ public:
     bool ReadDiskTx(COutPoint_impl<HASH> outpoint, CTransaction_impl<HASH> &tx);
 
     bool WriteBlockIndex(const CDiskBlockIndex &blockindex);
+    bool ReadBlockIndexSnapshot(std::pair<uint64_t, HASH> &marker);
+    bool WriteBlockIndexSnapshot(const std::pair<uint64_t, HASH> &marker);
+    bool EraseBlockIndexSnapshot();
+    bool ReadBlockIndexJournal(std::vector<HASH> &vHash) const;
+    bool EraseBlockIndexJournal();
 
     bool ReadHashBestChain(HASH &hashBestChain);
     bool WriteHashBestChain(HASH hashBestChain);
@@ -61,7 +84,7 @@ public:
     bool ReadModifierUpgradeTime(unsigned int &nUpgradeTime);
     bool WriteModifierUpgradeTime(const unsigned int &nUpgradeTime);
 
-    bool LoadBlockIndex(std::map<HASH, CBlockIndex_impl<HASH> *> &mapBlockIndex,
+    bool LoadBlockIndex(CBlockIndexMap_impl<HASH> &mapBlockIndex,
                         std::set<std::pair<COutPoint_impl<HASH>, unsigned int> > &setStakeSeen,
                         CBlockIndex_impl<HASH> *&pindexGenesisBlock,
                         HASH &hashBestChain,
@@ -130,6 +130,38 @@ public:
         *this += -b;
         return *this;
     }
+    // *this *= b32; returns the carry out of the top word (0: the product fits)
+    uint32_t MulU32(uint32_t b32) {
+        uint64_t carry = 0;
+        for (int i=0; i<WIDTH; ++i) {
+            uint64_t n = carry + (uint64_t)pn[i] * b32;
+            pn[i] = n & 0xffffffff;
+            carry = n >> 32;
+        }
+        return (uint32_t)carry;
+    }
+    // *this *= b64; false if the product does not fit (the low bits are kept)
+    bool MulU64(uint64_t b64) {
+        base_uint hi(*this);
+        bool fFit = (MulU32((uint32_t)b64) == 0);
+        if ((b64 >> 32) != 0) {
+            fFit = (hi.MulU32((uint32_t)(b64 >> 32)) == 0) && hi.pn[WIDTH - 1] == 0 && fFit;
+            hi <<= 32;
+            *this += hi;
+            fFit = fFit && !(*this < hi);
+        }
+        return fFit;
+    }
+    // *this /= b32, truncated; returns the remainder
+    uint32_t DivU32(uint32_t b32) {
+        uint64_t rem = 0;
+        for (int i=WIDTH-1; i>=0; --i) {
+            uint64_t n = (rem << 32) | pn[i];
+            pn[i] = (uint32_t)(n / b32);
+            rem = n % b32;
+        }
+        return (uint32_t)rem;
+    }
     base_uint &operator++() {
         int i = 0;
         while (++pn[i] == 0 && i < WIDTH - 1) ++i;
@@ -23,6 +23,7 @@
 #include <random/random.h>
 #include <util/thread.h>
 #include <util/system.h>
+#include <script/sighash.h>
 
 bool CWallet::fWalletUnlockMintOnly = false;
 
@@ -761,7 +762,7 @@ bool CWallet::AddToWallet(const CWalletTx &wtxIn)
                         }
                     }
 
-                    unsigned int &blocktime = block_info::mapBlockIndex[wtxIn.hashBlock]->set_nTime();
+                    unsigned int &blocktime = block_info::mapBlockIndex.get(wtxIn.hashBlock)->set_nTime();
                     wtx.nTimeSmart = std::max(latestEntry, std::min(blocktime, latestNow));
                 } else {
                     logging::LogPrintf("AddToWallet() : found %s in block %s not in index\n", wtxIn.GetHash().ToString().substr(0,10).c_str(), wtxIn.hashBlock.ToString().c_str());
@@ -2278,10 +2279,11 @@ bool CWallet::CreateTransaction(const std::vector<std::pair<CScript, int64_t> >
                 }
 
                 // Sign
+                const CSignatureHashData sighash(wtxNew);
                 int nIn = 0;
                 for(const std::pair<const CWalletTx *, unsigned int> &coin: setCoins)
                 {
-                    if (! Script_util::SignSignature(*this, *coin.first, wtxNew, nIn++)) {
+                    if (! Script_util::SignSignature(*this, *coin.first, wtxNew, nIn++, Script_param::SIGHASH_ALL, &sighash)) {
                         return false;
                     }
                 }
@@ -2411,12 +2413,13 @@ bool CWallet::MergeCoins(const int64_t &nAmount, const int64_t &nMinValue, const
         if (nBytes >= block_params::MAX_BLOCK_SIZE_GEN / 6 || wtxNew.get_vout(0).get_nValue() >= nOutputValue) {
             wtxNew.set_vout(0).sub_nValue(nMinFee); // Set actual fee
 
+            const CSignatureHashData sighash(wtxNew);
             for (unsigned int i = 0; i < wtxNew.get_vin().size(); ++i)
             {
                 const CWalletTx *txin = vwtxPrev[i];
 
                 // Sign all scripts
-                if (! Script_util::SignSignature(*this, *txin, wtxNew, i)) {
+                if (! Script_util::SignSignature(*this, *txin, wtxNew, i, Script_param::SIGHASH_ALL, &sighash)) {
                     return false;
                 }
             }
@@ -2454,12 +2457,13 @@ bool CWallet::MergeCoins(const int64_t &nAmount, const int64_t &nMinValue, const
             return false;
         }
 
+        const CSignatureHashData sighash(wtxNew);
         for (unsigned int i = 0; i < wtxNew.get_vin().size(); ++i)
         {
             const CWalletTx *txin = vwtxPrev[i];
 
             // Sign all scripts again
-            if (! Script_util::SignSignature(*this, *txin, wtxNew, i)) {
+            if (! Script_util::SignSignature(*this, *txin, wtxNew, i, Script_param::SIGHASH_ALL, &sighash)) {
                 return false;
             }
         }